@@ -0,0 +1,262 @@
+/**
+ * @author Tal Figenblat
+ * @date October 17, 2026
+ *
+ * @file gen_program.c
+ * @brief Generator of valid assembly programs of any size, for benchmarking the assembler.
+ *
+ * The program has the requested numbers of lines, code labels, macros (each expanded a given
+ * number of times), data values, strings, externals and entries. Instructions fill the code
+ * until the words of the program reach MEMORY_SIZE, or the number given to "--words" for
+ * programs assembled with "--large"; the remaining lines are comments, which take no memory.
+ * The same options and seed always give the same program.
+ *
+ * Usage: gen_program [--lines N] [--labels N] [--macros N] [--macro-body N] [--expansions N]
+ *                    [--data N] [--strings N] [--externs N] [--extern-refs N] [--entries N]
+ *                    [--words N] [--seed N] [-o file.as]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "first_pass.h"
+
+/**
+ * @def DATA_PER_LINE
+ * @brief Number of values in each ".data" directive.
+ */
+#define DATA_PER_LINE 8
+
+/**
+ * @def STRING_WORDS
+ * @brief Words taken by each generated ".string" directive, including its terminator.
+ */
+#define STRING_WORDS 9
+
+/**
+ * @def MAX_FILLER_WORDS
+ * @brief Largest number of words taken by a filler instruction.
+ */
+#define MAX_FILLER_WORDS 3
+
+/**
+ * @struct gen_options
+ * @brief Holds the shape of the generated program.
+ */
+typedef struct {
+    long lines;       /**< Total number of lines. */
+    long labels;      /**< Number of labels on instruction lines. */
+    long macros;      /**< Number of macro definitions. */
+    long macro_body;  /**< Number of lines in the body of each macro. */
+    long expansions;  /**< Number of macro calls, spread over the macros. */
+    long data;        /**< Number of ".data" values. */
+    long strings;     /**< Number of ".string" directives. */
+    long externs;     /**< Number of external labels. */
+    long extern_refs; /**< Number of instructions referencing an external label. */
+    long entries;     /**< Number of code labels declared as entries. */
+    long words;       /**< Number of memory words the program may take. */
+    unsigned long seed; /**< Seed of the generator. */
+} gen_options;
+
+static unsigned long gen_state;
+
+/**
+ * @brief Returns the next pseudo-random number, the same on every platform.
+ *
+ * @param bound The number of possible values.
+ * @return A number from 0 to bound - 1.
+ */
+static long nextRandom(long bound) {
+    gen_state = (gen_state * 1103515245UL + 12345UL) & 0x7fffffffUL;
+    return bound > 0 ? (long)((gen_state >> 8) % (unsigned long)bound) : 0;
+}
+
+/**
+ * @brief Parses a count given to an option.
+ *
+ * @param str The count, or NULL if the option has no value.
+ * @param value Pointer to the variable receiving the count.
+ * @return EXIT_SUCCESS if the count is valid, EXIT_FAILURE otherwise.
+ */
+static int parseCount(const char *str, long *value) {
+    char *end;
+
+    if(!str || !*str) return EXIT_FAILURE;
+    *value = strtol(str, &end, 10);
+    return *end || *value < 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+/**
+ * @brief Writes a filler instruction, referencing labels when the program has some.
+ *
+ * @param fp The output file.
+ * @param opts Pointer to the shape of the program.
+ * @param words_left Number of words the instruction may take.
+ * @return The number of words taken by the instruction.
+ */
+static int writeFiller(FILE *fp, const gen_options *opts, long words_left) {
+    int reg1 = (int)nextRandom(8), reg2 = (int)nextRandom(8);
+    long data_lines = (opts->data + DATA_PER_LINE - 1) / DATA_PER_LINE;
+
+    switch(words_left < MAX_FILLER_WORDS ? 0 : nextRandom(8)) {
+        case 1:
+            fprintf(fp, "mov #%ld, r%d\n", nextRandom(1000) - 500, reg1);
+            return 3;
+        case 2:
+            if(!opts->labels) break;
+            fprintf(fp, "add L%ld, r%d\n", nextRandom(opts->labels), reg1);
+            return 3;
+        case 3:
+            if(!opts->labels) break;
+            fprintf(fp, "jmp L%ld\n", nextRandom(opts->labels));
+            return 2;
+        case 4:
+            if(!opts->labels) break;
+            fprintf(fp, "cmp #%ld, L%ld\n", nextRandom(100), nextRandom(opts->labels));
+            return 3;
+        case 5:
+            if(!data_lines) break;
+            fprintf(fp, "inc D%ld\n", nextRandom(data_lines));
+            return 2;
+        case 6:
+            if(!opts->strings) break;
+            fprintf(fp, "lea S%ld, r%d\n", nextRandom(opts->strings), reg1);
+            return 3;
+        case 7:
+            fprintf(fp, "prn *r%d\n", reg1);
+            return 2;
+        default:
+            break;
+    }
+
+    fprintf(fp, "mov r%d, r%d\n", reg1, reg2);
+    return 2;
+}
+
+/**
+ * @brief Writes the program.
+ *
+ * @param fp The output file.
+ * @param opts Pointer to the shape of the program.
+ * @return EXIT_SUCCESS if the program fits in memory, EXIT_FAILURE otherwise.
+ */
+static int writeProgram(FILE *fp, const gen_options *opts) {
+    long i, j, data_lines = (opts->data + DATA_PER_LINE - 1) / DATA_PER_LINE;
+    long fixed_lines, code_lines, special, words_left, labels_left, expansions_left, refs_left, lines_left;
+
+    /* Declarations, macro definitions, data and the final "stop" take fixed lines */
+    fixed_lines = opts->entries + opts->externs + opts->macros * (opts->macro_body + 2) + data_lines +
+                  opts->strings + 1;
+    special = opts->expansions + opts->extern_refs;
+    words_left = opts->words - 1 - opts->data - opts->strings * STRING_WORDS - 1 -
+                 opts->expansions * opts->macro_body * 2 - opts->extern_refs * 2;
+    code_lines = opts->lines - fixed_lines - 1; /* The header comment */
+
+    if(words_left < 0 || code_lines < special || (opts->expansions && !opts->macros) ||
+       (opts->extern_refs && !opts->externs) || opts->entries > opts->labels) {
+        fprintf(stderr, "The requested program does not fit in %ld words and %ld lines\n", opts->words, opts->lines);
+        return EXIT_FAILURE;
+    }
+
+    fprintf(fp, "; Generated by gen_program with seed %lu\n", opts->seed);
+    for(i = 0; i < opts->entries; i++)
+        fprintf(fp, ".entry L%ld\n", i);
+    for(i = 0; i < opts->externs; i++)
+        fprintf(fp, ".extern X%ld\n", i);
+
+    for(i = 0; i < opts->macros; i++) {
+        fprintf(fp, "macr M%ld\n", i);
+        for(j = 0; j < opts->macro_body; j++)
+            fprintf(fp, " inc r%ld\n", (i + j) % 8);
+        fprintf(fp, "endmacr\n");
+    }
+
+    /* Spread the macro calls and external references over the code, filling the rest */
+    labels_left = opts->labels, expansions_left = opts->expansions, refs_left = opts->extern_refs;
+    for(i = 0, lines_left = code_lines; lines_left > 0; i++, lines_left--) {
+        j = nextRandom(lines_left);
+        if(j < expansions_left) {
+            fprintf(fp, "M%ld\n", --expansions_left % opts->macros);
+            continue;
+        }
+        if(j < expansions_left + refs_left) {
+            refs_left--;
+            fprintf(fp, "%s X%ld\n", nextRandom(2) ? "jsr" : "prn", nextRandom(opts->externs));
+            continue;
+        }
+
+        /* Once the memory is used up, the remaining lines are comments */
+        if(words_left - MAX_FILLER_WORDS < 0 && !labels_left) {
+            fprintf(fp, "; Line %ld\n", i);
+            continue;
+        }
+        if(labels_left) fprintf(fp, "L%ld: ", opts->labels - labels_left--);
+        words_left -= writeFiller(fp, opts, words_left);
+    }
+    if(labels_left || words_left < 0) {
+        fprintf(stderr, "The requested labels do not fit in %ld words and %ld lines\n", opts->words, opts->lines);
+        return EXIT_FAILURE;
+    }
+    fprintf(fp, "stop\n");
+
+    for(i = 0; i < data_lines; i++) {
+        fprintf(fp, "D%ld: .data", i);
+        for(j = i * DATA_PER_LINE; j < opts->data && j < (i + 1) * DATA_PER_LINE; j++)
+            fprintf(fp, "%s%ld", j == i * DATA_PER_LINE ? " " : ", ", nextRandom(2000) - 1000);
+        fprintf(fp, "\n");
+    }
+    for(i = 0; i < opts->strings; i++)
+        fprintf(fp, "S%ld: .string \"str%05ld\"\n", i, i % 100000);
+
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Generates a program with the shape given on the command line.
+ *
+ * @param argc The number of command-line arguments.
+ * @param argv The array of command-line arguments.
+ * @return int Returns 1 if the options are invalid or the program does not fit, otherwise returns 0.
+ */
+int main(int argc, char *argv[]) {
+    const char *names[] = {"--lines", "--labels", "--macros", "--macro-body", "--expansions", "--data",
+                           "--strings", "--externs", "--extern-refs", "--entries", "--words", "--seed"};
+    gen_options opts;
+    long *values[12], seed = 1;
+    const char *out_path = NULL;
+    FILE *fp = stdout;
+    int i, k, status;
+
+    opts.lines = 1000, opts.labels = 100, opts.macros = 10, opts.macro_body = 3, opts.expansions = 20;
+    opts.data = 200, opts.strings = 20, opts.externs = 10, opts.extern_refs = 40, opts.entries = 10;
+    opts.words = MEMORY_SIZE;
+    values[0] = &opts.lines, values[1] = &opts.labels, values[2] = &opts.macros, values[3] = &opts.macro_body;
+    values[4] = &opts.expansions, values[5] = &opts.data, values[6] = &opts.strings, values[7] = &opts.externs;
+    values[8] = &opts.extern_refs, values[9] = &opts.entries, values[10] = &opts.words, values[11] = &seed;
+
+    for(i = 1; i < argc; i++) {
+        if(!strcmp(argv[i], "-o") && i + 1 < argc) {
+            out_path = argv[++i];
+            continue;
+        }
+        for(k = 0; k < 12 && strcmp(argv[i], names[k]); k++)
+            ;
+        if(k == 12 || parseCount(i + 1 < argc ? argv[++i] : NULL, values[k])) {
+            fprintf(stderr, "Usage: %s [--lines N] [--labels N] [--macros N] [--macro-body N] [--expansions N]\n"
+                            "       [--data N] [--strings N] [--externs N] [--extern-refs N] [--entries N]\n"
+                            "       [--words N] [--seed N] [-o file.as]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    opts.seed = (unsigned long)seed;
+    gen_state = opts.seed;
+
+    if(out_path && !(fp = fopen(out_path, "w"))) {
+        fprintf(stderr, "Unable to open the file %s\n", out_path);
+        return EXIT_FAILURE;
+    }
+    status = writeProgram(fp, &opts);
+    if(out_path) fclose(fp);
+    if(status && out_path) remove(out_path);
+    return status;
+}
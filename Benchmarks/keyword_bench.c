@@ -0,0 +1,188 @@
+/**
+ * @author Tal Figenblat
+ * @date October 17, 2026
+ *
+ * @file keyword_bench.c
+ * @brief Microbenchmark of the reserved word lookups.
+ *
+ * Compares the perfect hash lookups of globals.c against the linear `strcmp` loops they replaced,
+ * on a token mix resembling real source lines: opcodes, registers, directives, labels and operands.
+ * The program first checks that both implementations agree on every token.
+ *
+ * Usage: keyword_bench [iterations]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "globals.h"
+
+/**
+ * @def DEFAULT_ITERATIONS
+ * @brief Number of passes over the token mix when no count is given.
+ */
+#define DEFAULT_ITERATIONS 200000
+
+/**
+ * @brief Tokens looked up by the benchmark, in the proportions seen in ValidInputs.
+ */
+const char *tokens[] = {
+        "MAIN:", "mov", "#9", "r0", "jsr", "EVENODD", "PRINT", "stop", "EVENODD:", "r1",
+        "mov", "#2", "r2", "sub", "bne", "ODD", "EVEN:", "prn", "#1", "rts",
+        ".entry", "MAIN", ".extern", "macr", "CHECK_ODD", "endmacr", "lea", "msg", "cmp", "*r0",
+        "inc", "jmp", "STRLOOP", "msg:", ".string", "\"Hello,", ".data", "7", "add", "r3"
+};
+
+/**
+ * @brief Every reserved word, plus near misses that must not be found.
+ */
+const char *reserved[] = {
+        "mov", "cmp", "add", "sub", "lea", "clr", "not", "inc", "dec", "jmp", "bne", "red", "prn", "jsr",
+        "rts", "stop", "r0", "r1", "r2", "r3", "r4", "r5", "r6", "r7", "r8", "macr", "endmacr",
+        ".data", ".string", ".entry", ".extern", "data", "movv", "mo", "m", "", "r", "endmac", ".externs"
+};
+
+/**
+ * @brief The opcode lookup as it was before the perfect hash table.
+ *
+ * @param str The string representation of the opcode.
+ * @return The corresponding opcode value, or `unknown_opcode` if not found.
+ */
+opcode legacy_get_opcode(const char *str) {
+    size_t i;
+
+    const struct {
+        const char *name;
+        opcode value;
+    } opcode_map[] = {
+            {"mov", mov}, {"cmp", cmp},
+            {"add", add}, {"sub", sub},
+            {"lea", lea}, {"clr", clr},
+            {"not", not}, {"inc", inc},
+            {"dec", dec}, {"jmp", jmp},
+            {"bne", bne}, {"red", red},
+            {"prn", prn}, {"jsr", jsr},
+            {"rts", rts}, {"stop", stop}
+    };
+
+    for(i = 0; i < OPCODE_COUNT; ++i) {
+        if(!strcmp(str, opcode_map[i].name))
+            return opcode_map[i].value;
+    }
+    return unknown_opcode;
+}
+
+/**
+ * @brief The register lookup as it was before the perfect hash table.
+ *
+ * @param str The string representation of the register.
+ * @return The corresponding register value, or `unknown_register` if not found.
+ */
+regis legacy_get_register(const char *str) {
+    size_t i;
+
+    const struct {
+        const char *name;
+        regis value;
+    } register_map[] = {
+            {"r0", r0}, {"r1", r1},
+            {"r2", r2}, {"r3", r3},
+            {"r4", r4}, {"r5", r5},
+            {"r6", r6}, {"r7", r7}
+    };
+
+    for(i = 0; i < REGISTER_COUNT; ++i) {
+        if(!strcmp(str, register_map[i].name))
+            return register_map[i].value;
+    }
+    return unknown_register;
+}
+
+/**
+ * @brief Classifies a token the way the passes did before: opcode, register, then the other keywords.
+ *
+ * @param str The token to classify.
+ * @return A value identifying the class of the token.
+ */
+int legacy_classify(const char *str) {
+    if(legacy_get_opcode(str) != unknown_opcode) return KEYWORD_OPCODE;
+    if(legacy_get_register(str) != unknown_register) return KEYWORD_REGISTER;
+    if(!strcmp(str, "macr")) return KEYWORD_MACR;
+    if(!strcmp(str, "endmacr")) return KEYWORD_ENDMACR;
+    if(!strcmp(str, ".data")) return KEYWORD_DATA;
+    if(!strcmp(str, ".string")) return KEYWORD_STRING;
+    if(!strcmp(str, ".entry")) return KEYWORD_ENTRY;
+    if(!strcmp(str, ".extern")) return KEYWORD_EXTERN;
+    return KEYWORD_NONE;
+}
+
+/**
+ * @brief Classifies a token with the perfect hash table.
+ *
+ * @param str The token to classify.
+ * @return A value identifying the class of the token.
+ */
+int hashed_classify(const char *str) {
+    return get_keyword_kind(str);
+}
+
+/**
+ * @brief Times a classifier over the token mix.
+ *
+ * @param classify The classifier to time.
+ * @param iterations Number of passes over the token mix.
+ * @param checksum Receives a sum of the results, so the calls cannot be optimized away.
+ * @return Elapsed processor time in seconds.
+ */
+double time_classifier(int (*classify)(const char *), long iterations, long *checksum) {
+    size_t count = sizeof(tokens) / sizeof(tokens[0]), j;
+    clock_t start = clock();
+    long i, sum = 0;
+
+    for(i = 0; i < iterations; i++)
+        for(j = 0; j < count; j++)
+            sum += classify(tokens[j]);
+
+    *checksum = sum;
+    return (double)(clock() - start) / CLOCKS_PER_SEC;
+}
+
+/**
+ * @brief Entry point of the keyword lookup benchmark.
+ *
+ * @param argc The number of command-line arguments.
+ * @param argv The command-line arguments; the optional first one is the iteration count.
+ * @return EXIT_SUCCESS, or EXIT_FAILURE if the two implementations disagree.
+ */
+int main(int argc, char *argv[]) {
+    size_t count = sizeof(tokens) / sizeof(tokens[0]), j;
+    size_t reserved_count = sizeof(reserved) / sizeof(reserved[0]);
+    long iterations = argc > 1 ? atol(argv[1]) : DEFAULT_ITERATIONS;
+    long legacy_sum, hashed_sum;
+    double legacy_time, hashed_time, lookups;
+
+    /* Both implementations must agree before timing means anything */
+    for(j = 0; j < count + reserved_count; j++) {
+        const char *token = j < count ? tokens[j] : reserved[j - count];
+
+        if(legacy_classify(token) != hashed_classify(token) ||
+           legacy_get_opcode(token) != get_opcode(token) ||
+           legacy_get_register(token) != get_register(token)) {
+            fprintf(stderr, "Mismatch on token \"%s\"\n", token);
+            return EXIT_FAILURE;
+        }
+    }
+
+    legacy_time = time_classifier(legacy_classify, iterations, &legacy_sum);
+    hashed_time = time_classifier(hashed_classify, iterations, &hashed_sum);
+    lookups = (double)iterations * count;
+
+    printf("%-14s %12s %12s\n", "lookup", "seconds", "ns/token");
+    printf("%-14s %12.3f %12.2f\n", "strcmp loops", legacy_time, legacy_time * 1e9 / lookups);
+    printf("%-14s %12.3f %12.2f\n", "perfect hash", hashed_time, hashed_time * 1e9 / lookups);
+    if(hashed_time > 0)
+        printf("speedup: %.1fx (checksums %ld/%ld)\n", legacy_time / hashed_time, legacy_sum, hashed_sum);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,168 @@
+/**
+ * @author Tal Figenblat
+ * @date October 17, 2026
+ *
+ * @file scale_bench.c
+ * @brief End-to-end benchmark of the assembler on programs of growing sizes.
+ *
+ * Assembles each given source in memory, as many times as needed to run for a while, and
+ * reports the time spent in the preprocessor, the first pass, the second pass and writing the
+ * outputs, with the lines and symbols handled per second. The phases are timed by the
+ * statistics attached to the thread, as for "--stats". With sources of growing sizes (see
+ * "make bench"), the rates show how each phase scales: a rate that drops as the sources grow
+ * points at a superlinear phase.
+ *
+ * Usage: scale_bench [--min-time SECONDS] file.as ...
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "preprocessor.h"
+#include "buffer_utils.h"
+#include "log_utils.h"
+#include "stats.h"
+
+/**
+ * @def DEFAULT_MIN_TIME
+ * @brief Least time spent assembling each source, in seconds, when none is given.
+ */
+#define DEFAULT_MIN_TIME 0.5
+
+/**
+ * @def MIN_RUNS
+ * @brief Least number of times each source is assembled.
+ */
+#define MIN_RUNS 3
+
+/**
+ * @brief Counts the lines and the symbols (labels and external labels) defined in a source.
+ *
+ * @param src The source.
+ * @param lines Pointer to the variable receiving the number of lines.
+ * @param symbols Pointer to the variable receiving the number of symbols.
+ */
+void count_source(const text_buffer *src, long *lines, long *symbols) {
+    size_t i = 0, start;
+
+    *lines = *symbols = 0;
+    while(i < src->len) {
+        /* The first token of the line defines a symbol if it ends with a colon or is ".extern" */
+        while(i < src->len && (src->data[i] == ' ' || src->data[i] == '\t')) i++;
+        start = i;
+        while(i < src->len && !strchr(" \t\n", src->data[i])) i++;
+        if(i > start && (src->data[i - 1] == ':' || (i - start == 7 && !strncmp(src->data + start, ".extern", 7))))
+            (*symbols)++;
+
+        while(i < src->len && src->data[i] != '\n') i++;
+        if(i < src->len) i++;
+        (*lines)++;
+    }
+}
+
+/**
+ * @brief Assembles a source once, in memory, without printing anything.
+ *
+ * @param name The name of the source, used in messages.
+ * @param opts Pointer to the options.
+ * @param src The source.
+ * @param print_log Whether the messages are printed.
+ * @param total Pointer to the statistics the time of each phase is added to.
+ * @return The value returned by the preprocessor.
+ */
+int assemble_once(char *name, const assembler_options *opts, const text_buffer *src, int print_log,
+                  file_stats *total) {
+    output_set outputs;
+    file_stats stats;
+    file_log log;
+    int result;
+
+    initOutputSet(&outputs);
+    initFileLog(&log);
+    initFileStats(&stats);
+    setThreadLog(&log);
+    setThreadStats(&stats);
+    result = preprocessSource(name, opts, src->data ? src->data : "", src->len, &outputs);
+    setThreadStats(NULL);
+    setThreadLog(NULL);
+    addFileStats(total, &stats);
+
+    if(print_log) flushFileLog(&log);
+    freeFileLog(&log);
+    freeOutputSet(&outputs);
+    return result;
+}
+
+/**
+ * @brief Runs the benchmark on the sources given on the command line.
+ *
+ * @param argc The number of command-line arguments.
+ * @param argv The array of command-line arguments.
+ * @return int Returns 1 if a source could not be read or has errors, otherwise returns 0.
+ */
+int main(int argc, char *argv[]) {
+    double min_time = DEFAULT_MIN_TIME, times[PHASE_COUNT], total;
+    file_stats sum;
+    char name[FILENAME_MAX], *dot;
+    assembler_options opts;
+    text_buffer src;
+    long lines, symbols, runs;
+    int i, k, first = 1;
+    FILE *fp;
+
+    initOptions(&opts);
+    opts.emit_am = 0;
+    if(initThreadLogs() || initThreadStats()) return EXIT_FAILURE;
+
+    for(i = 1; i < argc; i++) {
+        if(!strcmp(argv[i], "--min-time") && i + 1 < argc) {
+            min_time = atof(argv[++i]);
+            continue;
+        }
+
+        /* Read the whole source, and name it after the file without its extension */
+        initTextBuffer(&src);
+        if(!(fp = fopen(argv[i], "r")) || readTextBuffer(&src, fp)) {
+            fprintf(stderr, "Unable to read the file %s\n", argv[i]);
+            if(fp) fclose(fp);
+            freeTextBuffer(&src);
+            return EXIT_FAILURE;
+        }
+        fclose(fp);
+        strncpy(name, strrchr(argv[i], '/') ? strrchr(argv[i], '/') + 1 : argv[i], sizeof(name) - 1);
+        name[sizeof(name) - 1] = '\0';
+        if((dot = strrchr(name, '.'))) *dot = '\0';
+        count_source(&src, &lines, &symbols);
+
+        /* The numbers mean nothing if the source has errors */
+        initFileStats(&sum);
+        if(assemble_once(name, &opts, &src, 0, &sum)) {
+            assemble_once(name, &opts, &src, 1, &sum);
+            freeTextBuffer(&src);
+            return EXIT_FAILURE;
+        }
+
+        initFileStats(&sum);
+        for(runs = 0, total = 0; runs < MIN_RUNS || total < min_time; runs++) {
+            assemble_once(name, &opts, &src, 0, &sum);
+            for(k = PHASE_PREPROCESSOR, total = 0; k < PHASE_COUNT; k++)
+                total += sum.phase_times[k];
+        }
+        for(k = 0; k < PHASE_COUNT; k++)
+            times[k] = sum.phase_times[k] / (double)runs;
+        total /= (double)runs;
+
+        if(first) {
+            printf("%-16s %8s %8s %7s %10s %10s %10s %10s %10s %12s %12s\n", "source", "lines", "symbols", "runs",
+                   "preproc ms", "first ms", "second ms", "output ms", "total ms", "lines/s", "symbols/s");
+            first = 0;
+        }
+        printf("%-16s %8ld %8ld %7ld %10.3f %10.3f %10.3f %10.3f %10.3f %12.0f %12.0f\n", name, lines, symbols, runs,
+               times[PHASE_PREPROCESSOR] * 1e3, times[PHASE_FIRST_PASS] * 1e3, times[PHASE_SECOND_PASS] * 1e3,
+               times[PHASE_OUTPUT] * 1e3, total * 1e3, total > 0 ? (double)lines / total : 0,
+               total > 0 ? (double)symbols / total : 0);
+        freeTextBuffer(&src);
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,326 @@
+/**
+ * @author Tal Figenblat
+ * @date October 17, 2026
+ *
+ * @file token_bench.c
+ * @brief Microbenchmark of splitting source lines into tokens.
+ *
+ * Compares the tokenizer of the assembler, `nextSpan`, and the byte-at-a-time `nextToken` loop
+ * it replaced, against the block scanner of token_scan.c, with the table classifier and, when
+ * the compiler targets SSE2, the vector classifier.
+ * The lines come from the source files given on the command line (for example the files of
+ * ValidInputs) and from a synthetic corpus resembling them. The program first checks that all
+ * implementations find the same tokens, with the same commas before each one.
+ *
+ * Usage: token_bench [iterations] [file.as ...]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <time.h>
+#include "token_scan.h"
+#include "token_utils.h"
+
+/**
+ * @def DEFAULT_ITERATIONS
+ * @brief Number of passes over the lines when no count is given.
+ */
+#define DEFAULT_ITERATIONS 200
+
+/**
+ * @def SYNTHETIC_LINES
+ * @brief Number of lines in the synthetic corpus.
+ */
+#define SYNTHETIC_LINES 20000
+
+/**
+ * @def MAX_LINES
+ * @brief Maximum number of lines in the whole corpus.
+ */
+#define MAX_LINES 100000
+
+/**
+ * @brief Lines combined at random into the synthetic corpus.
+ */
+const char *fragments[] = {
+        "MAIN:   add  r3, LIST\n", "LOOP: prn #48\n", "        lea STR, r6\n", "  inc r6\n",
+        "mov *r6,K\n", "sub r1, r4\n", "cmp r3, #-6\n", "bne END\n", "dec K\n", "jmp LOOP\n",
+        "END: stop\n", "STR: .string \"abcd\"\n", "LIST: .data 6, -9\n", "        .data -100\n",
+        ".entry MAIN\n", ".extern W\n", "K: .data 31\n", "; a comment line\n", "\t jsr   FUNC ,  \n",
+        "\n", "   \t  \n", "clr r2,,r3\n", "mov #-1 , *r7\n", "LABEL_WITH_A_LONG_NAME: red r1\n"
+};
+
+/**
+ * @brief The lines of the corpus, each terminated by its newline character.
+ */
+char *lines[MAX_LINES];
+
+/**
+ * @brief The lengths of the lines of the corpus.
+ */
+size_t lengths[MAX_LINES];
+
+/**
+ * @brief Number of lines in the corpus.
+ */
+int line_count = 0;
+
+/**
+ * @brief The tokenizer as it was before the scanner, with `isspace`.
+ *
+ * @param dest Pointer to the buffer where the extracted token will be stored.
+ * @param ptr Pointer to the current position in the input string.
+ * @param delim The delimiter character used to separate tokens.
+ * @return int The number of delimiters encountered before the token.
+ */
+int legacy_nextToken(char *dest, char **ptr, const char delim) {
+    int count = 0;
+
+    while(**ptr && (isspace(**ptr) || **ptr == delim)) {
+        if(**ptr == delim)
+            count++;
+        (*ptr)++;
+    }
+
+    while(**ptr && !isspace(**ptr) && **ptr != delim) {
+        *dest = **ptr;
+        dest++;
+        (*ptr)++;
+    }
+
+    *dest = '\0';
+    return count;
+}
+
+/**
+ * @brief Adds a line to the corpus.
+ *
+ * @param text The characters of the line.
+ * @param len Number of characters in the line.
+ * @return EXIT_SUCCESS if the line was added, EXIT_FAILURE otherwise.
+ */
+int add_line(const char *text, size_t len) {
+    if(line_count == MAX_LINES || len > MAX_SCAN_SIZE) return EXIT_FAILURE;
+    lines[line_count] = (char *)malloc(len + 1);
+    if(!lines[line_count]) return EXIT_FAILURE;
+
+    memcpy(lines[line_count], text, len);
+    lines[line_count][len] = '\0';
+    lengths[line_count++] = len;
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Adds the lines of a source file to the corpus, skipping lines that are too long.
+ *
+ * @param file_name The path of the file.
+ * @return The number of lines added.
+ */
+int load_file(const char *file_name) {
+    char line[MAX_SCAN_SIZE + 2];
+    int added = 0;
+    FILE *fp = fopen(file_name, "r");
+
+    if(!fp) {
+        fprintf(stderr, "Unable to open the file %s\n", file_name);
+        return 0;
+    }
+    while(fgets(line, sizeof(line), fp))
+        if(!add_line(line, strlen(line))) added++;
+    fclose(fp);
+    return added;
+}
+
+/**
+ * @brief Checks that the scanner agrees with `nextToken` on a line.
+ *
+ * @param index Index of the line.
+ * @param scan_line The scanner to check.
+ * @return EXIT_SUCCESS if the tokens agree, EXIT_FAILURE otherwise.
+ */
+int check_line(int index, void (*scan_line)(const char *, size_t, line_scan *)) {
+    char token[MAX_SCAN_SIZE + 1], *ptr = lines[index];
+    line_scan scan;
+    int i = 0, commas;
+
+    scan_line(lines[index], lengths[index], &scan);
+    while(1) {
+        commas = legacy_nextToken(token, &ptr, ',');
+        if(!*token) return commas == scan.trailing_commas && i == scan.token_count ? EXIT_SUCCESS : EXIT_FAILURE;
+
+        if(i == scan.token_count || scan.tokens[i].commas != commas ||
+           scan.tokens[i].len != strlen(token) ||
+           strncmp(lines[index] + scan.tokens[i].start, token, scan.tokens[i].len))
+            return EXIT_FAILURE;
+        i++;
+    }
+}
+
+/**
+ * @brief Checks that `nextSpan` agrees with `nextToken` on a line.
+ *
+ * @param index Index of the line.
+ * @return EXIT_SUCCESS if the tokens agree, EXIT_FAILURE otherwise.
+ */
+int check_span(int index) {
+    char token[MAX_SCAN_SIZE + 1], *ptr = lines[index], *span_ptr = lines[index];
+    text_span span;
+
+    while(1) {
+        if(legacy_nextToken(token, &ptr, ',') != nextSpan(&span, &span_ptr, ',') ||
+           span.len != strlen(token) || strncmp(span.text, token, span.len))
+            return EXIT_FAILURE;
+        if(!*token) return EXIT_SUCCESS;
+    }
+}
+
+/**
+ * @brief Times `nextSpan`, the tokenizer of the assembler, over the corpus.
+ *
+ * @param iterations Number of passes over the corpus.
+ * @param checksum Receives a sum of the results, so the calls cannot be optimized away.
+ * @return Elapsed processor time in seconds.
+ */
+double time_span(long iterations, long *checksum) {
+    clock_t start = clock();
+    text_span span;
+    long i, sum = 0;
+    char *ptr;
+    int j;
+
+    for(i = 0; i < iterations; i++) {
+        for(j = 0; j < line_count; j++) {
+            ptr = lines[j];
+            do {
+                sum += nextSpan(&span, &ptr, ',');
+                sum += span.len ? *span.text : 0;
+            } while(span.len);
+        }
+    }
+
+    *checksum = sum;
+    return (double)(clock() - start) / CLOCKS_PER_SEC;
+}
+
+/**
+ * @brief Times `nextToken` over the corpus.
+ *
+ * @param iterations Number of passes over the corpus.
+ * @param checksum Receives a sum of the results, so the calls cannot be optimized away.
+ * @return Elapsed processor time in seconds.
+ */
+double time_legacy(long iterations, long *checksum) {
+    char token[MAX_SCAN_SIZE + 1], *ptr;
+    clock_t start = clock();
+    long i, sum = 0;
+    int j;
+
+    for(i = 0; i < iterations; i++) {
+        for(j = 0; j < line_count; j++) {
+            ptr = lines[j];
+            do {
+                sum += legacy_nextToken(token, &ptr, ',');
+                sum += *token;
+            } while(*token);
+        }
+    }
+
+    *checksum = sum;
+    return (double)(clock() - start) / CLOCKS_PER_SEC;
+}
+
+/**
+ * @brief Times a scanner over the corpus.
+ *
+ * @param scan_line The scanner to time.
+ * @param iterations Number of passes over the corpus.
+ * @param checksum Receives a sum of the results, so the calls cannot be optimized away.
+ * @return Elapsed processor time in seconds.
+ */
+double time_scanner(void (*scan_line)(const char *, size_t, line_scan *), long iterations, long *checksum) {
+    clock_t start = clock();
+    line_scan scan;
+    long i, sum = 0;
+    int j, k;
+
+    for(i = 0; i < iterations; i++) {
+        for(j = 0; j < line_count; j++) {
+            scan_line(lines[j], lengths[j], &scan);
+            for(k = 0; k < scan.token_count; k++)
+                sum += scan.tokens[k].commas + lines[j][scan.tokens[k].start];
+            sum += scan.trailing_commas;
+        }
+    }
+
+    *checksum = sum;
+    return (double)(clock() - start) / CLOCKS_PER_SEC;
+}
+
+/**
+ * @brief Prints the timings of the tokenizers on the current corpus.
+ *
+ * @param title The name of the corpus.
+ * @param iterations Number of passes over the corpus.
+ * @return EXIT_SUCCESS, or EXIT_FAILURE if the implementations disagree.
+ */
+int run_corpus(const char *title, long iterations) {
+    long legacy_sum, span_sum, scalar_sum, vector_sum;
+    double legacy_time, span_time, scalar_time, vector_time, count = (double)iterations * line_count;
+    int j;
+
+    for(j = 0; j < line_count; j++) {
+        if(check_span(j) || check_line(j, scanLineScalar) || check_line(j, scanLine)) {
+            fprintf(stderr, "Mismatch on line \"%s\"\n", lines[j]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    legacy_time = time_legacy(iterations, &legacy_sum);
+    span_time = time_span(iterations, &span_sum);
+    scalar_time = time_scanner(scanLineScalar, iterations, &scalar_sum);
+    vector_time = time_scanner(scanLine, iterations, &vector_sum);
+
+    printf("%s: %d lines\n", title, line_count);
+    printf("%-14s %12s %12s\n", "tokenizer", "seconds", "ns/line");
+    printf("%-14s %12.3f %12.2f\n", "nextToken", legacy_time, legacy_time * 1e9 / count);
+    printf("%-14s %12.3f %12.2f\n", "nextSpan", span_time, span_time * 1e9 / count);
+    printf("%-14s %12.3f %12.2f\n", "scan (table)", scalar_time, scalar_time * 1e9 / count);
+    printf("%-14s %12.3f %12.2f\n", isScanVectorized() ? "scan (SSE2)" : "scan (table)",
+           vector_time, vector_time * 1e9 / count);
+    if(vector_time > 0)
+        printf("speedup over nextSpan: %.1fx (checksums %ld/%ld)\n\n", span_time / vector_time, scalar_sum, vector_sum);
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Entry point of the tokenizer benchmark.
+ *
+ * @param argc The number of command-line arguments.
+ * @param argv The command-line arguments: the optional iteration count, then source files.
+ * @return EXIT_SUCCESS, or EXIT_FAILURE if the implementations disagree.
+ */
+int main(int argc, char *argv[]) {
+    long iterations = argc > 1 ? atol(argv[1]) : DEFAULT_ITERATIONS;
+    size_t fragment_count = sizeof(fragments) / sizeof(fragments[0]);
+    int i, status = EXIT_SUCCESS;
+
+    if(iterations <= 0) iterations = DEFAULT_ITERATIONS;
+
+    /* The files given on the command line, repeated enough to be timed */
+    for(i = 2; i < argc; i++) load_file(argv[i]);
+    if(line_count && run_corpus("source files", iterations * 50)) status = EXIT_FAILURE;
+
+    /* A synthetic corpus of random line fragments, with a fixed seed */
+    while(line_count) free(lines[--line_count]);
+    srand(1);
+    for(i = 0; i < SYNTHETIC_LINES; i++) {
+        const char *fragment = fragments[rand() % fragment_count];
+        add_line(fragment, strlen(fragment));
+    }
+    if(run_corpus("synthetic corpus", iterations)) status = EXIT_FAILURE;
+
+    while(line_count) free(lines[--line_count]);
+    return status;
+}
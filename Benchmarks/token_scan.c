@@ -0,0 +1,215 @@
+/**
+ * @author Tal Figenblat
+ * @date October 17, 2026
+ *
+ * @file token_scan.c
+ * @brief Contains functions for classifying the characters of a line a block at a time and finding its tokens.
+ *
+ * Used by the tokenizer benchmark only; the assembler splits lines with `nextSpan`. The vector
+ * classifier is compiled in when the compiler targets SSE2, and is not selected at run time.
+ */
+
+#include <string.h>
+#include "token_scan.h"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+/**
+ * @brief Returns the position of the lowest set bit of a mask that is not zero.
+ *
+ * @param mask The mask.
+ * @return The position of the lowest set bit.
+ */
+static int lowestBit(unsigned int mask) {
+#ifdef __GNUC__
+    return __builtin_ctz(mask);
+#else
+    int pos = 0;
+
+    for(; !(mask & 1); mask >>= 1) pos++;
+    return pos;
+#endif
+}
+
+/**
+ * @brief Classifies a block of characters with the table.
+ *
+ * @param block The characters of the block.
+ * @param scan Pointer to the scan to fill.
+ * @param b Index of the block.
+ */
+static void classifyBlockScalar(const unsigned char *block, line_scan *scan, int b) {
+    unsigned int bits[CLASS_COUNT] = {0};
+    int i, c, cls;
+
+    for(i = 0; i < SCAN_BLOCK_SIZE; i++) {
+        /* Most characters belong to no class */
+        for(cls = char_classes[block[i]], c = 0; cls; cls >>= 1, c++)
+            if(cls & 1) bits[c] |= 1u << i;
+    }
+    for(c = 0; c < CLASS_COUNT; c++) scan->masks[c][b] = bits[c];
+}
+
+#ifdef __SSE2__
+/**
+ * @brief Classifies a block of characters with vector compares.
+ *
+ * @param block The characters of the block.
+ * @param scan Pointer to the scan to fill.
+ * @param b Index of the block.
+ */
+static void classifyBlockVector(const unsigned char *block, line_scan *scan, int b) {
+    __m128i v = _mm_loadu_si128((const __m128i *)block);
+    /* '\t' to '\r' are the characters between 8 and 14, as signed bytes */
+    __m128i control = _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8(8)), _mm_cmplt_epi8(v, _mm_set1_epi8(14)));
+
+    scan->masks[CLASS_SPACE][b] = (unsigned int)_mm_movemask_epi8(_mm_or_si128(control, _mm_cmpeq_epi8(v, _mm_set1_epi8(' '))));
+    scan->masks[CLASS_COMMA][b] = (unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8(',')));
+    scan->masks[CLASS_QUOTE][b] = (unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8('"')));
+    scan->masks[CLASS_COLON][b] = (unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8(':')));
+    scan->masks[CLASS_HASH][b] = (unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8('#')));
+    scan->masks[CLASS_STAR][b] = (unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8('*')));
+    scan->masks[CLASS_SEMICOLON][b] = (unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8(';')));
+}
+#endif
+
+/**
+ * @brief Finds the tokens of a line from the masks of its separators.
+ *
+ * Each block contributes the edges where the line switches between separators and tokens:
+ * an edge on a token character starts a token, and an edge on a separator ends one. Only the
+ * edges and the commas are visited, so the cost follows the number of tokens, not of characters.
+ *
+ * @param scan Pointer to the scan, whose masks are filled.
+ * @param blocks Number of blocks in the line.
+ */
+static void findTokens(line_scan *scan, int blocks) {
+    unsigned int sep, comma, edges, bits, bit, prev = 1, full = (1u << SCAN_BLOCK_SIZE) - 1;
+    int b, pos, commas = 0, tail = scan->len % SCAN_BLOCK_SIZE;
+    token_span *token = NULL;
+
+    scan->token_count = 0;
+    for(b = 0; b < blocks; b++) {
+        comma = scan->masks[CLASS_COMMA][b];
+        sep = scan->masks[CLASS_SPACE][b] | comma;
+        /* Characters past the end of the line separate the last token */
+        if(b == blocks - 1 && tail) sep |= full & ~((1u << tail) - 1);
+
+        edges = (sep ^ ((sep << 1) | prev)) & full;
+        prev = (sep >> (SCAN_BLOCK_SIZE - 1)) & 1;
+
+        /* Visit the edges and the commas in order, counting the commas between tokens */
+        for(bits = edges | comma; bits; bits &= bits - 1) {
+            bit = bits & (~bits + 1);
+            pos = b * SCAN_BLOCK_SIZE + lowestBit(bit);
+
+            if(!(edges & bit)) {
+                commas++;
+            } else if(sep & bit) {
+                token->len = (unsigned char)(pos - token->start);
+                if(comma & bit) commas++;
+            } else {
+                token = &scan->tokens[scan->token_count++];
+                token->start = (unsigned char)pos;
+                token->len = 0;
+                token->commas = (unsigned char)commas;
+                commas = 0;
+            }
+        }
+    }
+
+    /* A token running to the end of the last full block ends with the line */
+    if(!prev && token) token->len = (unsigned char)(scan->len - token->start);
+    scan->trailing_commas = commas;
+}
+
+/**
+ * @brief Classifies the characters of a line block by block, and finds its tokens.
+ *
+ * Full blocks are classified in place; the last, partial block is classified from a padded copy.
+ *
+ * @param line The characters of the line.
+ * @param len Number of characters in the line.
+ * @param scan Pointer to the scan to fill.
+ * @param classify The block classifier.
+ */
+static void scanLineWith(const char *line, size_t len, line_scan *scan,
+                         void (*classify)(const unsigned char *, line_scan *, int)) {
+    unsigned char tail[SCAN_BLOCK_SIZE] = {0};
+    int b, full_blocks;
+
+    if(len > MAX_SCAN_SIZE) len = MAX_SCAN_SIZE;
+    scan->len = (int)len;
+    full_blocks = (int)(len / SCAN_BLOCK_SIZE);
+    scan->blocks = (int)((len + SCAN_BLOCK_SIZE - 1) / SCAN_BLOCK_SIZE);
+
+    for(b = 0; b < full_blocks; b++) classify((const unsigned char *)line + b * SCAN_BLOCK_SIZE, scan, b);
+
+    /* Only the last, partial block is copied, so no block reads past the end of the line */
+    if(full_blocks < scan->blocks) {
+        memcpy(tail, line + full_blocks * SCAN_BLOCK_SIZE, len % SCAN_BLOCK_SIZE);
+        classify(tail, scan, full_blocks);
+    }
+
+    findTokens(scan, scan->blocks);
+}
+
+/**
+ * @brief Classifies the characters of a line and finds its tokens.
+ *
+ * @param line The characters of the line; they need not be null-terminated.
+ * @param len Number of characters in the line.
+ * @param scan Pointer to the scan to fill.
+ */
+void scanLine(const char *line, size_t len, line_scan *scan) {
+#ifdef __SSE2__
+    scanLineWith(line, len, scan, classifyBlockVector);
+#else
+    scanLineWith(line, len, scan, classifyBlockScalar);
+#endif
+}
+
+/**
+ * @brief Classifies the characters of a line with the table, and finds its tokens.
+ *
+ * @param line The characters of the line; they need not be null-terminated.
+ * @param len Number of characters in the line.
+ * @param scan Pointer to the scan to fill.
+ */
+void scanLineScalar(const char *line, size_t len, line_scan *scan) {
+    scanLineWith(line, len, scan, classifyBlockScalar);
+}
+
+/**
+ * @brief Returns whether `scanLine` classifies characters with vector compares.
+ *
+ * @return 1 if the vector classifier is used, 0 otherwise.
+ */
+int isScanVectorized(void) {
+#ifdef __SSE2__
+    return 1;
+#else
+    return 0;
+#endif
+}
+
+/**
+ * @brief Finds the first character of a class, starting from a position.
+ *
+ * @param scan Pointer to the scan of the line.
+ * @param cls The class to look for.
+ * @param from Position to start from.
+ * @return The position of the character, or -1 if there is none.
+ */
+int findCharClass(const line_scan *scan, char_class cls, int from) {
+    int b = from / SCAN_BLOCK_SIZE;
+    unsigned int mask;
+
+    if(from < 0 || from >= scan->len) return -1;
+    mask = scan->masks[cls][b] & ~((1u << (from % SCAN_BLOCK_SIZE)) - 1);
+
+    while(!mask && ++b < scan->blocks) mask = scan->masks[cls][b];
+    return mask ? b * SCAN_BLOCK_SIZE + lowestBit(mask) : -1;
+}
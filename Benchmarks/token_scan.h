@@ -0,0 +1,112 @@
+/**
+ * @author Tal Figenblat
+ * @date October 17, 2026
+ *
+ * @file token_scan.h
+ * @brief Header file for classifying the characters of a line and finding its tokens in one sweep.
+ *
+ * The scanner classifies whitespace, commas, quotes, ':', '#', '*' and ';' a block of
+ * `SCAN_BLOCK_SIZE` characters at a time, and records one bit per character and class.
+ * The boundaries of the tokens are then found from the bits of the separators, so a whole
+ * line is split without visiting its characters one by one. When the compiler targets SSE2,
+ * a block is classified with vector compares; otherwise the class table of the assembler is used.
+ *
+ * This is an experiment kept for the benchmark only. The passes do not use it: on the lines of
+ * ValidInputs and on a synthetic corpus it is only about 1.1 times as fast as `nextSpan`, too little
+ * to rebuild the passes around it. The classifier is selected when compiling; there is no runtime
+ * dispatch between SSE2, AVX2 and the table.
+ */
+
+#ifndef TOKEN_SCAN_H
+#define TOKEN_SCAN_H
+
+#include <stddef.h>
+#include "preprocessor.h"
+#include "char_classes.h"
+
+/**
+ * @def SCAN_BLOCK_SIZE
+ * @brief Number of characters classified together, one bit each.
+ */
+#define SCAN_BLOCK_SIZE 16
+
+/**
+ * @def MAX_SCAN_SIZE
+ * @brief Maximum number of characters scanned in a line: a line of maximum size and its newline.
+ */
+#define MAX_SCAN_SIZE (MAX_LINE_SIZE + 1)
+
+/**
+ * @def MAX_SCAN_BLOCKS
+ * @brief Number of blocks covering a line of maximum size.
+ */
+#define MAX_SCAN_BLOCKS ((MAX_SCAN_SIZE + SCAN_BLOCK_SIZE - 1) / SCAN_BLOCK_SIZE)
+
+/**
+ * @def MAX_LINE_TOKENS
+ * @brief Maximum number of tokens in a line, each followed by at least one separator.
+ */
+#define MAX_LINE_TOKENS ((MAX_SCAN_SIZE + 1) / 2)
+
+/**
+ * @struct token_span
+ * @brief Represents a token of a line: a run of characters that are neither whitespace nor commas.
+ */
+typedef struct {
+    unsigned char start;   /**< Position of the first character of the token. */
+    unsigned char len;     /**< Number of characters in the token. */
+    unsigned char commas;  /**< Number of commas between the previous token and this one. */
+} token_span;
+
+/**
+ * @struct line_scan
+ * @brief Represents the classified characters and the tokens of a line.
+ */
+typedef struct {
+    unsigned int masks[CLASS_COUNT][MAX_SCAN_BLOCKS];  /**< One bit per character and class, by block. */
+    token_span tokens[MAX_LINE_TOKENS];                /**< The tokens of the line, in order. */
+    int token_count;                                   /**< Number of tokens in the line. */
+    int trailing_commas;                               /**< Number of commas after the last token. */
+    int len;                                           /**< Number of characters scanned. */
+    int blocks;                                        /**< Number of blocks covering the characters. */
+} line_scan;
+
+/**
+ * @brief Classifies the characters of a line and finds its tokens.
+ *
+ * Uses the vector classifier when the compiler targets SSE2, and the table otherwise.
+ * At most `MAX_SCAN_SIZE` characters are scanned.
+ *
+ * @param line The characters of the line; they need not be null-terminated.
+ * @param len Number of characters in the line.
+ * @param scan Pointer to the scan to fill.
+ */
+void scanLine(const char *line, size_t len, line_scan *scan);
+
+/**
+ * @brief Classifies the characters of a line with the table, and finds its tokens.
+ *
+ * @param line The characters of the line; they need not be null-terminated.
+ * @param len Number of characters in the line.
+ * @param scan Pointer to the scan to fill.
+ */
+void scanLineScalar(const char *line, size_t len, line_scan *scan);
+
+/**
+ * @brief Returns whether `scanLine` classifies characters with vector compares.
+ *
+ * @return 1 if the vector classifier is used, 0 otherwise.
+ */
+int isScanVectorized(void);
+
+/**
+ * @brief Finds the first character of a class, starting from a position.
+ *
+ * @param scan Pointer to the scan of the line.
+ * @param cls The class to look for.
+ * @param from Position to start from.
+ * @return The position of the character, or -1 if there is none.
+ */
+int findCharClass(const line_scan *scan, char_class cls, int from);
+
+#endif /* TOKEN_SCAN_H */
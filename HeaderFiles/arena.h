@@ -0,0 +1,102 @@
+/**
+ * @author Tal Figenblat
+ * @date October 17, 2026
+ *
+ * @file arena.h
+ * @brief Header file for the arena allocator.
+ *
+ * An arena hands out memory by bumping a pointer through large blocks, and releases
+ * everything it handed out in a single call. Each file gets its own arena, which owns
+ * the labels, the macros and the symbol names of that file.
+ */
+
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+
+/**
+ * @def ARENA_BLOCK_SIZE
+ * @brief Usable size of a regular arena block, in bytes.
+ *
+ * Allocations larger than a quarter of a block get a block of their own.
+ */
+#define ARENA_BLOCK_SIZE 8192
+
+/**
+ * @union arena_align
+ * @brief A type with the strictest alignment needed by the data kept in an arena.
+ */
+typedef union {
+    long l;   /**< Alignment of integers. */
+    double d; /**< Alignment of floating-point numbers. */
+    void *p;  /**< Alignment of pointers. */
+} arena_align;
+
+/**
+ * @struct arena_block
+ * @brief Header of a block of arena memory, followed by the memory itself.
+ */
+typedef struct arena_block {
+    struct arena_block *next; /**< Pointer to the next block. */
+    size_t size;              /**< Usable size of the block, in bytes. */
+    size_t used;              /**< Number of bytes handed out from the block. */
+} arena_block;
+
+/**
+ * @struct arena
+ * @brief Represents an arena and its usage.
+ *
+ * The first block is the one allocations are bumped from.
+ */
+typedef struct {
+    arena_block *head; /**< Pointer to the current block, or NULL if nothing was allocated yet. */
+    size_t bytes;      /**< Number of bytes handed out, including alignment padding. */
+    int blocks;        /**< Number of blocks allocated. */
+} arena;
+
+/**
+ * @brief Initializes an empty arena.
+ *
+ * @param mem Pointer to the arena.
+ */
+void initArena(arena *mem);
+
+/**
+ * @brief Allocates memory from an arena.
+ *
+ * The memory is aligned for any type and lives until the arena is freed.
+ *
+ * @param mem Pointer to the arena.
+ * @param size Number of bytes to allocate.
+ * @return Pointer to the memory, or NULL if memory allocation failed.
+ */
+void *arenaAlloc(arena *mem, size_t size);
+
+/**
+ * @brief Copies a block of text into an arena, adding a null terminator.
+ *
+ * @param mem Pointer to the arena.
+ * @param str The text to copy.
+ * @param len Length of the text, in bytes.
+ * @return Pointer to the copy, or NULL if memory allocation failed.
+ */
+char *arenaMemdup(arena *mem, const char *str, size_t len);
+
+/**
+ * @brief Copies a string into an arena.
+ *
+ * @param mem Pointer to the arena.
+ * @param str The string to copy.
+ * @return Pointer to the copy, or NULL if memory allocation failed.
+ */
+char *arenaStrdup(arena *mem, const char *str);
+
+/**
+ * @brief Frees all the memory of an arena and leaves it empty.
+ *
+ * @param mem Pointer to the arena.
+ */
+void freeArena(arena *mem);
+
+#endif /* ARENA_H */
@@ -0,0 +1,101 @@
+/**
+ * @author Tal Figenblat
+ * @date October 17, 2026
+ *
+ * @file buffer_utils.h
+ * @brief Header file for growable in-memory text buffers.
+ *
+ * A text buffer holds text of known length in a heap block that grows geometrically,
+ * so appending to it costs amortized constant time per byte. Buffers are used to keep
+ * the expanded source in memory between the preprocessor and the passes.
+ */
+
+#ifndef BUFFER_UTILS_H
+#define BUFFER_UTILS_H
+
+#include <stdio.h>
+#include <stddef.h>
+
+/**
+ * @def BUFFER_INIT_SIZE
+ * @brief Initial capacity of a text buffer, in bytes.
+ */
+#define BUFFER_INIT_SIZE 256
+
+/**
+ * @def BUFFER_READ_SIZE
+ * @brief Size of the chunks files are read in.
+ */
+#define BUFFER_READ_SIZE 8192
+
+/**
+ * @struct text_buffer
+ * @brief Represents a growable block of text.
+ *
+ * The text is always followed by a null terminator, which is not counted in `len`.
+ */
+typedef struct {
+    char *data;  /**< The text, or NULL if nothing was appended yet. */
+    size_t len;  /**< Length of the text, in bytes. */
+    size_t size; /**< Capacity of the block, in bytes. */
+} text_buffer;
+
+/**
+ * @brief Initializes an empty text buffer.
+ *
+ * @param buf Pointer to the text buffer.
+ */
+void initTextBuffer(text_buffer *buf);
+
+/**
+ * @brief Empties a text buffer, keeping its memory for reuse.
+ *
+ * @param buf Pointer to the text buffer.
+ */
+void clearTextBuffer(text_buffer *buf);
+
+/**
+ * @brief Appends text of known length to a text buffer.
+ *
+ * @param buf Pointer to the text buffer.
+ * @param str The text to append.
+ * @param len Length of the text, in bytes.
+ * @return EXIT_SUCCESS if the text was appended, EXIT_FAILURE if memory allocation failed.
+ */
+int appendTextBuffer(text_buffer *buf, const char *str, size_t len);
+
+/**
+ * @brief Appends a null-terminated string to a text buffer.
+ *
+ * @param buf Pointer to the text buffer.
+ * @param str The string to append.
+ * @return EXIT_SUCCESS if the string was appended, EXIT_FAILURE if memory allocation failed.
+ */
+int appendTextBufferString(text_buffer *buf, const char *str);
+
+/**
+ * @brief Writes the content of a text buffer to a file with a single call.
+ *
+ * @param buf Pointer to the text buffer.
+ * @param fp The file to write to.
+ * @return EXIT_SUCCESS if all the text was written, EXIT_FAILURE otherwise.
+ */
+int writeTextBuffer(const text_buffer *buf, FILE *fp);
+
+/**
+ * @brief Appends everything left in a file to a text buffer.
+ *
+ * @param buf Pointer to the text buffer.
+ * @param fp The file to read from.
+ * @return EXIT_SUCCESS if the file was read to its end, EXIT_FAILURE otherwise.
+ */
+int readTextBuffer(text_buffer *buf, FILE *fp);
+
+/**
+ * @brief Frees the memory of a text buffer and leaves it empty.
+ *
+ * @param buf Pointer to the text buffer.
+ */
+void freeTextBuffer(text_buffer *buf);
+
+#endif /* BUFFER_UTILS_H */
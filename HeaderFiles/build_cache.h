@@ -0,0 +1,169 @@
+/**
+ * @author Tal Figenblat
+ * @date October 17, 2026
+ *
+ * @file build_cache.h
+ * @brief Header file for the content-addressed build cache of the assembler.
+ *
+ * With "--cache-dir", every source file is keyed on the SHA-256 digest of the assembler
+ * version, the options that change the output, the file name and the bytes of the ".as" file.
+ * On a hit, the ".am", ".ob", ".ent" and ".ext" files and the messages of the file are restored
+ * from the entry without assembling it. On a miss, the file is assembled and an entry is stored.
+ *
+ * Entries are written to a temporary file and renamed into place, so concurrent invocations
+ * sharing a cache directory only ever see complete entries. The least recently used entries
+ * are removed when the cache grows past its size.
+ */
+
+#ifndef BUILD_CACHE_H
+#define BUILD_CACHE_H
+
+#include "buffer_utils.h"
+#include "log_utils.h"
+#include "options.h"
+#include "output_writer.h"
+#include "sha256.h"
+
+/**
+ * @def CACHE_MAGIC
+ * @brief First word of every cache entry, identifying its format.
+ */
+#define CACHE_MAGIC "ASMCACHE1"
+
+/**
+ * @def CACHE_SUFFIX
+ * @brief Suffix of the cache entries in the cache directory.
+ */
+#define CACHE_SUFFIX ".cache"
+
+/**
+ * @def CACHE_TMP_SUFFIX
+ * @brief Suffix added to the path of an entry for the temporary file it is written to.
+ */
+#define CACHE_TMP_SUFFIX ".tmp."
+
+/**
+ * @def CACHE_TMP_MAX_AGE
+ * @brief Age, in seconds, after which a temporary file is left by an interrupted run and removed.
+ */
+#define CACHE_TMP_MAX_AGE 3600
+
+/**
+ * @def CACHE_KEY_SIZE
+ * @brief Number of hexadecimal digits in the key of an entry.
+ */
+#define CACHE_KEY_SIZE (SHA256_DIGEST_SIZE * 2)
+
+/**
+ * @def READ_FILE_MISSING
+ * @brief Returned by `readWholeFile` when the file does not exist, as opposed to EXIT_FAILURE when it could not be read.
+ */
+#define READ_FILE_MISSING 2
+
+/**
+ * @struct cache_entry
+ * @brief Represents the outcome of assembling a file: its result, messages and output files.
+ */
+typedef struct {
+    int result;         /**< The value returned by the preprocessor. */
+    text_buffer log;    /**< The messages printed to the standard output. */
+    output_set outputs; /**< The output files. */
+} cache_entry;
+
+/**
+ * @brief Prepares the cache directory, creating it when needed.
+ *
+ * @param opts Pointer to the options; the cache is disabled if its directory cannot be created.
+ */
+void openBuildCache(assembler_options *opts);
+
+/**
+ * @brief Assembles a file through the build cache.
+ *
+ * @param file_name The name of the source file (without extension).
+ * @param opts Pointer to the command-line options.
+ * @return The value the preprocessor returned for this source.
+ */
+int assembleCached(char *file_name, const assembler_options *opts);
+
+/**
+ * @brief Removes the least recently used entries until the cache fits in its size.
+ *
+ * Temporary files older than CACHE_TMP_MAX_AGE, left by runs killed while storing an entry,
+ * are removed as well.
+ *
+ * @param opts Pointer to the command-line options.
+ */
+void trimBuildCache(const assembler_options *opts);
+
+/**
+ * @brief Reads a whole file into a text buffer.
+ *
+ * @param name The path of the file.
+ * @param buf Pointer to an empty text buffer receiving the content.
+ * @return EXIT_SUCCESS if the file was read, READ_FILE_MISSING if it does not exist, EXIT_FAILURE otherwise.
+ */
+int readWholeFile(const char *name, text_buffer *buf);
+
+/**
+ * @brief Computes the key of a source file.
+ *
+ * @param file_name The name of the source file (without extension).
+ * @param opts Pointer to the command-line options.
+ * @param key Receives the key, as hexadecimal digits followed by a null terminator.
+ * @return EXIT_SUCCESS if the key was computed, EXIT_FAILURE if the source could not be read.
+ */
+int computeCacheKey(const char *file_name, const assembler_options *opts, char key[CACHE_KEY_SIZE + 1]);
+
+/**
+ * @brief Makes the path of an entry of the cache.
+ *
+ * @param opts Pointer to the command-line options.
+ * @param key The key of the entry.
+ * @return The path, to be freed by the caller, or NULL if memory allocation failed.
+ */
+char *getCachePath(const assembler_options *opts, const char *key);
+
+/**
+ * @brief Initializes an empty cache entry.
+ *
+ * @param entry Pointer to the entry.
+ */
+void initCacheEntry(cache_entry *entry);
+
+/**
+ * @brief Loads an entry from the cache.
+ *
+ * @param path The path of the entry.
+ * @param entry Pointer to an empty entry receiving the content.
+ * @return EXIT_SUCCESS if a complete entry was loaded, EXIT_FAILURE otherwise.
+ */
+int loadCacheEntry(const char *path, cache_entry *entry);
+
+/**
+ * @brief Stores an entry in the cache atomically.
+ *
+ * @param path The path of the entry.
+ * @param entry Pointer to the entry.
+ * @return EXIT_SUCCESS if the entry was stored, EXIT_FAILURE otherwise.
+ */
+int storeCacheEntry(const char *path, const cache_entry *entry);
+
+/**
+ * @brief Writes the output files of an entry, and removes the ones it does not have.
+ *
+ * @param file_name The name of the source file (without extension).
+ * @param opts Pointer to the command-line options.
+ * @param entry Pointer to the entry.
+ * @return EXIT_SUCCESS if every file was written, EXIT_FAILURE otherwise.
+ */
+int restoreCacheOutputs(const char *file_name, const assembler_options *opts, const cache_entry *entry);
+
+/**
+ * @brief Frees the memory of a cache entry.
+ *
+ * @param entry Pointer to the entry.
+ */
+void freeCacheEntry(cache_entry *entry);
+
+#endif /* BUILD_CACHE_H */
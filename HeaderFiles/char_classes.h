@@ -0,0 +1,52 @@
+/**
+ * @author Tal Figenblat
+ * @date October 17, 2026
+ *
+ * @file char_classes.h
+ * @brief Header file for the table classifying the characters the passes look for.
+ *
+ * The tokenizer tests whitespace with a lookup in this table instead of calling `isspace`.
+ */
+
+#ifndef CHAR_CLASSES_H
+#define CHAR_CLASSES_H
+
+/**
+ * @enum char_class
+ * @brief Classes of the characters the passes look for.
+ */
+typedef enum {
+    CLASS_SPACE,      /**< Whitespace, as classified by `isspace` in the "C" locale. */
+    CLASS_COMMA,      /**< The operand separator ','. */
+    CLASS_QUOTE,      /**< The string delimiter '"'. */
+    CLASS_COLON,      /**< The label terminator ':'. */
+    CLASS_HASH,       /**< The immediate operand prefix '#'. */
+    CLASS_STAR,       /**< The indirect register prefix '*'. */
+    CLASS_SEMICOLON,  /**< The comment prefix ';'. */
+    CLASS_COUNT       /**< Number of character classes. */
+} char_class;
+
+/**
+ * @def CHAR_SPACE
+ * @brief Bit of whitespace characters in `char_classes`; the other classes follow in order.
+ */
+#define CHAR_SPACE (1 << CLASS_SPACE)
+
+/**
+ * @def CHAR_COMMA
+ * @brief Bit of commas in `char_classes`.
+ */
+#define CHAR_COMMA (1 << CLASS_COMMA)
+
+/**
+ * @brief Class bits of every character.
+ */
+extern const unsigned char char_classes[256];
+
+/**
+ * @def IS_SPACE
+ * @brief Classifies whitespace with the table, the way `isspace` does in the "C" locale.
+ */
+#define IS_SPACE(c) (char_classes[(unsigned char)(c)] & CHAR_SPACE)
+
+#endif /* CHAR_CLASSES_H */
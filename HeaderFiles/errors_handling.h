@@ -14,7 +14,15 @@
 
 #include "macr.h"
 #include "label.h"
+#include "fixup.h"
 #include "globals.h"
+#include "segment.h"
+
+/**
+ * @def EXIT_ABORT
+ * @brief Status returned when the current file cannot be processed any further, e.g. when memory allocation failed.
+ */
+#define EXIT_ABORT (-1)
 
 /**
  * @enum Error
@@ -51,7 +59,20 @@ typedef enum {
     FILE_DELETION_FAILED,             /**< File deletion failed due to an error. */
     NUMBER_OUT_OF_RANGE,              /**< Numeric value is out of the allowed range. */
     UNDEFINED_LABEL,                  /**< Label referenced but not defined. */
-    MULTIPLE_MACRO_DEFINITIONS        /**< Macro has more than one definition. */
+    MULTIPLE_MACRO_DEFINITIONS,       /**< Macro has more than one definition. */
+    UNKNOWN_OPTION,                   /**< Command-line option is not recognized. */
+    INVALID_OPTION_VALUE,             /**< Command-line option has an invalid value. */
+    FILE_WRITE_FAILED,                /**< Failed to write the specified file. */
+    TEXT_OUTSIDE_MACRO,               /**< Macro library has text outside of a macro definition. */
+    STDIN_NOT_ALONE,                  /**< The standard input is given together with other files. */
+    STDIN_READ_FAILED,                /**< Failed to read the source from the standard input. */
+    INVALID_REQUEST,                  /**< A request sent to the server is malformed. */
+    DUPLICATE_EXPORT,                 /**< An entry label is exported by more than one linked object. */
+    UNRESOLVED_EXTERN,                /**< An external label is not exported by any linked object. */
+    EXTERN_OUTSIDE_CODE,              /**< An external label is used outside the instructions of its object. */
+    ADDRESS_OUTSIDE_OBJECT,           /**< An address of a linked object points outside the object. */
+    IMAGE_TOO_LARGE,                  /**< The linked image does not fit in the memory. */
+    ADDRESS_TOO_LARGE                 /**< An address does not fit in the address field of a word. */
 } Error;
 
 /**
@@ -71,59 +92,50 @@ void printError(int line_counter, Error err);
 const char *getError(int error_code);
 
 /**
- * @brief Handles memory allocation failure by printing an error and closing files.
- *
- * @param ptr Pointer to the allocated memory. If NULL, the function will handle the failure.
- * @param tb Pointer to the macro table to be freed.
- * @param fp1 Pointer to the first file to be closed.
- * @param fp2 Pointer to the second file to be closed.
- */
-void allocFail(const char *ptr, macr_table *tb, FILE *fp1, FILE *fp2);
-
-/**
- * @brief Checks if any lines in the specified file are too long.
+ * @brief Checks if a line is too long.
  *
- * @param fp The file pointer to read from.
- * @param line A pointer to the line buffer to check.
+ * @param len The length of the line, without its newline character.
  * @param line_counter The current line number being checked.
  * @return EXIT_SUCCESS if the line is of acceptable length; otherwise, EXIT_FAILURE.
  */
-int checkLine(FILE *fp, char *line, int line_counter);
+int checkLine(size_t len, int line_counter);
 
 /**
  * @brief Validates and processes an opcode operation, checking operands and encoding the instruction.
  *
  * @param op The opcode to validate.
  * @param ptr Pointer to the current position in the string being processed.
- * @param iptr Pointer to the memory location where the instruction will be encoded.
+ * @param seg Pointer to the instruction segment the instruction is encoded into.
  * @param idx The current index in the instruction memory.
  * @param line_counter The line number for error reporting.
  * @param label_tb Pointer to the label table used for resolving addresses.
  * @param macr_tb Pointer to the macro table used for resolving macro names.
+ * @param fixup_tb Pointer to the fixup table receiving the operands that refer to labels.
  * @return The number of memory words used by the instruction, or 0 if an error occurs.
  */
-int isLegalOpcode(opcode op, char *ptr, unsigned short *iptr, int idx, int line_counter, label_table *label_tb, macr_table *macr_tb);
+int isLegalOpcode(opcode op, char *ptr, memory_segment *seg, int idx, int line_counter,
+                  label_table *label_tb, macr_table *macr_tb, fixup_table *fixup_tb);
 
 /**
  * @brief Validates and processes data input, checking if it's legal and encoding it.
  *
  * @param ptr Pointer to the current position in the string being processed.
- * @param dptr Pointer to the memory location where the data will be encoded.
+ * @param seg Pointer to the data segment the data is encoded into.
  * @param idx The current index in the data memory.
  * @param line_counter The line number for error reporting.
  * @return The count of valid data entries or 0 if an error occurs.
  */
-int isLegalData(char *ptr, unsigned short *dptr, int idx, int line_counter);
+int isLegalData(char *ptr, memory_segment *seg, int idx, int line_counter);
 
 /**
  * @brief Validates and processes string input, checking if it's legal and encoding it.
  *
  * @param ptr Pointer to the current position in the string being processed.
- * @param dptr Pointer to the memory location where the string will be encoded.
+ * @param seg Pointer to the data segment the string is encoded into.
  * @param idx The current index in the data memory.
  * @param line_counter The line number for error reporting.
  * @return The length of the string if valid, or 0 if an error occurs.
  */
-int isLegalString(char *ptr, unsigned short *dptr, int idx, int line_counter);
+int isLegalString(char *ptr, memory_segment *seg, int idx, int line_counter);
 
 #endif /* ERRORS_HANDLING_H */
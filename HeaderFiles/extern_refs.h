@@ -0,0 +1,106 @@
+/**
+ * @author Tal Figenblat
+ * @date October 17, 2026
+ *
+ * @file extern_refs.h
+ * @brief Header file for the table of uses of external labels.
+ *
+ * While the fixups are resolved, each use of an external label is only recorded as the number
+ * of the label and the address of the word using it. Once every use is known, the table is put
+ * in the selected order and written in one go, so the ".ext" file is only created when an
+ * external label is actually used.
+ */
+
+#ifndef EXTERN_REFS_H
+#define EXTERN_REFS_H
+
+#include "label.h"
+#include "output_writer.h"
+#include "object_file.h"
+
+/**
+ * @enum extern_order
+ * @brief The orders the uses of external labels are written in.
+ */
+typedef enum {
+    EXTERN_ORDER_SOURCE,  /**< In source order (the default). */
+    EXTERN_ORDER_GROUPED, /**< Grouped by label, in declaration order, each in source order. */
+    EXTERN_ORDER_SORTED   /**< Grouped by label, sorted by name, each in source order. */
+} extern_order;
+
+/**
+ * @struct extern_ref
+ * @brief Represents a single use of an external label.
+ */
+typedef struct {
+    int symbol;  /**< The number of the external label. */
+    int address; /**< Address of the word using the label. */
+} extern_ref;
+
+/**
+ * @struct extern_table
+ * @brief Represents the uses of external labels of a file, in an array sized once.
+ */
+typedef struct {
+    extern_ref *items;   /**< The uses, in source order until they are ordered. */
+    int count;           /**< Number of uses in the table. */
+    int size;            /**< Capacity of the array. */
+    const char **names;  /**< Name of each external label by number, once the table is ordered. */
+    int name_count;      /**< Number of external labels in `names`. */
+} extern_table;
+
+/**
+ * @brief Initializes an empty table for a given number of uses.
+ *
+ * @param tb Pointer to the table.
+ * @param size Largest number of uses, such as the number of fixups of the file.
+ * @return EXIT_SUCCESS if the table was initialized, EXIT_FAILURE if memory allocation failed.
+ */
+int initExternTable(extern_table *tb, int size);
+
+/**
+ * @brief Records a use of an external label.
+ *
+ * @param tb Pointer to the table, which must have room for the use.
+ * @param symbol The number of the external label.
+ * @param address Address of the word using the label.
+ */
+void addExternRef(extern_table *tb, int symbol, int address);
+
+/**
+ * @brief Puts the uses in the selected order, once they are all recorded.
+ *
+ * Grouping is a stable counting sort over the label numbers, so the uses of each label stay
+ * in source order.
+ *
+ * @param tb Pointer to the table.
+ * @param label_tb Pointer to the label table, whose external labels are numbered.
+ * @param order The order of the uses.
+ * @return EXIT_SUCCESS if the table was ordered, EXIT_FAILURE if memory allocation failed.
+ */
+int orderExternRefs(extern_table *tb, const label_table *label_tb, extern_order order);
+
+/**
+ * @brief Writes the ".ext" file: the name of the label and the address of each use, one per line.
+ *
+ * @param tb Pointer to the ordered table.
+ * @param w Pointer to the writer of the file.
+ */
+void writeExternRefs(const extern_table *tb, output_writer *w);
+
+/**
+ * @brief Fills the symbols of the uses for the binary object file, in the order of the table.
+ *
+ * @param tb Pointer to the ordered table.
+ * @param symbols The array receiving one symbol per use.
+ */
+void fillExternSymbols(const extern_table *tb, object_symbol *symbols);
+
+/**
+ * @brief Frees the memory of the table.
+ *
+ * @param tb Pointer to the table.
+ */
+void freeExternTable(extern_table *tb);
+
+#endif /* EXTERN_REFS_H */
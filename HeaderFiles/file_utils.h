@@ -12,21 +12,16 @@
 
 #include <stdio.h>
 #include "label.h"
+#include "output_writer.h"
 
 /**
  * @brief Appends a suffix to a given string and returns the new string.
  *
  * @param str The original string.
  * @param suffix The suffix to append.
- * @param label_tb Pointer to the label table for memory cleanup in case of failure.
- * @param macr_tb Pointer to the macro table for memory cleanup in case of failure.
- * @param fp1 Pointer to the first file for cleanup in case of failure.
- * @param fp2 Pointer to the second file for cleanup in case of failure.
- * @param fp3 Pointer to the third file for cleanup in case of failure.
- * @return char* The newly created string with the suffix appended.
+ * @return char* The newly created string with the suffix appended, or NULL if memory allocation failed.
  */
-char *append_suffix(const char *str, const char *suffix, label_table *label_tb,
-                    macr_table *macr_tb, FILE *fp1, FILE *fp2, FILE *fp3);
+char *append_suffix(const char *str, const char *suffix);
 
 /**
  * @brief Opens a file with a specified suffix and mode.
@@ -34,24 +29,18 @@ char *append_suffix(const char *str, const char *suffix, label_table *label_tb,
  * @param file_name The name of the file to open.
  * @param suffix The suffix to append to the file name.
  * @param mode The mode in which to open the file (e.g., "r", "w").
- * @param label_tb Pointer to the label table for memory cleanup in case of failure.
- * @param macr_tb Pointer to the macro table for memory cleanup in case of failure.
- * @param fp1 Pointer to the first file for cleanup in case of failure.
- * @param fp2 Pointer to the second file for cleanup in case of failure.
- * @param fp3 Pointer to the third file for cleanup in case of failure.
- * @return FILE* The file pointer of the opened file.
+ * @return FILE* The file pointer of the opened file, or NULL if the file could not be opened.
  */
-FILE *open_file_with_suffix(const char *file_name, const char *suffix, const char *mode,
-                            label_table *label_tb, macr_table *macr_tb, FILE *fp1, FILE *fp2, FILE *fp3);
+FILE *open_file_with_suffix(const char *file_name, const char *suffix, const char *mode);
 
 /**
  * @brief Prints the instructions stored in memory to the specified file.
  *
  * @param ptr Pointer to the array of instructions.
  * @param IC The instruction count.
- * @param fp The file pointer where the instructions will be printed.
+ * @param w The writer of the file where the instructions will be printed.
  */
-void print_instructions(unsigned short *ptr, int IC, FILE *fp);
+void print_instructions(unsigned short *ptr, int IC, output_writer *w);
 
 /**
  * @brief Prints the data section stored in memory to the specified file.
@@ -59,17 +48,17 @@ void print_instructions(unsigned short *ptr, int IC, FILE *fp);
  * @param ptr Pointer to the array of data.
  * @param IC The instruction count to offset the data indices.
  * @param DC The data count.
- * @param fp The file pointer where the data will be printed.
+ * @param w The writer of the file where the data will be printed.
  */
-void print_data(unsigned short *ptr, int IC, int DC, FILE *fp);
+void print_data(unsigned short *ptr, int IC, int DC, output_writer *w);
 
 /**
  * @brief Creates an entry file listing all labels marked as entry.
  *
  * @param label_tb Pointer to the label table.
- * @param fp The file pointer where the entry labels will be printed.
+ * @param w The writer of the file where the entry labels will be printed.
  */
-void create_entry_file(label_table *label_tb, FILE *fp);
+void create_entry_file(label_table *label_tb, output_writer *w);
 
 /**
  * @brief Closes multiple files safely.
@@ -93,9 +82,16 @@ void remove_file(const char *file_name);
  *
  * @param file_name The original file name.
  * @param suffix The suffix to append.
- * @param label_tb Pointer to the label table (used if necessary).
  */
-void process_file(const char *file_name, const char *suffix, void *label_tb);
+void process_file(const char *file_name, const char *suffix);
+
+/**
+ * @brief Removes a file left by an earlier run, if there is one, without reporting anything.
+ *
+ * @param file_name The original file name.
+ * @param suffix The suffix to append.
+ */
+void discard_file(const char *file_name, const char *suffix);
 
 /**
  * @brief The main assembler function.
@@ -12,6 +12,10 @@
 
 #include <stdio.h>
 #include "macr.h"
+#include "buffer_utils.h"
+#include "arena.h"
+#include "output_writer.h"
+#include "options.h"
 
 /**
  * @def MEMORY_SIZE
@@ -19,6 +23,12 @@
  */
 #define MEMORY_SIZE 4096
 
+/**
+ * @def MAX_INSTRUCTION_WORDS
+ * @brief Largest number of words taken by a single instruction.
+ */
+#define MAX_INSTRUCTION_WORDS 3
+
 /**
  * @brief Performs the first pass of the assembler.
  *
@@ -27,8 +37,13 @@
  *
  * @param file_nam The name of the input file to be processed.
  * @param macr_tb Pointer to the macro table used for storing and expanding macros.
+ * @param am Pointer to the expanded source produced by the preprocessor.
+ * @param mem Pointer to the arena of the file, which owns the labels.
+ * @param opts Pointer to the command-line options.
+ * @param outputs Pointer to the set collecting the output files in memory, or NULL to write them.
  * @return int Returns 0 on success, or a non-zero error code if an error occurs.
  */
-int first_pass(char *file_nam, macr_table *macr_tb);
+int first_pass(char *file_nam, macr_table *macr_tb, text_buffer *am, arena *mem, const assembler_options *opts,
+               output_set *outputs);
 
 #endif /* FIRST_PASS_H */
@@ -0,0 +1,84 @@
+/**
+ * @author Tal Figenblat
+ * @date October 17, 2026
+ *
+ * @file fixup.h
+ * @brief Header file for the list of label references that are resolved after the first pass.
+ *
+ * During the first pass every instruction is encoded completely, except for the words that hold
+ * the address of a label, which may not be defined yet. Each such word, and each ".entry"
+ * directive, is recorded as a fixup. After the first pass, a single sweep over the fixups
+ * patches the words, emits the external references and checks the entry labels.
+ */
+
+#ifndef FIXUP_H
+#define FIXUP_H
+
+#include "arena.h"
+#include "token_utils.h"
+
+/**
+ * @def FIXUP_TABLE_INIT_SIZE
+ * @brief Initial capacity of a fixup table.
+ */
+#define FIXUP_TABLE_INIT_SIZE 64
+
+/**
+ * @enum fixup_kind
+ * @brief Enum representing the kinds of references that are resolved after the first pass.
+ */
+typedef enum {
+    FIXUP_OPERAND, /**< A direct addressing operand whose word receives the label's address. */
+    FIXUP_ENTRY    /**< A ".entry" directive whose label must be defined in the file. */
+} fixup_kind;
+
+/**
+ * @struct fixup
+ * @brief Represents a single unresolved reference to a label.
+ */
+typedef struct {
+    fixup_kind kind;  /**< The kind of the reference. */
+    int idx;          /**< Index of the instruction word to patch (operands only). */
+    char *name;       /**< Name of the referenced label. */
+    int line_counter; /**< Line of the reference, for error reporting. */
+} fixup;
+
+/**
+ * @struct fixup_table
+ * @brief Represents the fixups of a file, kept in source order in a growable array.
+ */
+typedef struct {
+    fixup *items; /**< The fixups, in the order they were recorded. */
+    int count;    /**< Number of fixups in the table. */
+    int size;     /**< Capacity of the array. */
+    arena *mem;   /**< Arena owning the label names. */
+} fixup_table;
+
+/**
+ * @brief Initializes an empty fixup table.
+ *
+ * @param tb Pointer to the fixup table.
+ * @param mem Pointer to the arena the label names are copied into.
+ */
+void initFixupTable(fixup_table *tb, arena *mem);
+
+/**
+ * @brief Appends a fixup to the table.
+ *
+ * @param tb Pointer to the fixup table.
+ * @param kind The kind of the reference.
+ * @param idx Index of the instruction word to patch (ignored for entries).
+ * @param name Name of the referenced label, as a span; the table keeps its own copy in its arena.
+ * @param line_counter Line of the reference.
+ * @return EXIT_SUCCESS if the fixup was added, EXIT_FAILURE if memory allocation failed.
+ */
+int addFixup(fixup_table *tb, fixup_kind kind, int idx, text_span name, int line_counter);
+
+/**
+ * @brief Frees the memory of the fixup table that is not owned by its arena.
+ *
+ * @param tb Pointer to the fixup table.
+ */
+void freeFixupTable(fixup_table *tb);
+
+#endif /* FIXUP_H */
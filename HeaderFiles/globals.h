@@ -10,6 +10,8 @@
 #ifndef GLOBALS_H
 #define GLOBALS_H
 
+#include "token_utils.h"
+
 /**
  * @def OPCODE_COUNT
  * @brief Number of opcodes supported by the assembler.
@@ -38,18 +40,6 @@ typedef enum {
     unknown_opcode /**< Represents an unknown opcode */
 } opcode;
 
-/**
- * @struct opcodeMapping
- * @brief Structure for mapping a string to its corresponding opcode.
- *
- * The `opcodeMapping` structure contains a string name and the corresponding
- * opcode value, allowing the assembler to match strings to opcodes.
- */
-typedef struct {
-    const char *name; /**< The string representation of the opcode */
-    opcode value;     /**< The corresponding opcode value */
-} opcodeMapping;
-
 /**
  * @enum regis
  * @brief Enum representing the different registers in the assembler.
@@ -62,13 +52,70 @@ typedef enum {
 } regis;
 
 /**
- * @struct registerMapping
- * @brief Structure for mapping a string to its corresponding register.
+ * @def KEYWORD_TABLE_SIZE
+ * @brief Number of slots in the perfect hash table of reserved words (a power of two).
+ */
+#define KEYWORD_TABLE_SIZE 64
+
+/**
+ * @def MAX_KEYWORD_SIZE
+ * @brief Length of the longest reserved word ("endmacr", ".string" and ".extern").
+ */
+#define MAX_KEYWORD_SIZE 7
+
+/**
+ * @enum keyword_kind
+ * @brief Enum representing the classes of reserved words in the assembler.
+ */
+typedef enum {
+    KEYWORD_NONE,     /**< Not a reserved word */
+    KEYWORD_OPCODE,   /**< One of the opcodes */
+    KEYWORD_REGISTER, /**< One of the registers */
+    KEYWORD_MACR,     /**< The "macr" keyword */
+    KEYWORD_ENDMACR,  /**< The "endmacr" keyword */
+    KEYWORD_DATA,     /**< The ".data" directive */
+    KEYWORD_STRING,   /**< The ".string" directive */
+    KEYWORD_ENTRY,    /**< The ".entry" directive */
+    KEYWORD_EXTERN    /**< The ".extern" directive */
+} keyword_kind;
+
+/**
+ * @struct keywordMapping
+ * @brief Structure for mapping a reserved word to its class and value.
+ *
+ * For opcodes and registers, `value` holds the corresponding `opcode` or `regis` value.
  */
 typedef struct {
-    const char *name; /**< The string representation of the register */
-    regis value;      /**< The corresponding register value */
-} registerMapping;
+    const char *name;  /**< The string representation of the reserved word */
+    keyword_kind kind; /**< The class of the reserved word */
+    int value;         /**< The corresponding opcode or register value */
+} keywordMapping;
+
+/**
+ * @brief Looks up a reserved word in the perfect hash table of keywords.
+ *
+ * The table is collision-free, so every lookup costs a single probe and one string compare.
+ *
+ * @param str The string to look up.
+ * @return Pointer to the keyword mapping, or NULL if the string is not a reserved word.
+ */
+const keywordMapping *get_keyword(const char *str);
+
+/**
+ * @brief Looks up a token in the perfect hash table of keywords, without copying it.
+ *
+ * @param token The token to look up.
+ * @return Pointer to the keyword mapping, or NULL if the token is not a reserved word.
+ */
+const keywordMapping *get_keyword_span(text_span token);
+
+/**
+ * @brief Retrieves the class of a reserved word.
+ *
+ * @param str The string to classify.
+ * @return The class of the reserved word, or `KEYWORD_NONE` if the string is not reserved.
+ */
+keyword_kind get_keyword_kind(const char *str);
 
 /**
  * @brief Retrieves the opcode corresponding to a given string.
@@ -86,4 +133,12 @@ opcode get_opcode(const char *str);
  */
 regis get_register(const char *str);
 
+/**
+ * @brief Retrieves the register corresponding to a token, without copying it.
+ *
+ * @param token The token naming the register.
+ * @return The corresponding register value, or `unknown_register` if not found.
+ */
+regis get_register_span(text_span token);
+
 #endif /* GLOBALS_H */
@@ -11,6 +11,8 @@
 #ifndef INTEGER_UTILS_H
 #define INTEGER_UTILS_H
 
+#include "token_utils.h"
+
 /**
  * @def DATA_MAX_VALUE
  * @brief Maximum value for data integers.
@@ -50,7 +52,7 @@ int countDigits(int num);
  * @param line_counter The line number for error reporting.
  * @return The parsed integer value, or DATA_MAX_VALUE + 1 if there is an error.
  */
-int parseDataInt(char *str, int line_counter);
+int parseDataInt(text_span str, int line_counter);
 
 /**
  * @brief Parses a string to an integer for instruction-specific values.
@@ -62,6 +64,6 @@ int parseDataInt(char *str, int line_counter);
  * @param line_counter The line number for error reporting.
  * @return The parsed integer value, or INSTRUCTION_MAX_VALUE + 1 if there is an error.
  */
-int parseInstructionInt(char *str, int line_counter);
+int parseInstructionInt(text_span str, int line_counter);
 
 #endif /* INTEGER_UTILS_H */
@@ -0,0 +1,53 @@
+/**
+ * @author Tal Figenblat
+ * @date October 17, 2026
+ *
+ * @file job_pool.h
+ * @brief Header file for assembling several files in parallel.
+ *
+ * A fixed number of worker threads take the files one by one, in command-line order,
+ * and assemble each of them with the preprocessor and both passes. The messages of each
+ * file are collected in its own file log, and printed in command-line order as soon as
+ * all the files before it are done, so the output matches a sequential run.
+ */
+
+#ifndef JOB_POOL_H
+#define JOB_POOL_H
+
+#include <pthread.h>
+#include "log_utils.h"
+#include "options.h"
+
+/**
+ * @struct job_pool
+ * @brief Holds the state shared by the worker threads.
+ */
+typedef struct {
+    const assembler_options *opts; /**< The options, holding the files to assemble. */
+    file_log *logs;                /**< The log of each file. */
+    int *results;                  /**< The exit status of each file. */
+    int *done;                     /**< Whether each file has been assembled. */
+    int next;                      /**< Index of the next file to assemble. */
+    pthread_mutex_t lock;          /**< Protects `next`, `results` and `done`. */
+    pthread_cond_t file_done;      /**< Signaled whenever a file has been assembled. */
+} job_pool;
+
+/**
+ * @brief Assembles files taken from the pool until no file is left.
+ *
+ * This is the body of each worker thread.
+ *
+ * @param arg Pointer to the job pool.
+ * @return NULL.
+ */
+void *runJobWorker(void *arg);
+
+/**
+ * @brief Assembles the files given in the options on up to `opts->jobs` worker threads.
+ *
+ * @param opts Pointer to the options, holding the files to assemble.
+ * @return int Returns 1 if errors were found in any file, otherwise returns 0.
+ */
+int runJobPool(const assembler_options *opts);
+
+#endif /* JOB_POOL_H */
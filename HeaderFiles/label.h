@@ -15,38 +15,101 @@
 
 #include "macr.h"
 #include "globals.h"
+#include "arena.h"
+#include "stats.h"
+
+/**
+ * @enum label_segment
+ * @brief The segments a label may be defined in.
+ *
+ * A label holds its offset within its segment; the address of each segment is only known once
+ * the first pass is done, and is set once for the whole table.
+ */
+typedef enum {
+    SEGMENT_NONE,   /**< The label is not defined (yet). */
+    SEGMENT_CODE,   /**< The instruction segment. */
+    SEGMENT_DATA,   /**< The data segment, which follows the instructions. */
+    SEGMENT_EXTERN, /**< Another file; the address of an external label is 0. */
+    SEGMENT_COUNT   /**< Number of segments. */
+} label_segment;
+
+/**
+ * @def LABEL_ENTRY
+ * @brief Attribute of a label declared with ".entry".
+ */
+#define LABEL_ENTRY (1 << 0)
+
+/**
+ * @def LABEL_EXTERN
+ * @brief Attribute of a label declared with ".extern".
+ */
+#define LABEL_EXTERN (1 << 1)
+
+/**
+ * @def LABEL_DEFINED
+ * @brief Attribute of a label whose definition was seen, even on a line with errors.
+ */
+#define LABEL_DEFINED (1 << 2)
 
 /**
  * @struct label
  * @brief Represents a single label in the label table.
  *
- * Contains information about the label's address, name, type, and the next label in the list.
+ * Contains the segment and offset of the label, its name, its attributes, and the next label
+ * in the list and in the list of entry or external labels.
  */
 typedef struct label {
-    int address;        /**< Address associated with the label. */
-    char *name;         /**< Name of the label. */
-    int is_data;        /**< Flag indicating if the label is a data label. */
-    int is_extern;      /**< Flag indicating if the label is an external label. */
-    int is_entry;       /**< Flag indicating if the label is an entry label. */
-    struct label *next; /**< Pointer to the next label in the list. */
+    label_segment segment;     /**< Segment the label is defined in. */
+    int offset;                /**< Offset of the label within its segment. */
+    char *name;                /**< Name of the label. */
+    int attributes;            /**< The LABEL_ENTRY, LABEL_EXTERN and LABEL_DEFINED bits of the label. */
+    int extern_id;             /**< Number of an external label, in declaration order, once the first pass is done. */
+    struct label *next;        /**< Pointer to the next label in the list. */
+    struct label *next_listed; /**< Pointer to the next label in the list of entry or external labels. */
 } label;
 
+/**
+ * @def LABEL_INDEX_INIT_SIZE
+ * @brief Initial number of slots in the hash index of a label table (a power of two).
+ */
+#define LABEL_INDEX_INIT_SIZE 64
+
 /**
  * @struct label_table
  * @brief Represents a table of labels.
  *
- * Contains a pointer to the head of the label list.
+ * Labels are kept in a linked list in definition order, with a tail pointer for appending.
+ * An open-addressing hash index (linear probing) over the same labels is used for lookups by name.
+ * The entry labels and the external labels are also linked in their own lists, in the same order,
+ * and counted, so the outputs never scan every label.
+ * The labels and their names are allocated from the arena of the file.
  */
 typedef struct {
-    label *head; /**< Pointer to the first label in the table. */
+    label *head;              /**< Pointer to the first label in the table. */
+    label *tail;              /**< Pointer to the last label in the table. */
+    label *entry_head;        /**< Pointer to the first entry label. */
+    label *entry_tail;        /**< Pointer to the last entry label. */
+    label *extern_head;       /**< Pointer to the first external label. */
+    label *extern_tail;       /**< Pointer to the last external label. */
+    label **index;            /**< Hash index of the labels, or NULL if nothing was added yet. */
+    int size;                 /**< Number of slots in the hash index. */
+    int count;                /**< Number of labels in the table. */
+    int entry_count;          /**< Number of entry labels. */
+    int extern_count;         /**< Number of external labels. */
+    int bases[SEGMENT_COUNT]; /**< Address of each segment, once the first pass is done. */
+    arena *mem;               /**< Arena owning the labels and their names. */
+    file_stats *stats;        /**< Statistics of the file, or NULL if none are gathered. */
 } label_table;
 
 /**
  * @brief Initializes the label table by setting the head to NULL.
  *
+ * The hash index is allocated lazily when the first label is added.
+ *
  * @param tb Pointer to the label_table to be emptied.
+ * @param mem Pointer to the arena the labels are allocated from.
  */
-void initLabelTable(label_table *tb);
+void initLabelTable(label_table *tb, arena *mem);
 
 /**
  * @brief Retrieves the tail of the label table.
@@ -61,8 +124,9 @@ label *getLabelTail(label_table *tb);
  *
  * @param tb Pointer to the label_table.
  * @param ptr Pointer to the label to be added.
+ * @return EXIT_SUCCESS if the label was added, EXIT_FAILURE if the hash index could not be grown.
  */
-void addToLabelTable(label_table *tb, label *ptr);
+int addToLabelTable(label_table *tb, label *ptr);
 
 /**
  * @brief Deletes a label from the label table.
@@ -73,15 +137,38 @@ void addToLabelTable(label_table *tb, label *ptr);
 void delLabelFromTable(label_table *tb, label *lb);
 
 /**
- * @brief Increases the address of data labels by a specified number.
+ * @brief Adds attributes to a label, keeping the counters and the entry and extern lists of the table.
  *
  * @param tb Pointer to the label_table.
- * @param num Number by which to increase the addresses.
+ * @param lb Pointer to the label.
+ * @param attributes The LABEL_ENTRY, LABEL_EXTERN and LABEL_DEFINED bits to add.
  */
-void increaseDataLabelTableAddress(label_table *tb, int num);
+void setLabelAttributes(label_table *tb, label *lb, int attributes);
 
 /**
- * @brief Frees all memory allocated for the label table.
+ * @brief Sets the addresses of the segments, once the sizes of the instructions are known.
+ *
+ * The external labels are numbered at the same time, in the order they were declared.
+ *
+ * @param tb Pointer to the label_table.
+ * @param code_base Address of the first instruction word.
+ * @param data_base Address of the first data word.
+ */
+void setSegmentBases(label_table *tb, int code_base, int data_base);
+
+/**
+ * @brief Returns the address of a label, from its segment and offset.
+ *
+ * @param tb Pointer to the label_table, whose segment addresses are set.
+ * @param lb Pointer to the label.
+ * @return The address of the label, or 0 if it is external or not defined.
+ */
+int labelAddress(const label_table *tb, const label *lb);
+
+/**
+ * @brief Frees the memory of the label table that is not owned by its arena.
+ *
+ * The labels themselves are released together with the arena.
  *
  * @param tb Pointer to the label_table to be freed.
  */
@@ -94,7 +181,7 @@ void freeLabelTable(label_table *tb);
  * @param name Name of the label to find.
  * @return Pointer to the label if found, or NULL if not found.
  */
-label *find_label(label_table *tb, char *name);
+label *find_label(label_table *tb, text_span name);
 
 /**
  * @brief Checks if a label name is legal according to various criteria.
@@ -107,22 +194,23 @@ label *find_label(label_table *tb, char *name);
  * @param name Name of the label to check.
  * @return 1 if the name is legal, 0 otherwise.
  */
-int isLegalLabelName(label_table *label_tb, macr_table *macr_tb, char *name);
+int isLegalLabelName(label_table *label_tb, macr_table *macr_tb, text_span name);
 
 /**
  * @brief Parses and adds a label to the label table if valid.
  *
- * This function checks if the label already exists as an entry label. If it does, it increments
- * the entry count. If the label is not legal, it returns failure. Otherwise, it allocates memory
- * for a new label, initializes its fields, and adds it to the label table.
+ * This function checks if the label already exists as an entry label whose definition was not
+ * seen yet. If it does, the definition belongs to that label. If the label is not legal, it
+ * returns failure. Otherwise, it allocates memory for a new label from the arena of the table,
+ * initializes its fields, and adds it to the label table.
  *
  * @param label_tb Pointer to the label_table where the label will be added.
  * @param macr_tb Pointer to the macro_table used for checking label legality.
- * @param str Name of the label to parse.
- * @param fp File pointer for error handling and cleanup.
- * @return EXIT_SUCCESS if the label was successfully parsed and added, EXIT_FAILURE otherwise.
+ * @param str Name of the label to parse, as a span of the source line.
+ * @return EXIT_SUCCESS if the label was successfully parsed and added, EXIT_FAILURE if it is not legal,
+ *         or EXIT_ABORT if memory allocation failed.
  */
-int parseLabel(label_table *label_tb, macr_table *macr_tb, char *str, FILE *fp);
+int parseLabel(label_table *label_tb, macr_table *macr_tb, text_span str);
 
 /**
  * @brief Checks if there are any labels with the entry flag set.
@@ -130,14 +218,6 @@ int parseLabel(label_table *label_tb, macr_table *macr_tb, char *str, FILE *fp);
  * @param label_tb Pointer to the label_table.
  * @return 1 if there is at least one entry label, 0 otherwise.
  */
-int has_entry_label(label_table *label_tb);
-
-/**
- * @brief Checks if there are any labels with the extern flag set.
- *
- * @param label_tb Pointer to the label_table.
- * @return 1 if there is at least one extern label, 0 otherwise.
- */
-int has_extern_label(label_table *label_tb);
+int has_entry_label(const label_table *label_tb);
 
 #endif /* LABEL_H */
@@ -0,0 +1,122 @@
+/**
+ * @author Tal Figenblat
+ * @date October 17, 2026
+ *
+ * @file libassembler.h
+ * @brief Public interface for embedding the assembler in another program.
+ *
+ * A program creates a context once and assembles any number of sources held in memory with it.
+ * Nothing is read from or written to the file system, nothing is printed, and the process never
+ * exits: the object words, entries, externals and diagnostics of each source are returned in
+ * memory. A context may be used by one thread at a time; separate contexts may be used in parallel.
+ *
+ * Build the library with "make libassembler", and link with "libassembler.a -pthread".
+ */
+
+#ifndef LIBASSEMBLER_H
+#define LIBASSEMBLER_H
+
+#include <stddef.h>
+
+/**
+ * @def ASM_LOAD_ADDRESS
+ * @brief Address of the first instruction word of every source.
+ */
+#define ASM_LOAD_ADDRESS 100
+
+/**
+ * @brief The context of the assembler, holding the memory reused across sources.
+ */
+typedef struct asm_context asm_context;
+
+/**
+ * @struct asm_symbol
+ * @brief Represents an entry label, or a use of an external label.
+ */
+typedef struct {
+    const char *name; /**< The name of the label. */
+    int address;      /**< The address of the entry label, or of the word using the external label. */
+} asm_symbol;
+
+/**
+ * @struct asm_diagnostic
+ * @brief Represents an error found in a source.
+ *
+ * Errors found during macro expansion refer to lines of the source; errors found afterwards refer
+ * to lines of the source after macro expansion.
+ */
+typedef struct {
+    int line;            /**< The line the error was found in. */
+    int code;            /**< The error code, stable across versions of the assembler. */
+    const char *message; /**< The message describing the error. */
+} asm_diagnostic;
+
+/**
+ * @struct asm_result
+ * @brief Holds the outcome of assembling a source.
+ *
+ * Everything is owned by the context, and stays valid until the next call that uses the context.
+ */
+typedef struct {
+    int status;                        /**< 0 if the source was assembled without errors, 1 otherwise. */
+    const unsigned short *words;       /**< The instruction words followed by the data words. */
+    int ic;                            /**< Number of instruction words. */
+    int dc;                            /**< Number of data words. */
+    const asm_symbol *entries;         /**< The entry labels, in definition order. */
+    int entry_count;                   /**< Number of entry labels. */
+    const asm_symbol *externals;       /**< The uses of external labels, in the order of the words using them. */
+    int extern_count;                  /**< Number of uses of external labels. */
+    const asm_diagnostic *diagnostics; /**< The errors found in the source, in order. */
+    int diagnostic_count;              /**< Number of errors. */
+    const char *messages;              /**< The messages the command line would print, null-terminated. */
+    size_t messages_len;               /**< Length of the messages, in bytes. */
+    const char *object;                /**< The content of the ".ob" file if it was asked for, or "". */
+    size_t object_len;                 /**< Length of the content of the ".ob" file, in bytes. */
+} asm_result;
+
+/**
+ * @brief Creates a context of the assembler.
+ *
+ * @return The context, or NULL if memory allocation failed.
+ */
+asm_context *asm_context_create(void);
+
+/**
+ * @brief Selects whether the content of the ".ob" file is returned with each result.
+ *
+ * The words, entries and externals are always returned; the text of the ".ob" file is only
+ * formatted when it is asked for, which it is not by default.
+ *
+ * @param ctx The context.
+ * @param keep Nonzero to return the content of the ".ob" file, 0 not to.
+ */
+void asm_context_keep_object_text(asm_context *ctx, int keep);
+
+/**
+ * @brief Assembles a source held in memory.
+ *
+ * @param ctx The context.
+ * @param src The source, which does not have to be null-terminated.
+ * @param len Length of the source, in bytes.
+ * @param result Pointer to the result to fill, which is filled even when errors were found.
+ * @return 0 if the source was assembled without errors, 1 otherwise.
+ */
+int assemble_buffer(asm_context *ctx, const char *src, size_t len, asm_result *result);
+
+/**
+ * @brief Releases the memory the context kept from earlier sources, keeping the context usable.
+ *
+ * Results obtained earlier from the context become invalid.
+ *
+ * @param ctx The context.
+ */
+void asm_context_reset(asm_context *ctx);
+
+/**
+ * @brief Destroys a context of the assembler.
+ *
+ * @param ctx The context, or NULL.
+ */
+void asm_context_destroy(asm_context *ctx);
+
+#endif /* LIBASSEMBLER_H */
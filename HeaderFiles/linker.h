@@ -0,0 +1,115 @@
+/**
+ * @author Tal Figenblat
+ * @date October 17, 2026
+ *
+ * @file linker.h
+ * @brief Header file for linking several assembled objects into a single memory image.
+ *
+ * The objects are laid out in command-line order: the instruction words of all of them first,
+ * then their data words, so each object is relocated past the ones before it. The entry labels
+ * of every object are collected into one global hash-indexed export table, and each use of an
+ * external label is patched with the address it is exported at. Loading the objects and
+ * relocating them run in parallel, one object at a time per worker thread; the messages of each
+ * object are printed in command-line order, as the assembler does with "-j".
+ */
+
+#ifndef LINKER_H
+#define LINKER_H
+
+#include <pthread.h>
+#include "object_file.h"
+#include "log_utils.h"
+
+/**
+ * @def EXPORT_INDEX_INIT_SIZE
+ * @brief Smallest number of slots in the hash index of the export table (a power of two).
+ */
+#define EXPORT_INDEX_INIT_SIZE 64
+
+/**
+ * @struct link_object
+ * @brief Represents an object being linked.
+ */
+typedef struct {
+    const char *name;  /**< The name of the object (without extension). */
+    object_view view;  /**< The object file. */
+    text_buffer buf;   /**< The object file, when it was read from the text files. */
+    long code_base;    /**< Address of the first instruction word of the object in the image. */
+    long data_base;    /**< Address of the first data word of the object in the image. */
+    file_log log;      /**< The messages of the object. */
+    int failed;        /**< Whether errors were found in the object. */
+} link_object;
+
+/**
+ * @struct linker
+ * @brief Holds the objects, the export table and the image being linked.
+ */
+typedef struct {
+    link_object *objects;    /**< The objects, in link order. */
+    int object_count;        /**< Number of objects. */
+    int jobs;                /**< Largest number of worker threads. */
+    long limit;              /**< Largest number of words of the image. */
+    object_symbol *exports;  /**< The entry labels of all the objects, with their addresses in the image. */
+    int *export_objects;     /**< Index of the object exporting each entry label. */
+    long export_count;       /**< Number of entry labels. */
+    long *index;             /**< Hash index of the entry labels, holding their index plus one, or 0 if empty. */
+    long index_size;         /**< Number of slots in the hash index. */
+    unsigned short *words;   /**< The image: the instruction words followed by the data words. */
+    long ic;                 /**< Number of instruction words of the image. */
+    long dc;                 /**< Number of data words of the image. */
+    int next;                /**< Index of the next object for the worker threads. */
+    pthread_mutex_t lock;    /**< Protects `next`. */
+} linker;
+
+/**
+ * @brief Initializes a linker for a list of objects.
+ *
+ * @param lk Pointer to the linker.
+ * @param names The names of the objects (without extension), in link order.
+ * @param count Number of objects.
+ * @param jobs Largest number of worker threads.
+ * @param limit Largest number of words of the image.
+ * @return EXIT_SUCCESS if the linker was initialized, EXIT_FAILURE if memory allocation failed.
+ */
+int initLinker(linker *lk, char **names, int count, int jobs, long limit);
+
+/**
+ * @brief Links the objects into one image, printing the errors found in each object.
+ *
+ * Duplicate entry labels, uses of undefined external labels, invalid objects, images too
+ * large for the memory and addresses too large for a word are reported.
+ *
+ * @param lk Pointer to the linker.
+ * @return EXIT_SUCCESS if the image was linked, EXIT_FAILURE if errors were found.
+ */
+int linkObjects(linker *lk);
+
+/**
+ * @brief Looks up an entry label in the export table.
+ *
+ * @param lk Pointer to the linker.
+ * @param name The name of the label.
+ * @return The index of the label in the export table, or -1 if no object exports it.
+ */
+long findExport(const linker *lk, const char *name);
+
+/**
+ * @brief Writes the linked image, with the entry labels of all the objects.
+ *
+ * The text files are NAME.ob, and NAME.ent if an object has entry labels; the binary file is NAME.obj.
+ *
+ * @param lk Pointer to the linker.
+ * @param name The name of the image (without extension).
+ * @param format The formats the image is written in.
+ * @return EXIT_SUCCESS if the files were written, EXIT_FAILURE otherwise.
+ */
+int writeLinkedImage(const linker *lk, const char *name, object_format format);
+
+/**
+ * @brief Frees the memory of a linker, closing its objects.
+ *
+ * @param lk Pointer to the linker.
+ */
+void freeLinker(linker *lk);
+
+#endif /* LINKER_H */
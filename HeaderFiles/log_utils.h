@@ -0,0 +1,216 @@
+/**
+ * @author Tal Figenblat
+ * @date October 17, 2026
+ *
+ * @file log_utils.h
+ * @brief Header file for the per-file log of the assembler.
+ *
+ * Every message the assembler prints while processing a file goes through this module.
+ * By default messages are printed right away. A worker thread may instead attach a file
+ * log, which collects the messages of the file it is processing until they are flushed,
+ * so that the logs of files processed in parallel are printed in command-line order.
+ * A file log keeps the text of each stream apart, along with the order the messages of
+ * both streams were printed in, so flushing it interleaves them as they were printed.
+ */
+
+#ifndef LOG_UTILS_H
+#define LOG_UTILS_H
+
+#include <stdarg.h>
+#include "buffer_utils.h"
+
+/**
+ * @def LOG_LINE_SIZE
+ * @brief Size of the buffer used to format a message, beyond which the message is formatted on the heap.
+ */
+#define LOG_LINE_SIZE 256
+
+/**
+ * @def LOG_DIAGNOSTICS_INIT_SIZE
+ * @brief Initial capacity of the diagnostics of a file log.
+ */
+#define LOG_DIAGNOSTICS_INIT_SIZE 16
+
+/**
+ * @def LOG_RECORDS_INIT_SIZE
+ * @brief Initial capacity of the records of a file log.
+ */
+#define LOG_RECORDS_INIT_SIZE 16
+
+/**
+ * @enum log_stream
+ * @brief Identifies the stream a message of a file log is printed to.
+ */
+typedef enum {
+    LOG_STREAM_OUT, /**< The log output, the standard output unless another stream was selected. */
+    LOG_STREAM_ERR  /**< The standard error. */
+} log_stream;
+
+/**
+ * @struct log_record
+ * @brief Represents consecutive messages printed to the same stream.
+ *
+ * The text of the record is the next `len` bytes of the buffer of its stream.
+ */
+typedef struct {
+    log_stream stream; /**< The stream the messages are printed to. */
+    size_t len;        /**< Length of the messages, in bytes. */
+} log_record;
+
+/**
+ * @struct log_diagnostic
+ * @brief Represents an error reported on a line of a source.
+ */
+typedef struct {
+    int line; /**< The line the error was found in. */
+    int code; /**< The error, as an `Error` code. */
+} log_diagnostic;
+
+/**
+ * @struct file_log
+ * @brief Holds the messages printed while processing a single file.
+ */
+typedef struct {
+    text_buffer out;             /**< Messages destined for the standard output. */
+    text_buffer err;             /**< Messages destined for the standard error. */
+    log_record *records;         /**< The messages of both streams, in the order they were printed. */
+    int record_count;            /**< Number of records. */
+    int record_size;             /**< Capacity of the records array. */
+    int failed;                  /**< Whether a message was lost because memory allocation failed. */
+    int keep_diagnostics;        /**< Whether the errors are also kept as diagnostics. */
+    log_diagnostic *diagnostics; /**< The errors reported on lines, in order, if they are kept. */
+    int diagnostic_count;        /**< Number of diagnostics. */
+    int diagnostic_size;         /**< Capacity of the diagnostics array. */
+} file_log;
+
+/**
+ * @brief Selects the stream messages are printed to when no file log is attached.
+ *
+ * Used when the standard output carries the outputs of the assembler instead of its messages.
+ *
+ * @param fp The stream, or NULL for the standard output.
+ */
+void setLogOutput(FILE *fp);
+
+/**
+ * @brief Enables attaching file logs to threads.
+ *
+ * Must be called before any thread attaches a file log. Safe to call from several threads at
+ * once: the key is created by the first call only.
+ *
+ * @return EXIT_SUCCESS if file logs can be attached, EXIT_FAILURE otherwise.
+ */
+int initThreadLogs(void);
+
+/**
+ * @brief Attaches a file log to the calling thread.
+ *
+ * @param log Pointer to the file log, or NULL to print the messages of the thread right away.
+ */
+void setThreadLog(file_log *log);
+
+/**
+ * @brief Returns the file log attached to the calling thread.
+ *
+ * @return Pointer to the file log, or NULL if the messages are printed right away.
+ */
+file_log *getThreadLog(void);
+
+/**
+ * @brief Appends a formatted message to a file log, after the messages of both streams.
+ *
+ * The message is formatted on the stack when it is short enough, and on the heap otherwise.
+ * Both argument lists must hold the same arguments, since the second one is only read when
+ * the message does not fit on the stack.
+ *
+ * @param log Pointer to the file log.
+ * @param stream The stream the message is printed to.
+ * @param format The format string.
+ * @param ap1 The arguments of the message.
+ * @param ap2 The same arguments, for formatting on the heap.
+ */
+void appendLogMessage(file_log *log, log_stream stream, const char *format, va_list ap1, va_list ap2);
+
+/**
+ * @brief Appends text to a file log, after the messages of both streams.
+ *
+ * @param log Pointer to the file log.
+ * @param stream The stream the text is printed to.
+ * @param text The text.
+ * @param len Length of the text, in bytes.
+ */
+void appendLogText(file_log *log, log_stream stream, const char *text, size_t len);
+
+/**
+ * @brief Prints a formatted message to the log output, or to the file log of the calling thread.
+ *
+ * The log output is the standard output, unless another stream was selected with `setLogOutput`.
+ *
+ * @param format The format string, as for `printf`.
+ */
+void logPrintf(const char *format, ...);
+
+/**
+ * @brief Prints a formatted message to the standard error, or to the file log of the calling thread.
+ *
+ * @param format The format string, as for `printf`.
+ */
+void logErrorf(const char *format, ...);
+
+/**
+ * @brief Keeps an error reported on a line of a source as a diagnostic of the log of the calling thread.
+ *
+ * Nothing is kept unless the file log of the thread keeps diagnostics.
+ *
+ * @param line The line the error was found in.
+ * @param code The error, as an `Error` code.
+ */
+void logDiagnostic(int line, int code);
+
+/**
+ * @brief Initializes an empty file log.
+ *
+ * @param log Pointer to the file log.
+ */
+void initFileLog(file_log *log);
+
+/**
+ * @brief Empties a file log, keeping its memory.
+ *
+ * @param log Pointer to the file log.
+ */
+void clearFileLog(file_log *log);
+
+/**
+ * @brief Prints the messages collected in a file log to their streams, in the order they were printed.
+ *
+ * @param log Pointer to the file log.
+ */
+void flushFileLog(const file_log *log);
+
+/**
+ * @brief Appends the messages of both streams of a file log to a buffer, in the order they were printed.
+ *
+ * @param log Pointer to the file log.
+ * @param dest Pointer to the buffer.
+ * @return EXIT_SUCCESS if the messages were appended, EXIT_FAILURE if memory allocation failed.
+ */
+int mergeFileLog(const file_log *log, text_buffer *dest);
+
+/**
+ * @brief Passes the messages collected in a file log on to the log of the calling thread.
+ *
+ * When the calling thread has no file log, the messages are printed right away.
+ *
+ * @param log Pointer to the file log.
+ */
+void logFileLog(const file_log *log);
+
+/**
+ * @brief Frees the memory of a file log.
+ *
+ * @param log Pointer to the file log.
+ */
+void freeFileLog(file_log *log);
+
+#endif /* LOG_UTILS_H */
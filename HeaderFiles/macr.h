@@ -13,6 +13,11 @@
 #define MACR_H
 
 #include "stdio.h"
+#include "arena.h"
+#include "buffer_utils.h"
+#include "source_reader.h"
+#include "token_utils.h"
+#include "stats.h"
 
 /**
  * @brief Checks if a given name is a legal macro name.
@@ -23,7 +28,7 @@
  * @param name The name to be checked.
  * @return 1 if the name is legal, 0 otherwise.
  */
-int isLegalName(char *name);
+int isLegalName(text_span name);
 
 /**
  * @brief Structure to represent a macro.
@@ -34,24 +39,46 @@ int isLegalName(char *name);
 typedef struct macr {
     char *name;        /**< The name of the macro */
     char *info;        /**< The information associated with the macro */
+    size_t len;        /**< Length of the information, in bytes */
     struct macr *next; /**< Pointer to the next macro in the list */
 } macr;
 
+/**
+ * @def MACR_INDEX_INIT_SIZE
+ * @brief Initial number of slots in the hash index of a macro table (a power of two).
+ */
+#define MACR_INDEX_INIT_SIZE 32
+
 /**
  * @brief Structure to represent a macro table.
  *
- * This structure holds a linked list of macros, with a pointer to the head of the list.
+ * This structure holds a linked list of macros in definition order, with pointers to the head
+ * and the tail of the list, and an open-addressing hash index (linear probing) for lookups by name.
+ * The macros, their names and their bodies are allocated from the arena of the file.
+ * A table may have a parent, a frozen macro library shared by every file, which is consulted
+ * when a name is not found in the table itself.
  */
-typedef struct {
-    macr *head; /**< Pointer to the head of the macro list */
+typedef struct macr_table {
+    macr *head;   /**< Pointer to the head of the macro list */
+    macr *tail;   /**< Pointer to the tail of the macro list */
+    macr **index; /**< Hash index of the macros, or NULL if nothing was added yet */
+    int size;     /**< Number of slots in the hash index */
+    int count;    /**< Number of macros in the table */
+    arena *mem;   /**< Arena owning the macros, their names and their bodies */
+    text_buffer body; /**< Scratch buffer reused to capture the body of each macro */
+    const struct macr_table *parent; /**< Frozen macro library consulted after this table, or NULL */
+    file_stats *stats; /**< Statistics of the file, or NULL if none are gathered */
 } macr_table;
 
 /**
  * @brief Initializes a macro table by setting its head to NULL.
  *
+ * The hash index is allocated lazily when the first macro is added.
+ *
  * @param tb Pointer to the macro table to be initialized.
+ * @param mem Pointer to the arena the macros are allocated from.
  */
-void initMacrTable(macr_table *tb);
+void initMacrTable(macr_table *tb, arena *mem);
 
 /**
  * @brief Gets the tail macro from a macro table.
@@ -66,24 +93,38 @@ macr *getMacrTail(macr_table *tb);
  *
  * @param tb Pointer to the macro table.
  * @param ptr Pointer to the macro to be added.
+ * @return EXIT_SUCCESS if the macro was added, EXIT_FAILURE if the hash index could not be grown.
  */
-void addToMacrTable(macr_table *tb, macr *ptr);
+int addToMacrTable(macr_table *tb, macr *ptr);
 
 /**
- * @brief Frees all macros in the macro table and releases associated memory.
+ * @brief Frees the memory of the macro table that is not owned by its arena.
+ *
+ * The macros themselves are released together with the arena.
  *
  * @param tb Pointer to the macro table to be freed.
  */
 void freeMacrTable(macr_table *tb);
 
 /**
- * @brief Finds a macro by name in the macro table.
+ * @brief Checks cheaply whether a token could be the name of a macro at all.
+ *
+ * Tokens that cannot be legal macro names, such as labels ending with ':', directives,
+ * opcodes and other reserved words, are rejected without touching the macro table.
+ *
+ * @param name The token to be checked.
+ * @return 1 if the token may name a macro, 0 otherwise.
+ */
+int isMacrCandidate(text_span name);
+
+/**
+ * @brief Finds a macro by name in the macro table, then in its macro library.
  *
  * @param tb Pointer to the macro table.
  * @param name The name of the macro to find.
  * @return Pointer to the macro if found, or NULL if not found.
  */
-macr *find_macr(macr_table *tb, char *name);
+macr *find_macr(const macr_table *tb, text_span name);
 
 /**
  * @brief Checks if a macro name is legal.
@@ -95,7 +136,7 @@ macr *find_macr(macr_table *tb, char *name);
  * @param name The name to be checked.
  * @return 1 if the name is legal, 0 otherwise.
  */
-int isLegalMacrName(macr_table *tb, char *name);
+int isLegalMacrName(const macr_table *tb, text_span name);
 
 /**
  * @brief Duplicates a string by allocating memory and copying the content.
@@ -105,19 +146,51 @@ int isLegalMacrName(macr_table *tb, char *name);
  */
 char *my_strdup(const char *s);
 
+/**
+ * @brief Computes the hash value of a name for the symbol table indexes.
+ *
+ * Uses the FNV-1a hash, which is cheap to compute and spreads short identifiers well.
+ *
+ * @param name The name to be hashed.
+ * @return The hash value of the name.
+ */
+unsigned long hash_name(const char *name);
+
+/**
+ * @brief Computes the hash value of a token, like `hash_name`, without copying it.
+ *
+ * @param name The token to be hashed.
+ * @return The hash value of the token.
+ */
+unsigned long hash_span(text_span name);
+
 /**
  * @brief Saves macro information from a file into the macro table.
  *
- * Reads macro definitions from the provided file pointers and saves them into the macro table.
- * Handles memory allocation failures and checks for syntax errors.
+ * Reads the lines following the definition from the source text and saves them into the macro table.
+ * Handles memory allocation failures and checks for syntax errors. The body is captured in
+ * linear time and stored with its length, so expanding it is a single copy of known length.
  *
  * @param tb Pointer to the macro table.
- * @param name The name of the macro to save.
+ * @param name The name of the macro to save, as a span of the definition line.
  * @param line_counter Counter for the current line in the file.
- * @param fp1 File pointer to read macro definitions from.
- * @param fp2 Additional file pointer for error handling.
- * @return The updated line counter if successful, or EXIT_FAILURE if an error occurs.
+ * @param src Pointer to the source text to read macro definitions from.
+ * @param pos Pointer to the index of the current line, advanced past the end of the macro.
+ * @return The updated line counter if successful, EXIT_FAILURE if a syntax error occurs,
+ *         or EXIT_ABORT if memory allocation failed.
+ */
+int save_macr(macr_table *tb, text_span name, int line_counter, source_text *src, int *pos);
+
+/**
+ * @brief Loads a macro library into a macro table, which is then frozen and shared by every file.
+ *
+ * A macro library holds only macro definitions, empty lines and comments. Its macro names follow
+ * the rules of `isLegalMacrName`, so a library cannot define the same macro twice.
+ *
+ * @param tb Pointer to an empty macro table receiving the macros.
+ * @param path The path of the macro library.
+ * @return EXIT_SUCCESS if the library was loaded, EXIT_FAILURE otherwise.
  */
-int save_macr(macr_table *tb, char *name, int line_counter, FILE *fp1, FILE *fp2);
+int loadMacroLibrary(macr_table *tb, const char *path);
 
 #endif /* MACR_H */
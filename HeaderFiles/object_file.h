@@ -0,0 +1,186 @@
+/**
+ * @author Tal Figenblat
+ * @date October 17, 2026
+ *
+ * @file object_file.h
+ * @brief Header file for the binary object file, a compact form of the ".ob", ".ent" and ".ext" files.
+ *
+ * The ".obj" file holds the memory image and the symbols of a source in fixed-size fields, so a
+ * loader can map it and read any word or symbol in place, without parsing text. Every number is
+ * little-endian, and every table starts at a multiple of 4 bytes:
+ *
+ *     header   8 x 32 bits: "ASOB", version, load address, IC, DC, entries, externals, names size
+ *     words    IC + DC x 16 bits: the instruction words followed by the data words, padded to 4 bytes
+ *     entries  entries x (32-bit name offset, 32-bit address), in the order of the ".ent" file
+ *     externs  externals x (32-bit name offset, 32-bit address), in the order of the ".ext" file
+ *     names    names size bytes: the null-terminated names, at the offsets given in the tables
+ */
+
+#ifndef OBJECT_FILE_H
+#define OBJECT_FILE_H
+
+#include <stddef.h>
+#include "output_writer.h"
+#include "buffer_utils.h"
+
+/**
+ * @def OBJECT_MAGIC
+ * @brief The first 4 bytes of every object file.
+ */
+#define OBJECT_MAGIC "ASOB"
+
+/**
+ * @def OBJECT_VERSION
+ * @brief Version of the layout of the object file.
+ */
+#define OBJECT_VERSION 1
+
+/**
+ * @def OBJECT_HEADER_SIZE
+ * @brief Size of the header of an object file, in bytes.
+ */
+#define OBJECT_HEADER_SIZE 32
+
+/**
+ * @def OBJECT_SYMBOL_SIZE
+ * @brief Size of each record of the entry and external tables, in bytes.
+ */
+#define OBJECT_SYMBOL_SIZE 8
+
+/**
+ * @def OBJECT_LOAD_ADDRESS
+ * @brief Address of the first instruction word.
+ */
+#define OBJECT_LOAD_ADDRESS 100
+
+/**
+ * @enum object_format
+ * @brief The formats the object image of a source is written in.
+ */
+typedef enum {
+    OBJECT_NONE = 0,   /**< No file: the image and the labels are only kept in memory. */
+    OBJECT_TEXT = 1,   /**< The ".ob", ".ent" and ".ext" text files. */
+    OBJECT_BINARY = 2, /**< The ".obj" binary file. */
+    OBJECT_BOTH = 3    /**< Both the text files and the binary file. */
+} object_format;
+
+/**
+ * @struct object_symbol
+ * @brief Represents an entry label, or a use of an external label, with its address.
+ */
+typedef struct {
+    const char *name; /**< Name of the label. */
+    long address;     /**< Address of the label, or of the word using the external label. */
+} object_symbol;
+
+/**
+ * @struct object_view
+ * @brief Represents an object file in memory, checked but not copied.
+ */
+typedef struct {
+    const unsigned char *data; /**< The bytes of the file. */
+    size_t size;               /**< Number of bytes of the file. */
+    int mapped;                /**< Whether the bytes are mapped from a file, and unmapped when closing. */
+    long load_address;         /**< Address of the first instruction word. */
+    long ic;                   /**< Number of instruction words. */
+    long dc;                   /**< Number of data words. */
+    long entry_count;          /**< Number of entry labels. */
+    long extern_count;         /**< Number of uses of external labels. */
+    const unsigned char *words;   /**< The words, two bytes each. */
+    const unsigned char *entries; /**< The entry table. */
+    const unsigned char *externs; /**< The external table. */
+    const char *names;            /**< The names of the symbols. */
+    size_t names_size;            /**< Number of bytes of the names. */
+} object_view;
+
+/**
+ * @brief Writes the memory image and the symbols of a source as an object file.
+ *
+ * @param w Pointer to the writer of the object file.
+ * @param instructions The instruction words.
+ * @param IC Number of instruction words.
+ * @param data The data words.
+ * @param DC Number of data words.
+ * @param entries The entry labels.
+ * @param entry_count Number of entry labels.
+ * @param externs The uses of external labels.
+ * @param extern_count Number of uses of external labels.
+ */
+void writeObjectFile(output_writer *w, const unsigned short *instructions, int IC, const unsigned short *data, int DC,
+                     const object_symbol *entries, int entry_count, const object_symbol *externs, int extern_count);
+
+/**
+ * @brief Checks the bytes of an object file and prepares a view of them.
+ *
+ * @param view Pointer to the view.
+ * @param data The bytes of the file, which must stay valid while the view is used.
+ * @param size Number of bytes.
+ * @return EXIT_SUCCESS if the bytes hold a valid object file, EXIT_FAILURE otherwise.
+ */
+int openObjectView(object_view *view, const void *data, size_t size);
+
+/**
+ * @brief Maps an object file into memory and prepares a view of it.
+ *
+ * @param view Pointer to the view.
+ * @param path The path of the object file.
+ * @return EXIT_SUCCESS if the file was mapped and is valid, EXIT_FAILURE otherwise.
+ */
+int mapObjectFile(object_view *view, const char *path);
+
+/**
+ * @brief Releases a view, unmapping its file if it was mapped.
+ *
+ * @param view Pointer to the view.
+ */
+void closeObjectView(object_view *view);
+
+/**
+ * @brief Returns a word of the memory image.
+ *
+ * @param view Pointer to the view.
+ * @param i Index of the word, instruction words first.
+ * @return The word.
+ */
+unsigned short getObjectWord(const object_view *view, long i);
+
+/**
+ * @brief Returns an entry label.
+ *
+ * @param view Pointer to the view.
+ * @param i Index of the entry label.
+ * @return The entry label, whose name points into the view.
+ */
+object_symbol getObjectEntry(const object_view *view, long i);
+
+/**
+ * @brief Returns a use of an external label.
+ *
+ * @param view Pointer to the view.
+ * @param i Index of the use.
+ * @return The use, whose name points into the view.
+ */
+object_symbol getObjectExtern(const object_view *view, long i);
+
+/**
+ * @brief Reads the text ".ob", ".ent" and ".ext" files of a source into an object file in memory.
+ *
+ * The ".ent" and ".ext" files are read if they exist.
+ *
+ * @param name The name of the object (without extension).
+ * @param dest Pointer to the buffer receiving the bytes of the object file.
+ * @return EXIT_SUCCESS if the files were read, EXIT_FAILURE otherwise.
+ */
+int readTextObject(const char *name, text_buffer *dest);
+
+/**
+ * @brief Prepares a view of the object of a source, from its ".obj" file if it exists, or from its text files.
+ *
+ * @param view Pointer to the view.
+ * @param buf Pointer to an empty buffer holding the object file when it is read from the text files.
+ * @param name The name of the object (without extension).
+ * @return EXIT_SUCCESS if the object was read and is valid, EXIT_FAILURE otherwise.
+ */
+int loadObjectFile(object_view *view, text_buffer *buf, const char *name);
+
+#endif /* OBJECT_FILE_H */
@@ -12,8 +12,12 @@
 #ifndef OPCODE_UTILS_H
 #define OPCODE_UTILS_H
 
+#include <stdio.h>
 #include "label.h"
 #include "macr.h"
+#include "fixup.h"
+#include "output_writer.h"
+#include "extern_refs.h"
 
 /**
  * @def CLEAR_MSB
@@ -21,6 +25,12 @@
  */
 #define CLEAR_MSB 0x7FFF
 
+/**
+ * @def MAX_WORD_ADDRESS
+ * @brief Largest address the 12-bit address field of a word can hold.
+ */
+#define MAX_WORD_ADDRESS (CLEAR_MSB >> 3)
+
 /**
  * @brief Determines the addressing method based on the given string.
  *
@@ -33,7 +43,7 @@
  * @param line_counter The line number of the instruction.
  * @return Addressing method type (0-3) or -1 if not recognized.
  */
-int which_address_method(label_table *label_tb, macr_table *macr_tb, char *str, int line_counter);
+int which_address_method(label_table *label_tb, macr_table *macr_tb, text_span str, int line_counter);
 
 /**
  * @brief Encodes the first word of an instruction with the given opcode and operands.
@@ -49,19 +59,50 @@ int which_address_method(label_table *label_tb, macr_table *macr_tb, char *str,
 void encode_first_word(unsigned short *ptr, opcode op, int opr1, int opr2);
 
 /**
- * @brief Parses an opcode instruction and encodes the corresponding words.
+ * @brief Encodes an extra word based on the operand information.
+ *
+ * Immediate and register operands are encoded completely. Words of direct addressing
+ * operands are left empty and patched by `encode_label_word` once the label is known.
+ *
+ * @param ptr Pointer to the word to encode.
+ * @param opr1 The operand's addressing method.
+ * @param opr2 The other operand's addressing method, or -1 if the operand is the last one.
+ * @param str1 The string representation of the operand.
+ */
+void encode_extra_word(unsigned short *ptr, int opr1, int opr2, text_span str1);
+
+/**
+ * @brief Encodes the extra words of an instruction and records its label references.
  *
- * This function parses the given opcode string and its operands, determining
- * the addressing methods and encoding the instruction accordingly.
+ * Every direct addressing operand is added to the fixup table with the index of its word,
+ * so its address can be filled in after the first pass.
  *
- * @param ptr Pointer to the string containing the opcode.
- * @param iptr Pointer to the pointer to the instruction word.
- * @param idx The index to use for encoding.
+ * @param iptr Pointer to the first extra word of the instruction.
+ * @param idx The index of the first extra word in the instruction memory.
+ * @param opr1 The first operand's addressing method, or -1 if there is no operand.
+ * @param opr2 The second operand's addressing method, or -1 if there is no second operand.
+ * @param str1 The string representation of the first operand.
+ * @param str2 The string representation of the second operand.
  * @param line_counter The line number of the instruction.
- * @param label_tb Pointer to the label table.
- * @param fp Pointer to the output file for external label information.
- * @return EXIT_SUCCESS on successful parsing, EXIT_FAILURE on error.
+ * @param fixup_tb Pointer to the fixup table.
+ * @return EXIT_SUCCESS on success, EXIT_FAILURE if a fixup could not be recorded.
+ */
+int encode_operands(unsigned short *iptr, int idx, int opr1, int opr2, text_span str1, text_span str2,
+                    int line_counter, fixup_table *fixup_tb);
+
+/**
+ * @brief Encodes the address of a label into the extra word of a direct addressing operand.
+ *
+ * External labels are encoded with the "E" bit and their use is recorded in the table of
+ * external references; other labels are encoded with the "R" bit.
+ *
+ * @param ptr Pointer to the word to encode.
+ * @param idx The index of the word in the instruction memory.
+ * @param label_tb Pointer to the label table, whose segment addresses are set.
+ * @param lb Pointer to the referenced label.
+ * @param externs Pointer to the table of external references.
  */
-int parseOpcode(char *ptr, unsigned short **iptr, int idx, int line_counter, label_table *label_tb, FILE *fp);
+void encode_label_word(unsigned short *ptr, int idx, const label_table *label_tb, const label *lb,
+                       extern_table *externs);
 
 #endif /* OPCODE_UTILS_H */
@@ -0,0 +1,178 @@
+/**
+ * @author Tal Figenblat
+ * @date October 17, 2026
+ *
+ * @file options.h
+ * @brief Header file for the command-line options of the assembler.
+ *
+ * Options start with '-' and may appear anywhere among the file names;
+ * they apply to every file given on the command line.
+ */
+
+#ifndef OPTIONS_H
+#define OPTIONS_H
+
+#include "output_writer.h"
+#include "stats.h"
+#include "object_file.h"
+#include "extern_refs.h"
+
+/**
+ * @def MAX_JOBS
+ * @brief Maximum number of files assembled in parallel.
+ */
+#define MAX_JOBS 256
+
+/**
+ * @def ASSEMBLER_VERSION
+ * @brief Version of the assembler, part of the key of every build cache entry.
+ *
+ * Change it whenever the output for a given source changes, so older cache entries are not reused.
+ */
+#define ASSEMBLER_VERSION "1.3.0"
+
+/**
+ * @def DEFAULT_CACHE_SIZE_MB
+ * @brief Size the build cache is trimmed to when no size is given, in megabytes.
+ */
+#define DEFAULT_CACHE_SIZE_MB 64
+
+/**
+ * @def MAX_CACHE_SIZE_MB
+ * @brief Maximum size of the build cache, in megabytes, so the size in bytes fits in 32 bits.
+ */
+#define MAX_CACHE_SIZE_MB 4095
+
+/**
+ * @def STDIN_ARGUMENT
+ * @brief The file name standing for the standard input, which selects the pipe mode.
+ */
+#define STDIN_ARGUMENT "-"
+
+/**
+ * @def MAX_OUTPUT_FD
+ * @brief Largest file descriptor accepted for the outputs of the pipe mode.
+ */
+#define MAX_OUTPUT_FD 65535
+
+/* The macro table is declared in macr.h; options only point to the frozen macro library */
+struct macr_table;
+
+/**
+ * @struct assembler_options
+ * @brief Holds the settings selected on the command line, and the files to assemble.
+ */
+typedef struct {
+    int emit_am;                        /**< Whether the expanded source is written to the ".am" file. */
+    int jobs;                           /**< Number of files assembled in parallel. */
+    int arena_stats;                    /**< Whether the memory used by each file is reported. */
+    int large_memory;                   /**< Whether programs may exceed the memory of the target. */
+    object_format object_format;        /**< The formats the object image is written in. */
+    int relocations;                    /**< Whether the relocation table is written. */
+    extern_order ext_order;             /**< The order the uses of external labels are written in. */
+    char *cache_dir;                    /**< Directory of the build cache, or NULL to always assemble. */
+    int cache_size;                     /**< Size the build cache is trimmed to, in megabytes. */
+    char *macro_lib_path;               /**< Path of the macro library, or NULL if none is used. */
+    const struct macr_table *macro_lib; /**< The loaded macro library, shared by every file. */
+    int output_fds[OUTPUT_KIND_COUNT];  /**< Descriptor receiving each output in pipe mode, or -1. */
+    char *serve_path;                   /**< Socket the server listens on, or NULL to assemble files. */
+    stats_format stats;                 /**< How the statistics of the files are reported, if at all. */
+    char *stats_path;                   /**< File the statistics are written to, or NULL for the standard error. */
+    file_stats *stats_list;             /**< The statistics of each file, in command-line order, or NULL. */
+    char **files;                       /**< The names of the files to assemble, in command-line order. */
+    int file_count;                     /**< Number of files to assemble. */
+} assembler_options;
+
+/**
+ * @brief Initializes the options with their default values.
+ *
+ * @param opts Pointer to the options.
+ */
+void initOptions(assembler_options *opts);
+
+/**
+ * @brief Checks whether a command-line argument is an option.
+ *
+ * A lone "-" is not an option, but the file name standing for the standard input.
+ *
+ * @param arg The command-line argument.
+ * @return 1 if the argument is an option, 0 if it is a file name.
+ */
+int isOption(const char *arg);
+
+/**
+ * @brief Finds the output selected by an option such as "--ob-fd".
+ *
+ * @param arg The command-line argument.
+ * @return The kind of the output, or -1 if the argument does not select an output descriptor.
+ */
+int getOutputFdOption(const char *arg);
+
+/**
+ * @brief Parses the number of parallel jobs given to the "-j" option.
+ *
+ * @param str The number of jobs.
+ * @param jobs Pointer to the variable receiving the number of jobs.
+ * @return EXIT_SUCCESS if the number is valid, EXIT_FAILURE otherwise.
+ */
+int parseJobs(const char *str, int *jobs);
+
+/**
+ * @brief Parses a positive decimal number given to an option.
+ *
+ * @param str The number.
+ * @param max The largest accepted value.
+ * @param value Pointer to the variable receiving the number.
+ * @return EXIT_SUCCESS if the number is valid, EXIT_FAILURE otherwise.
+ */
+int parsePositive(const char *str, int max, int *value);
+
+/**
+ * @brief Parses the command-line arguments into options and file names.
+ *
+ * Recognized options:
+ * - "--emit-am": write the expanded source to the ".am" file (the default).
+ * - "--no-emit-am": keep the expanded source in memory only.
+ * - "-j N" or "-jN": assemble up to N files in parallel (the default is 1).
+ * - "--arena-stats": report the memory used by the arena of each file.
+ * - "--large": let programs take up to LARGE_MEMORY_SIZE words instead of MEMORY_SIZE.
+ * - "--object-format text|binary|both": write the ".ob", ".ent" and ".ext" files, the ".obj" file, or all.
+ * - "--relocations": also write the ".rel" file, listing the words holding internal addresses.
+ * - "--ext-order source|grouped|sorted": write the uses of external labels in source order, grouped
+ *   by label in declaration order, or grouped by label sorted by name.
+ * - "--cache-dir DIR": restore the outputs of unchanged files from the build cache in DIR.
+ * - "--cache-size MB": trim the build cache to MB megabytes (DEFAULT_CACHE_SIZE_MB by default).
+ * - "--macro-lib FILE": load the macros of FILE once, for every file.
+ * - "--am-fd N", "--ob-fd N" and the other "--<kind>-fd N": in pipe mode, write that output
+ *   to descriptor N instead of the framed stream of the standard output.
+ * - "--serve PATH": assemble the sources sent to the UNIX socket PATH, without file names.
+ * - "--stats": report the timings and counters of each file as text.
+ * - "--stats-json": report the timings and counters of each file as JSON.
+ * - "--stats-file FILE": write the statistics to FILE instead of the standard error.
+ *
+ * The file name "-" (STDIN_ARGUMENT) reads the source from the standard input and selects the
+ * pipe mode; it must then be the only file. Errors are reported to the standard error.
+ *
+ * @param opts Pointer to the options.
+ * @param argc The number of command-line arguments.
+ * @param argv The array of command-line arguments.
+ * @return EXIT_SUCCESS if all the arguments were parsed, EXIT_FAILURE otherwise.
+ */
+int parseOptions(assembler_options *opts, int argc, char *argv[]);
+
+/**
+ * @brief Frees the memory of the options.
+ *
+ * @param opts Pointer to the options.
+ */
+void freeOptions(assembler_options *opts);
+
+/**
+ * @brief Checks whether the options select the pipe mode.
+ *
+ * @param opts Pointer to the options.
+ * @return 1 if the source is read from the standard input, 0 otherwise.
+ */
+int isPipeMode(const assembler_options *opts);
+
+#endif /* OPTIONS_H */
@@ -0,0 +1,244 @@
+/**
+ * @author Tal Figenblat
+ * @date October 17, 2026
+ *
+ * @file output_writer.h
+ * @brief Header file for the buffered writer of the output files.
+ *
+ * The writer formats addresses and memory words with lookup tables directly into a large
+ * buffer, and hands the buffer to the operating system with a few `write` calls, instead
+ * of going through `fprintf` several times per memory word. A writer may also collect the
+ * file in memory, so the outputs of a source can be handed back without touching the file system.
+ */
+
+#ifndef OUTPUT_WRITER_H
+#define OUTPUT_WRITER_H
+
+#include <stddef.h>
+#include "buffer_utils.h"
+
+/**
+ * @def OUTPUT_BUFFER_SIZE
+ * @brief Size of the buffer of an output writer, in bytes.
+ */
+#define OUTPUT_BUFFER_SIZE 65536
+
+/**
+ * @def MAX_FORMATTED_SIZE
+ * @brief Maximum number of bytes written by formatting a single number.
+ */
+#define MAX_FORMATTED_SIZE 24
+
+/**
+ * @enum output_kind
+ * @brief The output files produced for a source.
+ */
+typedef enum {
+    OUTPUT_AM,        /**< The source after macro expansion. */
+    OUTPUT_OB,        /**< The object image. */
+    OUTPUT_ENT,       /**< The entry labels. */
+    OUTPUT_EXT,       /**< The uses of external labels. */
+    OUTPUT_OBJ,       /**< The binary object file, holding the image and the labels of the three above. */
+    OUTPUT_REL,       /**< The addresses of the words holding internal addresses. */
+    OUTPUT_KIND_COUNT /**< Number of output files. */
+} output_kind;
+
+/**
+ * @brief Suffixes of the output files, indexed by their kind.
+ */
+extern const char *output_suffixes[OUTPUT_KIND_COUNT];
+
+/**
+ * @struct output_symbol
+ * @brief Represents an entry label, or a use of an external label, kept in a set of outputs.
+ */
+typedef struct {
+    size_t name; /**< Offset of the name of the label in the names of the set. */
+    int address; /**< The address of the entry label, or of the word using the external label. */
+} output_symbol;
+
+/**
+ * @struct output_set
+ * @brief Holds the output files of a source in memory.
+ *
+ * When asked to, the set also keeps the entry labels and the uses of external labels as they are
+ * in memory, so they can be handed back without formatting and parsing the text files.
+ */
+typedef struct {
+    text_buffer files[OUTPUT_KIND_COUNT]; /**< The content of each output file. */
+    int present[OUTPUT_KIND_COUNT];       /**< Whether each output file was produced. */
+    unsigned short *words;                /**< The instruction words followed by the data words, or NULL. */
+    int ic;                               /**< Number of instruction words. */
+    int dc;                               /**< Number of data words. */
+    int keep_symbols;                     /**< Whether the entry labels and the uses of external labels are kept. */
+    output_symbol *symbols;               /**< The entry labels, followed by the uses of external labels. */
+    int symbol_size;                      /**< Capacity of the symbols array. */
+    int entry_count;                      /**< Number of entry labels. */
+    int extern_count;                     /**< Number of uses of external labels. */
+    text_buffer names;                    /**< The names of the symbols, each null-terminated. */
+} output_set;
+
+/**
+ * @struct output_writer
+ * @brief Represents an output file being written through a buffer.
+ */
+typedef struct {
+    int fd;            /**< Descriptor of the file, or -1 if it is not open. */
+    text_buffer *dest; /**< Buffer collecting the file in memory instead, or NULL. */
+    char *name;        /**< Name of the file, for error reporting. */
+    char *buf;         /**< The buffered bytes. */
+    size_t len;        /**< Number of buffered bytes. */
+    int failed;        /**< Whether writing to the file failed. */
+} output_writer;
+
+/**
+ * @brief Initializes an empty set of output files.
+ *
+ * @param outputs Pointer to the set.
+ */
+void initOutputSet(output_set *outputs);
+
+/**
+ * @brief Empties a set of output files, keeping its memory for reuse.
+ *
+ * @param outputs Pointer to the set.
+ */
+void clearOutputSet(output_set *outputs);
+
+/**
+ * @brief Keeps a copy of the memory image of a source in a set of output files.
+ *
+ * @param outputs Pointer to the set.
+ * @param instructions The instruction words.
+ * @param IC Number of instruction words.
+ * @param data The data words.
+ * @param DC Number of data words.
+ * @return EXIT_SUCCESS if the image was copied, EXIT_FAILURE if memory allocation failed.
+ */
+int setOutputImage(output_set *outputs, const unsigned short *instructions, int IC, const unsigned short *data, int DC);
+
+/**
+ * @brief Makes room for a number of symbols in a set of output files.
+ *
+ * @param outputs Pointer to the set.
+ * @param count The number of symbols needed.
+ * @return EXIT_SUCCESS if the symbols array is large enough, EXIT_FAILURE if memory allocation failed.
+ */
+int reserveOutputSymbols(output_set *outputs, int count);
+
+/**
+ * @brief Keeps a copy of the name of a label in a set of output files.
+ *
+ * @param outputs Pointer to the set.
+ * @param name The name of the label.
+ * @param offset Pointer to the variable receiving the offset of the copy in the names of the set.
+ * @return EXIT_SUCCESS if the name was copied, EXIT_FAILURE if memory allocation failed.
+ */
+int addOutputName(output_set *outputs, const char *name, size_t *offset);
+
+/**
+ * @brief Frees the memory of a set of output files, leaving it empty.
+ *
+ * @param outputs Pointer to the set.
+ */
+void freeOutputSet(output_set *outputs);
+
+/**
+ * @brief Marks a writer as not open, so closing it before it is opened fails harmlessly.
+ *
+ * @param w Pointer to the writer.
+ */
+void initOutputWriter(output_writer *w);
+
+/**
+ * @brief Creates or truncates an output file and prepares a writer for it.
+ *
+ * Errors are reported to the log of the file.
+ *
+ * @param w Pointer to the writer.
+ * @param file_name The name of the file (without extension).
+ * @param suffix The suffix of the file.
+ * @return EXIT_SUCCESS if the file was opened, EXIT_FAILURE otherwise.
+ */
+int openOutputWriter(output_writer *w, const char *file_name, const char *suffix);
+
+/**
+ * @brief Prepares a writer that collects an output file in memory.
+ *
+ * @param w Pointer to the writer.
+ * @param dest Pointer to the buffer receiving the file, which is emptied first.
+ * @return EXIT_SUCCESS if the writer is ready, EXIT_FAILURE if memory allocation failed.
+ */
+int openMemoryWriter(output_writer *w, text_buffer *dest);
+
+/**
+ * @brief Prepares a writer for an output file of a source, in memory or on the file system.
+ *
+ * @param w Pointer to the writer.
+ * @param file_name The name of the source (without extension).
+ * @param kind The output file.
+ * @param outputs Pointer to the set collecting the outputs in memory, or NULL to create the file.
+ * @return EXIT_SUCCESS if the writer is ready, EXIT_FAILURE otherwise.
+ */
+int openOutputKind(output_writer *w, const char *file_name, output_kind kind, output_set *outputs);
+
+/**
+ * @brief Writes the buffered bytes to the file.
+ *
+ * @param w Pointer to the writer.
+ */
+void flushOutputWriter(output_writer *w);
+
+/**
+ * @brief Writes bytes of known length.
+ *
+ * @param w Pointer to the writer.
+ * @param str The bytes to write.
+ * @param len Number of bytes.
+ */
+void writeBytes(output_writer *w, const char *str, size_t len);
+
+/**
+ * @brief Writes a single character.
+ *
+ * @param w Pointer to the writer.
+ * @param c The character to write.
+ */
+void writeChar(output_writer *w, char c);
+
+/**
+ * @brief Writes a non-negative number in decimal.
+ *
+ * @param w Pointer to the writer.
+ * @param num The number to write.
+ */
+void writeDecimal(output_writer *w, unsigned long num);
+
+/**
+ * @brief Writes an address in decimal, optionally preceded by a padding "0".
+ *
+ * @param w Pointer to the writer.
+ * @param address The address to write.
+ * @param pad Whether to precede the address with "0".
+ */
+void writeAddress(output_writer *w, int address, int pad);
+
+/**
+ * @brief Writes a memory word as five octal digits followed by a newline, like "%05o\n".
+ *
+ * @param w Pointer to the writer.
+ * @param word The memory word to write.
+ */
+void writeOctalWord(output_writer *w, unsigned short word);
+
+/**
+ * @brief Flushes the buffered bytes and closes the file.
+ *
+ * Errors are reported to the log of the file.
+ *
+ * @param w Pointer to the writer.
+ * @return EXIT_SUCCESS if the whole file was written, EXIT_FAILURE otherwise.
+ */
+int closeOutputWriter(output_writer *w);
+
+#endif /* OUTPUT_WRITER_H */
@@ -0,0 +1,91 @@
+/**
+ * @author Tal Figenblat
+ * @date October 17, 2026
+ *
+ * @file pipe_mode.h
+ * @brief Header file for assembling a source read from the standard input.
+ *
+ * With the file name "-", the source is read from the standard input and no file is read or
+ * written. By default the outputs are written to the standard output as one framed stream:
+ *
+ *     ASMSTREAM1 <result>
+ *     log <length>
+ *     <the messages of the source>
+ *     ob <length>
+ *     <the object image>
+ *     ...
+ *     end
+ *
+ * Each frame holds exactly <length> bytes after its header line; outputs that were not produced
+ * have no frame. When the errors are kept as diagnostics, a "diag" frame follows the messages,
+ * with a line "<line> <code> <message>" per error. With options such as "--ob-fd N", each
+ * selected output is instead written as is to the given file descriptor, and the messages are
+ * printed as usual.
+ */
+
+#ifndef PIPE_MODE_H
+#define PIPE_MODE_H
+
+#include "options.h"
+#include "output_writer.h"
+#include "log_utils.h"
+
+/**
+ * @def STDIN_SOURCE_NAME
+ * @brief Name of the source read from the standard input, as it appears in messages.
+ */
+#define STDIN_SOURCE_NAME "stdin"
+
+/**
+ * @def STREAM_MAGIC
+ * @brief First word of the framed stream.
+ */
+#define STREAM_MAGIC "ASMSTREAM1"
+
+/**
+ * @brief Checks whether the outputs are written to file descriptors rather than as a framed stream.
+ *
+ * @param opts Pointer to the command-line options.
+ * @return 1 if at least one output descriptor was given, 0 otherwise.
+ */
+int hasOutputFds(const assembler_options *opts);
+
+/**
+ * @brief Writes a frame of the framed stream.
+ *
+ * @param fp The stream.
+ * @param name The name of the frame.
+ * @param buf Pointer to the content of the frame.
+ * @return EXIT_SUCCESS if the frame was written, EXIT_FAILURE otherwise.
+ */
+int writeStreamFrame(FILE *fp, const char *name, const text_buffer *buf);
+
+/**
+ * @brief Writes the outcome of assembling a source as a framed stream.
+ *
+ * @param fp The stream.
+ * @param result The value returned by the preprocessor.
+ * @param log Pointer to the log of the source.
+ * @param outputs Pointer to the outputs of the source.
+ * @return EXIT_SUCCESS if the whole stream was written, EXIT_FAILURE otherwise.
+ */
+int writeOutputStream(FILE *fp, int result, const file_log *log, const output_set *outputs);
+
+/**
+ * @brief Writes the whole content of a buffer to a file descriptor.
+ *
+ * @param fd The file descriptor.
+ * @param buf Pointer to the buffer.
+ * @return EXIT_SUCCESS if every byte was written, EXIT_FAILURE otherwise.
+ */
+int writeToFd(int fd, const text_buffer *buf);
+
+/**
+ * @brief Assembles the source read from the standard input, without touching the file system.
+ *
+ * @param opts Pointer to the command-line options.
+ * @return int Returns 1 if errors were found, otherwise returns 0.
+ */
+int assemblePipe(const assembler_options *opts);
+
+#endif /* PIPE_MODE_H */
@@ -14,6 +14,8 @@
 #define PREPROCESSOR_H
 
 #include <stdio.h>
+#include "options.h"
+#include "output_writer.h"
 
 /**
  * @def MAX_LINE_SIZE
@@ -30,13 +32,31 @@
 /**
  * @brief Preprocesses an assembly source file, expanding macros.
  *
- * This function reads an assembly file, expands macros, and writes the
- * result to an output file. It also performs error checking and reports
+ * This function reads an assembly file, expands macros into memory, and
+ * passes the result to the first pass, writing it to an output file unless
+ * the options disable it. It also performs error checking and reports
  * any issues found during preprocessing.
  *
  * @param file_name The name of the source file (without extension) to be preprocessed.
+ * @param opts Pointer to the command-line options.
  * @return int Returns EXIT_SUCCESS if preprocessing is successful, or EXIT_FAILURE if an error occurs.
  */
-int preprocessor(char *file_name);
+int preprocessor(char *file_name, const assembler_options *opts);
+
+/**
+ * @brief Preprocesses an assembly source given in memory or in a file, expanding macros.
+ *
+ * Like `preprocessor`, but the source may be given in memory, and the output files may be
+ * collected in memory instead of being written, so no file is read or written.
+ *
+ * @param file_name The name of the source (without extension), used in messages and output files.
+ * @param opts Pointer to the command-line options.
+ * @param source The source, or NULL to read it from the ".as" file.
+ * @param source_len Length of the source given in memory, in bytes.
+ * @param outputs Pointer to an empty set collecting the output files, or NULL to write them.
+ * @return int Returns EXIT_SUCCESS if preprocessing is successful, or EXIT_FAILURE if an error occurs.
+ */
+int preprocessSource(char *file_name, const assembler_options *opts, const char *source, size_t source_len,
+                     output_set *outputs);
 
 #endif /* PREPROCESSOR_H */
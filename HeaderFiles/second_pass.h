@@ -6,29 +6,40 @@
  * @brief Header file for the second pass of the assembler process.
  *
  * This header file contains the declaration of the second_pass function, which is
- * responsible for processing an assembly file after macro expansion. It resolves labels,
- * encodes instructions and data, and generates the final output files.
+ * responsible for finishing an assembly file after the first pass. It resolves labels
+ * and generates the final output files.
  */
 
 #ifndef SECOND_PASS_H
 #define SECOND_PASS_H
 
 #include "label.h"
+#include "fixup.h"
+#include "output_writer.h"
+#include "options.h"
 
 /**
  * @brief Performs the second pass on an assembly source file.
  *
- * This function processes an assembly file that has been preprocessed to expand macros.
- * During the second pass, it resolves labels, encodes instructions and data, and generates
- * the final output files (.ob for object code, .ent for entry points, and .ext for external references).
+ * During the second pass, the label references recorded as fixups by the first pass are resolved
+ * in a single sweep, without reading the source again. The addresses of labels are patched into
+ * the instruction words, entry labels are checked, and the final output files are generated
+ * (.ob for object code, .ent for entry points, and .ext for external references, or the binary
+ * .obj file holding all three, and the .rel relocation table if selected), either on the file
+ * system or in memory.
  *
  * @param file_name The name of the source file (without extension) to be processed.
  * @param label_tb A pointer to the label table used for label resolution.
- * @param instructions An array of unsigned short where the instructions will be stored.
- * @param data An array of unsigned short where the data will be stored.
+ * @param fixup_tb A pointer to the fixup table recorded during the first pass.
+ * @param instructions An array of unsigned short holding the encoded instructions.
+ * @param data An array of unsigned short holding the encoded data.
+ * @param IC The instruction counter, indicating the number of instruction words.
  * @param DC The data counter, indicating the amount of data in the file.
+ * @param opts Pointer to the options, selecting the output files.
+ * @param outputs Pointer to the set collecting the output files in memory, or NULL to write them.
  * @return int Returns EXIT_SUCCESS if the second pass is successful, or EXIT_FAILURE if an error occurs.
  */
-int second_pass(char *file_name, label_table *label_tb, unsigned short *instructions, unsigned short *data, int DC);
+int second_pass(char *file_name, label_table *label_tb, fixup_table *fixup_tb, unsigned short *instructions,
+                unsigned short *data, int IC, int DC, const assembler_options *opts, output_set *outputs);
 
 #endif /* SECOND_PASS_H */
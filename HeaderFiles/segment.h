@@ -0,0 +1,62 @@
+/**
+ * @author Tal Figenblat
+ * @date October 17, 2026
+ *
+ * @file segment.h
+ * @brief Header file for the memory segments holding the encoded instructions and data of a file.
+ *
+ * A segment is a growable array of words on the heap, limited to the memory of the target.
+ * It grows geometrically as the first pass encodes the lines, so small files take little
+ * memory and large ones take no stack at all.
+ */
+
+#ifndef SEGMENT_H
+#define SEGMENT_H
+
+/**
+ * @def SEGMENT_INIT_SIZE
+ * @brief Initial capacity of a segment, in words.
+ */
+#define SEGMENT_INIT_SIZE 256
+
+/**
+ * @def LARGE_MEMORY_SIZE
+ * @brief Limit of each segment, in words, when the "--large" option is given.
+ */
+#define LARGE_MEMORY_SIZE (1L << 24)
+
+/**
+ * @struct memory_segment
+ * @brief Represents the words of a segment, and how many it may hold.
+ */
+typedef struct {
+    unsigned short *words; /**< The words, all zero until they are encoded. */
+    int size;              /**< Capacity of the array. */
+    int limit;             /**< Largest capacity of the array. */
+} memory_segment;
+
+/**
+ * @brief Initializes an empty segment.
+ *
+ * @param seg Pointer to the segment.
+ * @param limit Largest number of words the segment may hold.
+ */
+void initSegment(memory_segment *seg, int limit);
+
+/**
+ * @brief Makes room for a number of words, or for the limit of the segment if it is smaller.
+ *
+ * @param seg Pointer to the segment.
+ * @param count Number of words the segment must hold.
+ * @return EXIT_SUCCESS if the segment holds the words, EXIT_FAILURE if memory allocation failed.
+ */
+int reserveSegment(memory_segment *seg, long count);
+
+/**
+ * @brief Frees the memory of a segment.
+ *
+ * @param seg Pointer to the segment.
+ */
+void freeSegment(memory_segment *seg);
+
+#endif /* SEGMENT_H */
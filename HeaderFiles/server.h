@@ -0,0 +1,135 @@
+/**
+ * @author Tal Figenblat
+ * @date October 17, 2026
+ *
+ * @file server.h
+ * @brief Header file for the persistent server mode of the assembler.
+ *
+ * With "--serve PATH", the assembler listens on a UNIX socket and assembles the sources it
+ * receives on a fixed pool of worker threads ("-j N", one by default), keeping the macro library
+ * and its tables loaded between requests. The main thread polls the open connections and hands
+ * each request, not each connection, to a worker, so an idle client never holds a worker.
+ * Each request is a header line followed by its source:
+ *
+ *     ASMREQ1 source <name> <length> [emit-am|no-emit-am|arena-stats|large|object-text|object-binary|
+ *                                     object-both|relocations|ext-source|ext-grouped|ext-sorted ...]
+ *     <length bytes of source>
+ *
+ *     ASMREQ1 path <name> 0 [options]     assembles the file "<name>.as" of the server
+ *     ASMREQ1 stop - 0                    stops the server
+ *
+ * Each request is answered with the framed stream of the pipe mode, including a "diag" frame
+ * with the errors found. A connection may send any number of requests, one after the other.
+ * All the memory of a request is released once it is answered.
+ *
+ * The server is meant for trusted local clients: the socket is only accessible to its owner, and
+ * "path" requests are limited to relative names without ".." under the working directory.
+ */
+
+#ifndef SERVER_H
+#define SERVER_H
+
+#include <stdio.h>
+#include <pthread.h>
+#include "options.h"
+
+/**
+ * @def REQUEST_MAGIC
+ * @brief First word of every request.
+ */
+#define REQUEST_MAGIC "ASMREQ1"
+
+/**
+ * @def REQUEST_LINE_SIZE
+ * @brief Maximum length of the header line of a request, including its newline.
+ */
+#define REQUEST_LINE_SIZE 512
+
+/**
+ * @def MAX_REQUEST_SOURCE
+ * @brief Maximum length of the source of a request, in bytes.
+ */
+#define MAX_REQUEST_SOURCE (64UL * 1024UL * 1024UL)
+
+/**
+ * @def SERVER_MAX_CONNECTIONS
+ * @brief Maximum number of connections open at once; further clients wait in the listen backlog.
+ */
+#define SERVER_MAX_CONNECTIONS 256
+
+/**
+ * @def SERVER_REQUEST_TIMEOUT
+ * @brief Seconds a client may stall in the middle of a request, or of its answer, before it is dropped.
+ */
+#define SERVER_REQUEST_TIMEOUT 10
+
+/**
+ * @struct server_connection
+ * @brief Represents an open connection of a client.
+ */
+typedef struct {
+    int fd;    /**< The socket of the connection. */
+    FILE *in;  /**< Unbuffered stream the requests are read from, so nothing waits unseen by the poller. */
+    FILE *out; /**< Stream the answers are written to. */
+} server_connection;
+
+/**
+ * @struct assembler_server
+ * @brief Holds the state shared by the polling thread and the worker threads of the server.
+ *
+ * Each open connection is in exactly one place: polled by the main thread while idle, waiting in
+ * the queue once a request arrives, with a worker while it is answered, then back in `returned`.
+ */
+typedef struct {
+    const assembler_options *opts;                       /**< The options of the server, shared by every request. */
+    int listen_fd;                                       /**< The listening socket. */
+    int wake_fds[2];                                     /**< Pipe the workers write to, to wake the polling thread. */
+    server_connection *queue[SERVER_MAX_CONNECTIONS];    /**< Connections with a request waiting for a worker, as a ring. */
+    int head;                                            /**< Index of the oldest waiting connection. */
+    int count;                                           /**< Number of waiting connections. */
+    server_connection *returned[SERVER_MAX_CONNECTIONS]; /**< Connections answered and idle again. */
+    int returned_count;                                  /**< Number of connections in `returned`. */
+    int closed_count;                                    /**< Connections closed by the workers, not yet counted by the polling thread. */
+    int stopping;                                        /**< Whether a stop request was received. */
+    pthread_mutex_t lock;                                /**< Protects the queue, the returned connections and `stopping`. */
+    pthread_cond_t changed;                              /**< Signaled whenever the queue or `stopping` changes. */
+} assembler_server;
+
+/**
+ * @brief Answers a single request read from a connection.
+ *
+ * @param server Pointer to the server.
+ * @param in The stream the request is read from.
+ * @param out The stream the answer is written to.
+ * @return EXIT_SUCCESS if another request may follow, EXIT_FAILURE if the connection must be closed.
+ */
+int handleRequest(assembler_server *server, FILE *in, FILE *out);
+
+/**
+ * @brief Answers the request waiting on a connection, then hands the connection back to the
+ * polling thread, or closes it if it ended.
+ *
+ * @param server Pointer to the server.
+ * @param conn The connection, with a request waiting.
+ */
+void answerConnection(assembler_server *server, server_connection *conn);
+
+/**
+ * @brief Answers requests of connections taken from the queue until the server stops.
+ *
+ * This is the body of each worker thread.
+ *
+ * @param arg Pointer to the server.
+ * @return NULL.
+ */
+void *runServerWorker(void *arg);
+
+/**
+ * @brief Runs the server on the socket given in the options, until a stop request is received.
+ *
+ * @param opts Pointer to the options.
+ * @return int Returns 1 if the server could not be started, otherwise returns 0.
+ */
+int runServer(const assembler_options *opts);
+
+#endif /* SERVER_H */
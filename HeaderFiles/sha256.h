@@ -0,0 +1,66 @@
+/**
+ * @author Tal Figenblat
+ * @date October 17, 2026
+ *
+ * @file sha256.h
+ * @brief Header file for computing SHA-256 digests.
+ *
+ * The build cache keys its entries on the SHA-256 digest of the source file, so that two
+ * different sources never share an entry in practice. The implementation only relies on
+ * `unsigned long` being at least 32 bits wide, as ANSI C guarantees.
+ */
+
+#ifndef SHA256_H
+#define SHA256_H
+
+#include <stddef.h>
+
+/**
+ * @def SHA256_DIGEST_SIZE
+ * @brief Size of a SHA-256 digest, in bytes.
+ */
+#define SHA256_DIGEST_SIZE 32
+
+/**
+ * @def SHA256_BLOCK_SIZE
+ * @brief Size of the blocks SHA-256 processes, in bytes.
+ */
+#define SHA256_BLOCK_SIZE 64
+
+/**
+ * @struct sha256_ctx
+ * @brief Represents a SHA-256 computation in progress.
+ */
+typedef struct {
+    unsigned long state[8];                      /**< The intermediate hash value. */
+    unsigned char block[SHA256_BLOCK_SIZE];      /**< Bytes waiting for a full block. */
+    size_t block_len;                            /**< Number of bytes in `block`. */
+    unsigned long bits_low;                      /**< Low 32 bits of the message length, in bits. */
+    unsigned long bits_high;                     /**< High 32 bits of the message length, in bits. */
+} sha256_ctx;
+
+/**
+ * @brief Starts a SHA-256 computation.
+ *
+ * @param ctx Pointer to the computation.
+ */
+void initSha256(sha256_ctx *ctx);
+
+/**
+ * @brief Adds bytes to a SHA-256 computation.
+ *
+ * @param ctx Pointer to the computation.
+ * @param data The bytes to add.
+ * @param len Number of bytes to add.
+ */
+void updateSha256(sha256_ctx *ctx, const void *data, size_t len);
+
+/**
+ * @brief Finishes a SHA-256 computation.
+ *
+ * @param ctx Pointer to the computation.
+ * @param digest Receives the digest.
+ */
+void finishSha256(sha256_ctx *ctx, unsigned char digest[SHA256_DIGEST_SIZE]);
+
+#endif /* SHA256_H */
@@ -0,0 +1,120 @@
+/**
+ * @author Tal Figenblat
+ * @date October 17, 2026
+ *
+ * @file source_reader.h
+ * @brief Header file for reading source text as an array of lines.
+ *
+ * A source file is read into memory with a single read, and the start of every line is
+ * recorded in an index built with `memchr`. Lines are then visited in place, without
+ * copying them: a line view temporarily null-terminates the line right after its newline
+ * character, so the tokenizer sees exactly the characters of the line.
+ */
+
+#ifndef SOURCE_READER_H
+#define SOURCE_READER_H
+
+#include <stddef.h>
+
+/**
+ * @def SOURCE_READ_INIT_SIZE
+ * @brief Initial buffer size for sources whose size is not known in advance, such as pipes.
+ */
+#define SOURCE_READ_INIT_SIZE 4096
+
+/**
+ * @struct source_text
+ * @brief Represents source text and the index of its lines.
+ */
+typedef struct {
+    char *data;       /**< The text, followed by a null terminator. */
+    size_t len;       /**< Length of the text, in bytes. */
+    size_t *starts;   /**< Offset of the start of each line, followed by the length of the text. */
+    int line_count;   /**< Number of lines in the text. */
+    int owns_data;    /**< Whether the text is freed together with the index. */
+    size_t size;      /**< Size of the block holding the text, when it is owned. */
+} source_text;
+
+/**
+ * @struct line_view
+ * @brief Represents a line visited in place, null-terminated for as long as the view is open.
+ */
+typedef struct {
+    char *text;  /**< The characters of the line, including its newline character. */
+    size_t len;  /**< Number of characters seen through the view. */
+    char saved;  /**< The character replaced by the null terminator. */
+} line_view;
+
+/**
+ * @brief Reads a whole file into memory and indexes its lines.
+ *
+ * Errors are reported to the log of the file.
+ *
+ * @param src Pointer to the source text to fill.
+ * @param file_name The name of the file (without extension).
+ * @param suffix The suffix of the file.
+ * @return EXIT_SUCCESS if the file was read, EXIT_FAILURE otherwise.
+ */
+int readSourceFile(source_text *src, const char *file_name, const char *suffix);
+
+/**
+ * @brief Indexes the lines of text that is already in memory.
+ *
+ * The text must be followed by a null terminator, and is not freed with the index.
+ *
+ * @param src Pointer to the source text to fill.
+ * @param data The text.
+ * @param len Length of the text, in bytes.
+ * @return EXIT_SUCCESS if the text was indexed, EXIT_FAILURE if memory allocation failed.
+ */
+int indexSourceText(source_text *src, char *data, size_t len);
+
+/**
+ * @brief Copies text given in memory and indexes its lines.
+ *
+ * The copy is owned by the source text, so the caller keeps its own text untouched.
+ *
+ * @param src Pointer to the source text to fill.
+ * @param text The text, which does not have to be null-terminated.
+ * @param len Length of the text, in bytes.
+ * @return EXIT_SUCCESS if the text was copied and indexed, EXIT_FAILURE if memory allocation failed.
+ */
+int copySourceText(source_text *src, const char *text, size_t len);
+
+/**
+ * @brief Returns the length of a line, without its newline character.
+ *
+ * @param src Pointer to the source text.
+ * @param i Index of the line.
+ * @return The number of characters in the line.
+ */
+size_t getLineLength(const source_text *src, int i);
+
+/**
+ * @brief Opens a view of a line, null-terminating it in place.
+ *
+ * @param src Pointer to the source text.
+ * @param i Index of the line.
+ * @param max_len Maximum number of characters seen through the view.
+ * @param view Pointer to the view to open.
+ * @return Pointer to the characters of the line.
+ */
+char *openLineView(source_text *src, int i, size_t max_len, line_view *view);
+
+/**
+ * @brief Closes a view of a line, restoring the character replaced by the null terminator.
+ *
+ * Closing a view that is already closed has no effect.
+ *
+ * @param view Pointer to the view to close.
+ */
+void closeLineView(line_view *view);
+
+/**
+ * @brief Frees the memory of a source text.
+ *
+ * @param src Pointer to the source text.
+ */
+void freeSourceText(source_text *src);
+
+#endif /* SOURCE_READER_H */
@@ -0,0 +1,155 @@
+/**
+ * @author Tal Figenblat
+ * @date October 17, 2026
+ *
+ * @file stats.h
+ * @brief Header file for the statistics gathered while assembling each file ("--stats").
+ *
+ * The statistics of a file are attached to the thread assembling it, like its log. The passes
+ * mark where each phase starts with `enterPhase`, and fill in the sizes they know at their end,
+ * which costs nothing when no statistics are attached. The counters of the hot paths, such as
+ * the lookups of labels and macros, go through `COUNT_STAT`, which is compiled only when
+ * ASSEMBLER_STATS is defined ("make stats"); otherwise it compiles to nothing, and the reports
+ * mark those counters as not counted.
+ *
+ * The allocators of a file (its arena, text buffers, segments, tables, source text and output
+ * buffers) charge what they allocate and free to the statistics of the thread, so the peak of
+ * the heap memory they hold is measured as it happens.
+ */
+
+#ifndef STATS_H
+#define STATS_H
+
+#include <stdio.h>
+#include <stddef.h>
+
+/**
+ * @enum phase_kind
+ * @brief The phases of assembling a source.
+ */
+typedef enum {
+    PHASE_IDLE,         /**< Outside of any phase; this time is not reported. */
+    PHASE_PREPROCESSOR, /**< Reading the source and expanding the macros. */
+    PHASE_FIRST_PASS,   /**< Encoding the instructions and data, and collecting the labels. */
+    PHASE_SECOND_PASS,  /**< Resolving the labels. */
+    PHASE_OUTPUT,       /**< Writing the output files. */
+    PHASE_COUNT         /**< Number of phases. */
+} phase_kind;
+
+/**
+ * @enum stats_format
+ * @brief How the statistics are reported.
+ */
+typedef enum {
+    STATS_OFF,  /**< No statistics are gathered. */
+    STATS_TEXT, /**< Human-readable report. */
+    STATS_JSON  /**< A single JSON object. */
+} stats_format;
+
+/**
+ * @struct file_stats
+ * @brief Holds the statistics of a file, or the sum of the statistics of several files.
+ */
+typedef struct {
+    double phase_times[PHASE_COUNT]; /**< Wall time spent in each phase, in seconds. */
+    double phase_start;              /**< When the current phase started, in seconds. */
+    phase_kind phase;                /**< The current phase. */
+    unsigned long lines;             /**< Lines read from the source. */
+    unsigned long macros_defined;    /**< Macros defined by the source. */
+    unsigned long macros_expanded;   /**< Macro calls expanded. */
+    unsigned long labels;            /**< Labels defined or declared by the source. */
+    unsigned long label_lookups;     /**< Calls to `find_label`. */
+    unsigned long label_probes;      /**< Slots visited in the hash index of the labels of the file. */
+    unsigned long macro_lookups;     /**< Calls to `find_macr`. */
+    unsigned long macro_probes;      /**< Slots visited in the hash index of the macros of the file. */
+    unsigned long bytes_read;        /**< Bytes of source read. */
+    unsigned long bytes_written;     /**< Bytes of output written. */
+    unsigned long heap_used;         /**< Heap memory the allocators of the file hold now, in bytes. */
+    unsigned long heap_peak;         /**< Largest heap memory the allocators of the file held at once, in bytes. */
+    int files;                       /**< Number of files summed into these statistics. */
+} file_stats;
+
+#ifdef ASSEMBLER_STATS
+#define COUNT_STAT(stats, field, n) do { if(stats) (stats)->field += (n); } while(0)
+#else
+#define COUNT_STAT(stats, field, n) ((void)0)
+#endif
+
+/**
+ * @brief Enables attaching statistics to threads.
+ *
+ * Safe to call from several threads at once: the key is created by the first call only.
+ *
+ * @return EXIT_SUCCESS if statistics can be attached, EXIT_FAILURE otherwise.
+ */
+int initThreadStats(void);
+
+/**
+ * @brief Attaches statistics to the calling thread, stopping the clock of the previous ones.
+ *
+ * @param stats Pointer to the statistics, or NULL to gather none.
+ */
+void setThreadStats(file_stats *stats);
+
+/**
+ * @brief Returns the statistics attached to the calling thread.
+ *
+ * @return Pointer to the statistics, or NULL if none are gathered.
+ */
+file_stats *getThreadStats(void);
+
+/**
+ * @brief Initializes empty statistics for a file.
+ *
+ * @param stats Pointer to the statistics.
+ */
+void initFileStats(file_stats *stats);
+
+/**
+ * @brief Charges the time since the previous phase started to it, and starts another phase.
+ *
+ * Does nothing if no statistics are attached to the calling thread.
+ *
+ * @param kind The phase that starts.
+ */
+void enterPhase(phase_kind kind);
+
+/**
+ * @brief Charges heap memory allocated for the file to the statistics of the calling thread.
+ *
+ * Does nothing if no statistics are attached to the calling thread.
+ *
+ * @param bytes Number of bytes allocated.
+ */
+void noteHeapAlloc(size_t bytes);
+
+/**
+ * @brief Releases heap memory charged to the statistics of the calling thread.
+ *
+ * Does nothing if no statistics are attached to the calling thread.
+ *
+ * @param bytes Number of bytes freed.
+ */
+void noteHeapFree(size_t bytes);
+
+/**
+ * @brief Adds the statistics of a file to a sum.
+ *
+ * @param total Pointer to the sum.
+ * @param stats Pointer to the statistics of the file.
+ */
+void addFileStats(file_stats *total, const file_stats *stats);
+
+/**
+ * @brief Writes the statistics of each file and their sum.
+ *
+ * @param fp The stream the report is written to.
+ * @param format The format of the report.
+ * @param names The name of each file.
+ * @param stats The statistics of each file.
+ * @param count Number of files.
+ * @return EXIT_SUCCESS if the report was written, EXIT_FAILURE otherwise.
+ */
+int writeStatsReport(FILE *fp, stats_format format, char **names, const file_stats *stats, int count);
+
+#endif /* STATS_H */
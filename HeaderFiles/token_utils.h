@@ -7,39 +7,67 @@
  *
  * This header file declares utility functions for extracting tokens from a string and
  * handling strings enclosed in double quotes. These functions assist in parsing and
- * processing assembly source files.
+ * processing assembly source files. Tokens are returned as spans of the source line,
+ * so they are never copied.
  */
 
 #ifndef TOKEN_UTILS_H
 #define TOKEN_UTILS_H
 
+#include <stddef.h>
+
+/**
+ * @struct text_span
+ * @brief Represents a token as a pointer into the source line and a length, without copying it.
+ */
+typedef struct {
+    const char *text;  /**< The first character of the token; the token is not null-terminated. */
+    size_t len;        /**< Number of characters in the token. */
+} text_span;
+
+/**
+ * @brief Makes a span covering a whole null-terminated string.
+ *
+ * @param str The string.
+ * @return The span of the string.
+ */
+text_span makeSpan(const char *str);
+
+/**
+ * @brief Compares a span with a null-terminated string.
+ *
+ * @param span The span to compare.
+ * @param str The string to compare with.
+ * @return 1 if the span holds exactly the characters of the string, 0 otherwise.
+ */
+int spanEquals(text_span span, const char *str);
+
 /**
- * @brief Extracts the next token from the input string.
+ * @brief Finds the next token of the input string without copying it.
  *
- * This function extracts the next token from the input string `*ptr`, delimited by the specified
- * delimiter character. It copies the token into the `dest` buffer and updates `*ptr` to point
- * to the next token or character in the input string.
+ * Skips whitespace and delimiters, then returns the following run of characters that are neither,
+ * as a span of the input.
  *
- * @param dest Pointer to the buffer where the extracted token will be stored.
+ * @param dest Pointer to the span receiving the token; its length is 0 if there is no token.
  * @param ptr Pointer to the current position in the input string.
  * @param delim The delimiter character used to separate tokens.
  * @return int The number of delimiters encountered before the token.
  */
-int nextToken(char *dest, char **ptr, const char delim);
+int nextSpan(text_span *dest, char **ptr, const char delim);
 
 /**
  * @brief Extracts a string enclosed in double quotes from the input string.
  *
- * This function extracts a string enclosed in double quotes from the input string `*ptr`.
- * It copies the string into the `dest` buffer and updates `*ptr` to point to the character
- * following the closing quote. If the string is not properly enclosed or contains invalid
- * characters, an error is reported.
+ * This function finds a string enclosed in double quotes in the input string `*ptr`.
+ * It sets `dest` to the characters between the quotes, without copying them, and updates `*ptr`
+ * to point to the character following the closing quote. If the string is not properly enclosed
+ * or contains invalid characters, an error is reported.
  *
- * @param dest Pointer to the buffer where the extracted string will be stored.
+ * @param dest Pointer to the span receiving the characters between the quotes.
  * @param ptr Pointer to the current position in the input string.
  * @param line_counter The line number in the source file, used for error reporting.
  * @return int Returns 0 if the string is extracted successfully, or 1 if an error occurs.
  */
-int nextString(char *dest, char **ptr, int line_counter);
+int nextString(text_span *dest, char **ptr, int line_counter);
 
 #endif /* TOKEN_UTILS_H */
@@ -0,0 +1,74 @@
+; file large_address.as
+
+; END lies past address 4095, which the address field of a word cannot hold
+
+MAIN:   jmp END
+        stop
+
+        .string "abcdefghijabcdefghijabcdefghijabcdefghijabcdefghijabcdefghij"
+        .string "abcdefghijabcdefghijabcdefghijabcdefghijabcdefghijabcdefghij"
+        .string "abcdefghijabcdefghijabcdefghijabcdefghijabcdefghijabcdefghij"
+        .string "abcdefghijabcdefghijabcdefghijabcdefghijabcdefghijabcdefghij"
+        .string "abcdefghijabcdefghijabcdefghijabcdefghijabcdefghijabcdefghij"
+        .string "abcdefghijabcdefghijabcdefghijabcdefghijabcdefghijabcdefghij"
+        .string "abcdefghijabcdefghijabcdefghijabcdefghijabcdefghijabcdefghij"
+        .string "abcdefghijabcdefghijabcdefghijabcdefghijabcdefghijabcdefghij"
+        .string "abcdefghijabcdefghijabcdefghijabcdefghijabcdefghijabcdefghij"
+        .string "abcdefghijabcdefghijabcdefghijabcdefghijabcdefghijabcdefghij"
+        .string "abcdefghijabcdefghijabcdefghijabcdefghijabcdefghijabcdefghij"
+        .string "abcdefghijabcdefghijabcdefghijabcdefghijabcdefghijabcdefghij"
+        .string "abcdefghijabcdefghijabcdefghijabcdefghijabcdefghijabcdefghij"
+        .string "abcdefghijabcdefghijabcdefghijabcdefghijabcdefghijabcdefghij"
+        .string "abcdefghijabcdefghijabcdefghijabcdefghijabcdefghijabcdefghij"
+        .string "abcdefghijabcdefghijabcdefghijabcdefghijabcdefghijabcdefghij"
+        .string "abcdefghijabcdefghijabcdefghijabcdefghijabcdefghijabcdefghij"
+        .string "abcdefghijabcdefghijabcdefghijabcdefghijabcdefghijabcdefghij"
+        .string "abcdefghijabcdefghijabcdefghijabcdefghijabcdefghijabcdefghij"
+        .string "abcdefghijabcdefghijabcdefghijabcdefghijabcdefghijabcdefghij"
+        .string "abcdefghijabcdefghijabcdefghijabcdefghijabcdefghijabcdefghij"
+        .string "abcdefghijabcdefghijabcdefghijabcdefghijabcdefghijabcdefghij"
+        .string "abcdefghijabcdefghijabcdefghijabcdefghijabcdefghijabcdefghij"
+        .string "abcdefghijabcdefghijabcdefghijabcdefghijabcdefghijabcdefghij"
+        .string "abcdefghijabcdefghijabcdefghijabcdefghijabcdefghijabcdefghij"
+        .string "abcdefghijabcdefghijabcdefghijabcdefghijabcdefghijabcdefghij"
+        .string "abcdefghijabcdefghijabcdefghijabcdefghijabcdefghijabcdefghij"
+        .string "abcdefghijabcdefghijabcdefghijabcdefghijabcdefghijabcdefghij"
+        .string "abcdefghijabcdefghijabcdefghijabcdefghijabcdefghijabcdefghij"
+        .string "abcdefghijabcdefghijabcdefghijabcdefghijabcdefghijabcdefghij"
+        .string "abcdefghijabcdefghijabcdefghijabcdefghijabcdefghijabcdefghij"
+        .string "abcdefghijabcdefghijabcdefghijabcdefghijabcdefghijabcdefghij"
+        .string "abcdefghijabcdefghijabcdefghijabcdefghijabcdefghijabcdefghij"
+        .string "abcdefghijabcdefghijabcdefghijabcdefghijabcdefghijabcdefghij"
+        .string "abcdefghijabcdefghijabcdefghijabcdefghijabcdefghijabcdefghij"
+        .string "abcdefghijabcdefghijabcdefghijabcdefghijabcdefghijabcdefghij"
+        .string "abcdefghijabcdefghijabcdefghijabcdefghijabcdefghijabcdefghij"
+        .string "abcdefghijabcdefghijabcdefghijabcdefghijabcdefghijabcdefghij"
+        .string "abcdefghijabcdefghijabcdefghijabcdefghijabcdefghijabcdefghij"
+        .string "abcdefghijabcdefghijabcdefghijabcdefghijabcdefghijabcdefghij"
+        .string "abcdefghijabcdefghijabcdefghijabcdefghijabcdefghijabcdefghij"
+        .string "abcdefghijabcdefghijabcdefghijabcdefghijabcdefghijabcdefghij"
+        .string "abcdefghijabcdefghijabcdefghijabcdefghijabcdefghijabcdefghij"
+        .string "abcdefghijabcdefghijabcdefghijabcdefghijabcdefghijabcdefghij"
+        .string "abcdefghijabcdefghijabcdefghijabcdefghijabcdefghijabcdefghij"
+        .string "abcdefghijabcdefghijabcdefghijabcdefghijabcdefghijabcdefghij"
+        .string "abcdefghijabcdefghijabcdefghijabcdefghijabcdefghijabcdefghij"
+        .string "abcdefghijabcdefghijabcdefghijabcdefghijabcdefghijabcdefghij"
+        .string "abcdefghijabcdefghijabcdefghijabcdefghijabcdefghijabcdefghij"
+        .string "abcdefghijabcdefghijabcdefghijabcdefghijabcdefghijabcdefghij"
+        .string "abcdefghijabcdefghijabcdefghijabcdefghijabcdefghijabcdefghij"
+        .string "abcdefghijabcdefghijabcdefghijabcdefghijabcdefghijabcdefghij"
+        .string "abcdefghijabcdefghijabcdefghijabcdefghijabcdefghijabcdefghij"
+        .string "abcdefghijabcdefghijabcdefghijabcdefghijabcdefghijabcdefghij"
+        .string "abcdefghijabcdefghijabcdefghijabcdefghijabcdefghijabcdefghij"
+        .string "abcdefghijabcdefghijabcdefghijabcdefghijabcdefghijabcdefghij"
+        .string "abcdefghijabcdefghijabcdefghijabcdefghijabcdefghijabcdefghij"
+        .string "abcdefghijabcdefghijabcdefghijabcdefghijabcdefghijabcdefghij"
+        .string "abcdefghijabcdefghijabcdefghijabcdefghijabcdefghijabcdefghij"
+        .string "abcdefghijabcdefghijabcdefghijabcdefghijabcdefghijabcdefghij"
+        .string "abcdefghijabcdefghijabcdefghijabcdefghijabcdefghijabcdefghij"
+        .string "abcdefghijabcdefghijabcdefghijabcdefghijabcdefghijabcdefghij"
+        .string "abcdefghijabcdefghijabcdefghijabcdefghijabcdefghijabcdefghij"
+        .string "abcdefghijabcdefghijabcdefghijabcdefghijabcdefghijabcdefghij"
+        .string "abcdefghijabcdefghijabcdefghijabcdefghijabcdefghijabcdefghij"
+        .string "abcdefghijabcdefghijabcdefghijabcdefghijabcdefghijabcdefghij"
+END:    .data 7
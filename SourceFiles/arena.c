@@ -0,0 +1,112 @@
+/**
+ * @author Tal Figenblat
+ * @date October 17, 2026
+ *
+ * @file arena.c
+ * @brief Contains functions for allocating memory from an arena and releasing it at once.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "arena.h"
+#include "stats.h"
+
+/* Rounds a size up to the alignment of arena memory */
+#define ARENA_ROUND(size) (((size) + sizeof(arena_align) - 1) / sizeof(arena_align) * sizeof(arena_align))
+
+/* Offset of the usable memory from the start of a block */
+#define ARENA_HEADER_SIZE ARENA_ROUND(sizeof(arena_block))
+
+/**
+ * @brief Initializes an empty arena.
+ *
+ * @param mem Pointer to the arena.
+ */
+void initArena(arena *mem) {
+    mem->head = NULL;
+    mem->bytes = 0;
+    mem->blocks = 0;
+}
+
+/**
+ * @brief Allocates memory from an arena.
+ *
+ * @param mem Pointer to the arena.
+ * @param size Number of bytes to allocate.
+ * @return Pointer to the memory, or NULL if memory allocation failed.
+ */
+void *arenaAlloc(arena *mem, size_t size) {
+    arena_block *blk = mem->head;
+    int is_large;
+
+    size = ARENA_ROUND(size ? size : 1);
+    is_large = size > ARENA_BLOCK_SIZE / 4;
+
+    /* Allocate a new block if the current one is full */
+    if(!blk || blk->used + size > blk->size) {
+        blk = (arena_block *)malloc(ARENA_HEADER_SIZE + (is_large ? size : ARENA_BLOCK_SIZE));
+        if(!blk) return NULL;
+        blk->size = is_large ? size : ARENA_BLOCK_SIZE;
+        blk->used = 0;
+        noteHeapAlloc(ARENA_HEADER_SIZE + blk->size);
+
+        /* A large allocation gets a block of its own, and allocations keep bumping the current block */
+        if(mem->head && is_large) {
+            blk->next = mem->head->next;
+            mem->head->next = blk;
+        } else {
+            blk->next = mem->head;
+            mem->head = blk;
+        }
+        mem->blocks++;
+    }
+
+    blk->used += size;
+    mem->bytes += size;
+    return (char *)blk + ARENA_HEADER_SIZE + blk->used - size;
+}
+
+/**
+ * @brief Copies a block of text into an arena, adding a null terminator.
+ *
+ * @param mem Pointer to the arena.
+ * @param str The text to copy.
+ * @param len Length of the text, in bytes.
+ * @return Pointer to the copy, or NULL if memory allocation failed.
+ */
+char *arenaMemdup(arena *mem, const char *str, size_t len) {
+    char *copy = (char *)arenaAlloc(mem, len + 1);
+
+    if(!copy) return NULL;
+    memcpy(copy, str, len);
+    copy[len] = '\0';
+    return copy;
+}
+
+/**
+ * @brief Copies a string into an arena.
+ *
+ * @param mem Pointer to the arena.
+ * @param str The string to copy.
+ * @return Pointer to the copy, or NULL if memory allocation failed.
+ */
+char *arenaStrdup(arena *mem, const char *str) {
+    return arenaMemdup(mem, str, strlen(str));
+}
+
+/**
+ * @brief Frees all the memory of an arena and leaves it empty.
+ *
+ * @param mem Pointer to the arena.
+ */
+void freeArena(arena *mem) {
+    arena_block *blk = mem->head, *next;
+
+    while(blk) {
+        next = blk->next;
+        noteHeapFree(ARENA_HEADER_SIZE + blk->size);
+        free(blk);
+        blk = next;
+    }
+    initArena(mem);
+}
@@ -0,0 +1,116 @@
+/**
+ * @author Tal Figenblat
+ * @date October 17, 2026
+ *
+ * @file buffer_utils.c
+ * @brief Contains functions for managing growable in-memory text buffers.
+ *
+ * The buffers double their capacity when they are full, so building a text of any
+ * length costs amortized constant time per byte.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "buffer_utils.h"
+#include "stats.h"
+
+/**
+ * @brief Initializes an empty text buffer.
+ *
+ * @param buf Pointer to the text buffer.
+ */
+void initTextBuffer(text_buffer *buf) {
+    buf->data = NULL;
+    buf->len = 0;
+    buf->size = 0;
+}
+
+/**
+ * @brief Empties a text buffer, keeping its memory for reuse.
+ *
+ * @param buf Pointer to the text buffer.
+ */
+void clearTextBuffer(text_buffer *buf) {
+    buf->len = 0;
+    if(buf->data) *buf->data = '\0';
+}
+
+/**
+ * @brief Appends text of known length to a text buffer.
+ *
+ * @param buf Pointer to the text buffer.
+ * @param str The text to append.
+ * @param len Length of the text, in bytes.
+ * @return EXIT_SUCCESS if the text was appended, EXIT_FAILURE if memory allocation failed.
+ */
+int appendTextBuffer(text_buffer *buf, const char *str, size_t len) {
+    size_t size = buf->size ? buf->size : BUFFER_INIT_SIZE;
+    char *data;
+
+    /* Grow the block geometrically, keeping room for the null terminator */
+    if(buf->len + len + 1 > buf->size) {
+        while(buf->len + len + 1 > size) size *= 2;
+        data = (char *)realloc(buf->data, size);
+        if(!data) return EXIT_FAILURE;
+        noteHeapAlloc(size - buf->size);
+        buf->data = data;
+        buf->size = size;
+    }
+
+    if(len) memcpy(buf->data + buf->len, str, len);
+    buf->len += len;
+    buf->data[buf->len] = '\0';
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Appends a null-terminated string to a text buffer.
+ *
+ * @param buf Pointer to the text buffer.
+ * @param str The string to append.
+ * @return EXIT_SUCCESS if the string was appended, EXIT_FAILURE if memory allocation failed.
+ */
+int appendTextBufferString(text_buffer *buf, const char *str) {
+    return appendTextBuffer(buf, str, strlen(str));
+}
+
+/**
+ * @brief Writes the content of a text buffer to a file with a single call.
+ *
+ * @param buf Pointer to the text buffer.
+ * @param fp The file to write to.
+ * @return EXIT_SUCCESS if all the text was written, EXIT_FAILURE otherwise.
+ */
+int writeTextBuffer(const text_buffer *buf, FILE *fp) {
+    if(buf->len && fwrite(buf->data, 1, buf->len, fp) != buf->len)
+        return EXIT_FAILURE;
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Appends everything left in a file to a text buffer.
+ *
+ * @param buf Pointer to the text buffer.
+ * @param fp The file to read from.
+ * @return EXIT_SUCCESS if the file was read to its end, EXIT_FAILURE otherwise.
+ */
+int readTextBuffer(text_buffer *buf, FILE *fp) {
+    char chunk[BUFFER_READ_SIZE];
+    size_t n;
+
+    while((n = fread(chunk, 1, sizeof(chunk), fp)) > 0) {
+        if(appendTextBuffer(buf, chunk, n)) return EXIT_FAILURE;
+    }
+    return ferror(fp) ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+/**
+ * @brief Frees the memory of a text buffer and leaves it empty.
+ *
+ * @param buf Pointer to the text buffer.
+ */
+void freeTextBuffer(text_buffer *buf) {
+    noteHeapFree(buf->size);
+    free(buf->data);
+    initTextBuffer(buf);
+}
@@ -0,0 +1,523 @@
+/**
+ * @author Tal Figenblat
+ * @date October 17, 2026
+ *
+ * @file build_cache.c
+ * @brief Contains functions for the content-addressed build cache of the assembler.
+ *
+ * An entry starts with the line "ASMCACHE1 <result>", followed by the messages of the file and
+ * each of its output files, in the order of output_suffixes. Each section is either a line holding
+ * its length followed by its bytes, or the line "-" when the file was not produced.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <utime.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include "preprocessor.h"
+#include "errors_handling.h"
+#include "file_utils.h"
+#include "build_cache.h"
+
+/**
+ * @brief Prepares the cache directory, creating it when needed.
+ *
+ * @param opts Pointer to the options; the cache is disabled if its directory cannot be created.
+ */
+void openBuildCache(assembler_options *opts) {
+    if(!opts->cache_dir) return;
+
+    if(mkdir(opts->cache_dir, 0777) && errno != EEXIST) {
+        fprintf(stderr, "%s %s\n", getError(FILE_OPEN_FAILED), opts->cache_dir);
+        opts->cache_dir = NULL;
+        return;
+    }
+
+    /* The messages of each file are captured to be stored with its outputs */
+    if(initThreadLogs()) {
+        fprintf(stderr, "%s\n", getError(ALLOC_FAILED));
+        opts->cache_dir = NULL;
+    }
+}
+
+/**
+ * @brief Reads a whole file into a text buffer.
+ *
+ * @param name The path of the file.
+ * @param buf Pointer to an empty text buffer receiving the content.
+ * @return EXIT_SUCCESS if the file was read, READ_FILE_MISSING if it does not exist, EXIT_FAILURE otherwise.
+ */
+int readWholeFile(const char *name, text_buffer *buf) {
+    int result;
+    FILE *fp = fopen(name, "rb");
+
+    /* errno is only meaningful right after the failed call, so it is not left to the caller */
+    if(!fp) return errno == ENOENT ? READ_FILE_MISSING : EXIT_FAILURE;
+    result = readTextBuffer(buf, fp);
+    fclose(fp);
+    return result;
+}
+
+/**
+ * @brief Computes the key of a source file.
+ *
+ * The key covers everything the output depends on: the assembler version, the options that
+ * change the output, the macro library, the file name (which appears in the messages) and the
+ * source itself.
+ *
+ * @param file_name The name of the source file (without extension).
+ * @param opts Pointer to the command-line options.
+ * @param key Receives the key, as hexadecimal digits followed by a null terminator.
+ * @return EXIT_SUCCESS if the key was computed, EXIT_FAILURE if the source could not be read.
+ */
+int computeCacheKey(const char *file_name, const assembler_options *opts, char key[CACHE_KEY_SIZE + 1]) {
+    static const char hex[] = "0123456789abcdef";
+    unsigned char digest[SHA256_DIGEST_SIZE];
+    char flags[6], lib_len[24];
+    char *name = append_suffix(file_name, ".as");
+    text_buffer src, lib;
+    sha256_ctx ctx;
+    int i, status;
+
+    if(!name) return EXIT_FAILURE;
+    initTextBuffer(&src);
+    initTextBuffer(&lib);
+    status = readWholeFile(name, &src);
+    free(name);
+
+    /* The library was loaded without errors, so it can be read */
+    if(!status && opts->macro_lib_path)
+        status = readWholeFile(opts->macro_lib_path, &lib);
+    if(status) {
+        freeTextBuffer(&src);
+        freeTextBuffer(&lib);
+        return EXIT_FAILURE;
+    }
+
+    flags[0] = (char)('0' + opts->emit_am);
+    flags[1] = (char)('0' + opts->arena_stats);
+    flags[2] = (char)('0' + opts->large_memory);
+    flags[3] = (char)('0' + opts->object_format);
+    flags[4] = (char)('0' + opts->relocations);
+    flags[5] = (char)('0' + opts->ext_order);
+    sprintf(lib_len, "%lu", opts->macro_lib_path ? (unsigned long)lib.len : 0UL);
+
+    initSha256(&ctx);
+    updateSha256(&ctx, CACHE_MAGIC " " ASSEMBLER_VERSION, strlen(CACHE_MAGIC " " ASSEMBLER_VERSION) + 1);
+    updateSha256(&ctx, flags, sizeof(flags));
+    updateSha256(&ctx, lib_len, strlen(lib_len) + 1);
+    updateSha256(&ctx, lib.data, lib.len);
+    updateSha256(&ctx, file_name, strlen(file_name) + 1);
+    updateSha256(&ctx, src.data, src.len);
+    finishSha256(&ctx, digest);
+    freeTextBuffer(&src);
+    freeTextBuffer(&lib);
+
+    for(i = 0; i < SHA256_DIGEST_SIZE; i++) {
+        key[2 * i] = hex[digest[i] >> 4];
+        key[2 * i + 1] = hex[digest[i] & 0xf];
+    }
+    key[CACHE_KEY_SIZE] = '\0';
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Makes the path of an entry of the cache.
+ *
+ * @param opts Pointer to the command-line options.
+ * @param key The key of the entry.
+ * @return The path, to be freed by the caller, or NULL if memory allocation failed.
+ */
+char *getCachePath(const assembler_options *opts, const char *key) {
+    char *path = (char *)malloc(strlen(opts->cache_dir) + strlen(key) + strlen(CACHE_SUFFIX) + 2);
+
+    if(path) sprintf(path, "%s/%s%s", opts->cache_dir, key, CACHE_SUFFIX);
+    return path;
+}
+
+/**
+ * @brief Initializes an empty cache entry.
+ *
+ * @param entry Pointer to the entry.
+ */
+void initCacheEntry(cache_entry *entry) {
+    entry->result = 0;
+    initTextBuffer(&entry->log);
+    initOutputSet(&entry->outputs);
+}
+
+/**
+ * @brief Reads a decimal number ending with a newline from an entry.
+ *
+ * @param pos Pointer to the current position, moved past the newline.
+ * @param end The end of the entry.
+ * @param value Pointer to the variable receiving the number.
+ * @return EXIT_SUCCESS if a number was read, EXIT_FAILURE otherwise.
+ */
+static int readEntryNumber(const char **pos, const char *end, size_t *value) {
+    const char *p = *pos;
+    size_t num = 0;
+
+    if(p == end || *p < '0' || *p > '9') return EXIT_FAILURE;
+    for(; p < end && *p >= '0' && *p <= '9'; p++)
+        num = num * 10 + (size_t)(*p - '0');
+    if(p == end || *p != '\n') return EXIT_FAILURE;
+
+    *pos = p + 1;
+    *value = num;
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Reads a section of an entry.
+ *
+ * @param pos Pointer to the current position, moved past the section.
+ * @param end The end of the entry.
+ * @param buf Pointer to an empty text buffer receiving the section.
+ * @param present Pointer to the variable set to whether the section is present, or NULL if it must be.
+ * @return EXIT_SUCCESS if the section was read, EXIT_FAILURE otherwise.
+ */
+static int readEntrySection(const char **pos, const char *end, text_buffer *buf, int *present) {
+    size_t len;
+
+    if(present) {
+        *present = 0;
+        if(end - *pos >= 2 && !strncmp(*pos, "-\n", 2)) {
+            *pos += 2;
+            return EXIT_SUCCESS;
+        }
+        *present = 1;
+    }
+
+    if(readEntryNumber(pos, end, &len) || (size_t)(end - *pos) < len) return EXIT_FAILURE;
+    if(appendTextBuffer(buf, *pos, len)) return EXIT_FAILURE;
+    *pos += len;
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Loads an entry from the cache.
+ *
+ * @param path The path of the entry.
+ * @param entry Pointer to an empty entry receiving the content.
+ * @return EXIT_SUCCESS if a complete entry was loaded, EXIT_FAILURE otherwise.
+ */
+int loadCacheEntry(const char *path, cache_entry *entry) {
+    text_buffer data;
+    const char *pos, *end;
+    size_t result;
+    int i, status = EXIT_FAILURE;
+
+    initTextBuffer(&data);
+    if(readWholeFile(path, &data) || !data.len) {
+        freeTextBuffer(&data);
+        return EXIT_FAILURE;
+    }
+    pos = data.data;
+    end = data.data + data.len;
+
+    /* Check the header, then read each section */
+    if((size_t)(end - pos) > strlen(CACHE_MAGIC " ") && !strncmp(pos, CACHE_MAGIC " ", strlen(CACHE_MAGIC " "))) {
+        pos += strlen(CACHE_MAGIC " ");
+        if(!readEntryNumber(&pos, end, &result) && !readEntrySection(&pos, end, &entry->log, NULL)) {
+            entry->result = (int)result;
+            status = EXIT_SUCCESS;
+            for(i = 0; i < OUTPUT_KIND_COUNT && status == EXIT_SUCCESS; i++)
+                status = readEntrySection(&pos, end, &entry->outputs.files[i], &entry->outputs.present[i]);
+            if(pos != end) status = EXIT_FAILURE;
+        }
+    }
+
+    freeTextBuffer(&data);
+    return status;
+}
+
+/**
+ * @brief Writes a section of an entry.
+ *
+ * @param fp The file of the entry.
+ * @param buf Pointer to the content of the section.
+ * @param present Whether the section is present.
+ * @return EXIT_SUCCESS if the section was written, EXIT_FAILURE otherwise.
+ */
+static int writeEntrySection(FILE *fp, const text_buffer *buf, int present) {
+    if(!present) return fputs("-\n", fp) == EOF ? EXIT_FAILURE : EXIT_SUCCESS;
+    if(fprintf(fp, "%lu\n", (unsigned long)buf->len) < 0) return EXIT_FAILURE;
+    return writeTextBuffer(buf, fp);
+}
+
+/**
+ * @brief Stores an entry in the cache atomically.
+ *
+ * The entry is written to a temporary file in the cache directory and renamed into place,
+ * so other invocations never read a partial entry.
+ *
+ * @param path The path of the entry.
+ * @param entry Pointer to the entry.
+ * @return EXIT_SUCCESS if the entry was stored, EXIT_FAILURE otherwise.
+ */
+int storeCacheEntry(const char *path, const cache_entry *entry) {
+    char *tmp = append_suffix(path, CACHE_TMP_SUFFIX "XXXXXX");
+    int i, fd, status = EXIT_SUCCESS;
+    FILE *fp;
+
+    if(!tmp) return EXIT_FAILURE;
+    if((fd = mkstemp(tmp)) < 0) {
+        free(tmp);
+        return EXIT_FAILURE;
+    }
+    if(!(fp = fdopen(fd, "wb"))) {
+        close(fd);
+        remove(tmp);
+        free(tmp);
+        return EXIT_FAILURE;
+    }
+
+    if(fprintf(fp, "%s %d\n", CACHE_MAGIC, entry->result) < 0 || writeEntrySection(fp, &entry->log, 1))
+        status = EXIT_FAILURE;
+    for(i = 0; i < OUTPUT_KIND_COUNT && status == EXIT_SUCCESS; i++)
+        status = writeEntrySection(fp, &entry->outputs.files[i], entry->outputs.present[i]);
+
+    if(fclose(fp) || status || rename(tmp, path)) {
+        remove(tmp);
+        status = EXIT_FAILURE;
+    }
+    free(tmp);
+    return status;
+}
+
+/**
+ * @brief Writes the output files of an entry, and removes the ones it does not have.
+ *
+ * @param file_name The name of the source file (without extension).
+ * @param opts Pointer to the command-line options.
+ * @param entry Pointer to the entry.
+ * @return EXIT_SUCCESS if every file was written, EXIT_FAILURE otherwise.
+ */
+int restoreCacheOutputs(const char *file_name, const assembler_options *opts, const cache_entry *entry) {
+    int i, status = EXIT_SUCCESS;
+    char *name;
+    FILE *fp;
+
+    /* The ".am" file is left alone when it is not emitted */
+    for(i = opts->emit_am ? OUTPUT_AM : OUTPUT_OB; i < OUTPUT_KIND_COUNT; i++) {
+        if(!(name = append_suffix(file_name, output_suffixes[i]))) return EXIT_FAILURE;
+
+        if(!entry->outputs.present[i])
+            remove(name);
+        else if(!(fp = fopen(name, "wb")))
+            status = EXIT_FAILURE;
+        else {
+            if(writeTextBuffer(&entry->outputs.files[i], fp)) status = EXIT_FAILURE;
+            if(fclose(fp)) status = EXIT_FAILURE;
+        }
+        free(name);
+    }
+    return status;
+}
+
+/**
+ * @brief Collects the output files of an assembled source into an entry.
+ *
+ * @param file_name The name of the source file (without extension).
+ * @param opts Pointer to the command-line options.
+ * @param entry Pointer to the entry.
+ * @return EXIT_SUCCESS if every output file was read, EXIT_FAILURE otherwise.
+ */
+static int collectCacheOutputs(const char *file_name, const assembler_options *opts, cache_entry *entry) {
+    int i, status;
+    char *name;
+
+    for(i = opts->emit_am ? OUTPUT_AM : OUTPUT_OB; i < OUTPUT_KIND_COUNT; i++) {
+        if(!(name = append_suffix(file_name, output_suffixes[i]))) return EXIT_FAILURE;
+        status = readWholeFile(name, &entry->outputs.files[i]);
+        free(name);
+        if(status == EXIT_FAILURE) return EXIT_FAILURE;
+        entry->outputs.present[i] = status == EXIT_SUCCESS;
+    }
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Assembles a file through the build cache.
+ *
+ * On a hit, the outputs and messages of the file are restored from its entry. On a miss, the
+ * outputs left by an earlier run are removed, the file is assembled with its messages captured,
+ * and an entry is stored unless assembling it hit a system error.
+ *
+ * @param file_name The name of the source file (without extension).
+ * @param opts Pointer to the command-line options.
+ * @return The value the preprocessor returned for this source.
+ */
+int assembleCached(char *file_name, const assembler_options *opts) {
+    char key[CACHE_KEY_SIZE + 1];
+    char *path;
+    cache_entry entry;
+    file_log log, *outer;
+    int i, result;
+
+    /* A source that cannot be read is left to the preprocessor to report */
+    if(computeCacheKey(file_name, opts, key) || !(path = getCachePath(opts, key)))
+        return preprocessor(file_name, opts);
+
+    initCacheEntry(&entry);
+    if(!loadCacheEntry(path, &entry) && !restoreCacheOutputs(file_name, opts, &entry)) {
+        /* Hit: mark the entry as recently used and replay the messages */
+        utime(path, NULL);
+        initFileLog(&log);
+        appendLogText(&log, LOG_STREAM_OUT, entry.log.data, entry.log.len);
+        logFileLog(&log);
+        freeFileLog(&log);
+
+        result = entry.result;
+        freeCacheEntry(&entry);
+        free(path);
+        return result;
+    }
+    freeCacheEntry(&entry);
+
+    /* Miss: start from no outputs, so the files left afterwards are exactly the outputs */
+    for(i = opts->emit_am ? OUTPUT_AM : OUTPUT_OB; i < OUTPUT_KIND_COUNT; i++) {
+        char *name = append_suffix(file_name, output_suffixes[i]);
+
+        if(name) remove(name);
+        free(name);
+    }
+
+    initFileLog(&log);
+    outer = getThreadLog();
+    setThreadLog(&log);
+    result = preprocessor(file_name, opts);
+    setThreadLog(outer);
+
+    /* Only store results that do not depend on the state of the system */
+    if(!log.failed && !log.err.len) {
+        initCacheEntry(&entry);
+        entry.result = result;
+        if(!appendTextBuffer(&entry.log, log.out.data, log.out.len) &&
+           !collectCacheOutputs(file_name, opts, &entry))
+            storeCacheEntry(path, &entry);
+        freeCacheEntry(&entry);
+    }
+
+    logFileLog(&log);
+    freeFileLog(&log);
+    free(path);
+    return result;
+}
+
+/**
+ * @struct cache_file
+ * @brief Represents an entry of the cache directory, for eviction.
+ */
+typedef struct {
+    char *path;     /**< The path of the entry. */
+    time_t mtime;   /**< The last time the entry was used. */
+    off_t size;     /**< The size of the entry, in bytes. */
+} cache_file;
+
+/**
+ * @brief Orders cache files from the least to the most recently used.
+ *
+ * @param a Pointer to the first cache file.
+ * @param b Pointer to the second cache file.
+ * @return A negative value, zero or a positive value as `a` was used before, with or after `b`.
+ */
+static int compareCacheFiles(const void *a, const void *b) {
+    const cache_file *x = (const cache_file *)a, *y = (const cache_file *)b;
+
+    return x->mtime < y->mtime ? -1 : x->mtime > y->mtime;
+}
+
+/**
+ * @brief Removes the least recently used entries until the cache fits in its size.
+ *
+ * Entries removed by another invocation in the meantime are simply skipped. Temporary files
+ * older than CACHE_TMP_MAX_AGE, left by runs killed while storing an entry, are removed as
+ * well; younger ones may still be renamed into place by another invocation.
+ *
+ * @param opts Pointer to the command-line options.
+ */
+void trimBuildCache(const assembler_options *opts) {
+    unsigned long limit, total = 0;
+    size_t len, count = 0, size = 0, i;
+    cache_file *files = NULL, *grown;
+    time_t now = time(NULL);
+    struct dirent *de;
+    struct stat st;
+    int is_tmp;
+    char *path;
+    DIR *dir;
+
+    if(!opts->cache_dir || !(dir = opendir(opts->cache_dir))) return;
+    limit = (unsigned long)opts->cache_size * 1024UL * 1024UL;
+
+    /* List the entries with their size and last use */
+    while((de = readdir(dir))) {
+        len = strlen(de->d_name);
+        is_tmp = strstr(de->d_name, CACHE_SUFFIX CACHE_TMP_SUFFIX) != NULL;
+        if(!is_tmp && (len <= strlen(CACHE_SUFFIX) || strcmp(de->d_name + len - strlen(CACHE_SUFFIX), CACHE_SUFFIX)))
+            continue;
+
+        path = (char *)malloc(strlen(opts->cache_dir) + len + 2);
+        if(!path) break;
+        sprintf(path, "%s/%s", opts->cache_dir, de->d_name);
+        if(stat(path, &st) || !S_ISREG(st.st_mode)) {
+            free(path);
+            continue;
+        }
+
+        /* A temporary file is never an entry; an old one belongs to a run that was killed */
+        if(is_tmp) {
+            if(difftime(now, st.st_mtime) > CACHE_TMP_MAX_AGE) unlink(path);
+            free(path);
+            continue;
+        }
+
+        if(count == size) {
+            size = size ? size * 2 : 64;
+            grown = (cache_file *)realloc(files, sizeof(cache_file) * size);
+            if(!grown) {
+                free(path);
+                break;
+            }
+            files = grown;
+        }
+        files[count].path = path;
+        files[count].mtime = st.st_mtime;
+        files[count].size = st.st_size;
+        total += (unsigned long)st.st_size;
+        count++;
+    }
+    closedir(dir);
+
+    /* Remove the oldest entries first */
+    if(total > limit) {
+        qsort(files, count, sizeof(cache_file), compareCacheFiles);
+        for(i = 0; i < count && total > limit; i++) {
+            if(!unlink(files[i].path) || errno == ENOENT)
+                total -= (unsigned long)files[i].size;
+        }
+    }
+
+    for(i = 0; i < count; i++)
+        free(files[i].path);
+    free(files);
+}
+
+/**
+ * @brief Frees the memory of a cache entry.
+ *
+ * @param entry Pointer to the entry.
+ */
+void freeCacheEntry(cache_entry *entry) {
+    freeTextBuffer(&entry->log);
+    freeOutputSet(&entry->outputs);
+    initCacheEntry(entry);
+}
@@ -18,10 +18,12 @@
 #include "globals.h"
 #include "token_utils.h"
 #include "label.h"
+#include "fixup.h"
 #include "integer_utils.h"
 #include "opcode_utils.h"
 #include "first_pass.h"
 #include "errors_handling.h"
+#include "log_utils.h"
 
 /**
  * @brief Retrieves the error message corresponding to an error code.
@@ -62,7 +64,20 @@ const char *getError(int error_code) {
             "Error deleting the file",
             "Number out of range",
             "Undefined label",
-            "Macro has more than one definition"
+            "Macro has more than one definition",
+            "Unknown option",
+            "Invalid option value",
+            "Unable to write the file",
+            "Only macro definitions are allowed in a macro library",
+            "The standard input must be the only source file",
+            "Unable to read the standard input",
+            "Invalid request",
+            "Entry label exported by more than one object",
+            "External label not exported by any object",
+            "External label used outside the instructions",
+            "Address outside the object",
+            "Linked image does not fit in the memory",
+            "Address does not fit in a word"
     };
 
     /* Check if the error_code is out of bounds */
@@ -79,56 +94,22 @@ const char *getError(int error_code) {
  * @param err The error code corresponding to the specific error.
  */
 void printError(int line_counter, Error err) {
-    /* Print the error message with the line number */
-    printf("    Error found in line %d: %s\n", line_counter, getError(err));
+    /* Print the error message with the line number, keeping it as a diagnostic if asked to */
+    logDiagnostic(line_counter, err);
+    logPrintf("    Error found in line %d: %s\n", line_counter, getError(err));
 }
 
 /**
- * @brief Handles memory allocation failure, frees resources, and exits the program.
+ * @brief Checks if a line is too long.
  *
- * @param ptr The pointer that was expected to be allocated.
- * @param tb Pointer to the macro table that needs to be freed.
- * @param fp1 Pointer to the first file to be closed.
- * @param fp2 Pointer to the second file to be closed.
- */
-void allocFail(const char *ptr, macr_table *tb, FILE *fp1, FILE *fp2) {
-    /* Check if the allocation failed */
-    if(!ptr) {
-        fprintf(stderr, "    %s\n", getError(ALLOC_FAILED));
-        freeMacrTable(tb);
-        fclose(fp1);
-        fclose(fp2);
-        exit(EXIT_FAILURE);
-    }
-}
-
-/**
- * @brief Cleans the current line from the file if it is too long.
- *
- * @param fp The file pointer from which to read the characters.
- */
-void clean_line(FILE *fp) {
-    char c;
-
-    /* Skip to the end of the current line if it is too long */
-    while((c = (char)getc(fp)) != EOF && c != '\n');
-}
-
-/**
- * @brief Checks if any lines in the specified file are too long.
- *
- * @param fp The file pointer to read from.
- * @param line A pointer to the line buffer to check.
+ * @param len The length of the line, without its newline character.
  * @param line_counter The current line number being checked.
  * @return EXIT_SUCCESS if the line is of acceptable length; otherwise, EXIT_FAILURE.
  */
-int checkLine(FILE *fp, char *line, int line_counter) {
-    int len = (int)strlen(line);
-
+int checkLine(size_t len, int line_counter) {
     /* Check if the line length exceeds the maximum allowed size */
-    if(len > MAX_LINE_SIZE || (len == MAX_LINE_SIZE && line[len - 1] != '\n')) {
+    if(len >= MAX_LINE_SIZE) {
         printError(line_counter, LINE_TOO_LONG);
-        clean_line(fp);
         return EXIT_FAILURE;
     }
 
@@ -143,9 +124,9 @@ int checkLine(FILE *fp, char *line, int line_counter) {
  * @param line_counter The line number where the check is performed.
  * @return 1 if an error is found, otherwise 0.
  */
-int check_commas(int counter, const char *str, int line_counter) {
+int check_commas(int counter, text_span str, int line_counter) {
     /* Check for missing comma */
-    if(!counter && *str) {
+    if(!counter && str.len) {
         printError(line_counter, MISSING_COMMA);
         return 1;
     }
@@ -163,30 +144,32 @@ int check_commas(int counter, const char *str, int line_counter) {
  *
  * @param op The opcode to validate.
  * @param ptr Pointer to the current position in the string being processed.
- * @param iptr Pointer to the memory location where the instruction will be encoded.
+ * @param seg Pointer to the instruction segment the instruction is encoded into.
  * @param idx The current index in the instruction memory.
  * @param line_counter The line number for error reporting.
  * @param label_tb Pointer to the label table used for resolving addresses.
  * @param macr_tb Pointer to the macro table used for resolving macro names.
+ * @param fixup_tb Pointer to the fixup table receiving the operands that refer to labels.
  * @return The number of memory words used by the instruction, or 0 if an error occurs.
  */
-int isLegalOpcode(opcode op, char *ptr, unsigned short *iptr, int idx, int line_counter, label_table *label_tb, macr_table *macr_tb) {
-    char str1[MAX_LINE_SIZE + 1], str2[MAX_LINE_SIZE + 1], str3[MAX_LINE_SIZE + 1];
-    int tmp, opr1, opr2, foundErr = EXIT_SUCCESS;
+int isLegalOpcode(opcode op, char *ptr, memory_segment *seg, int idx, int line_counter,
+                  label_table *label_tb, macr_table *macr_tb, fixup_table *fixup_tb) {
+    text_span str1, str2, str3;
+    int tmp, opr1, opr2, words, foundErr = EXIT_SUCCESS;
 
-    /* Retrieve the first operand */
-    if(nextToken(str1, &ptr, ',')) {
+    /* Retrieve the first operand, as a span of the line */
+    if(nextSpan(&str1, &ptr, ',')) {
         printError(line_counter, ILLEGAL_COMMA);
         return 0;
     }
 
     /* Retrieve the second operand */
-    tmp = nextToken(str2, &ptr, ',');
+    tmp = nextSpan(&str2, &ptr, ',');
     if(check_commas(tmp, str2, line_counter)) return 0;
 
     /* Check for any extraneous text after the second operand */
-    nextToken(str3, &ptr, ' ');
-    if(*str3) {
+    nextSpan(&str3, &ptr, ' ');
+    if(str3.len) {
         printError(line_counter, UNEXPECTED_OPERAND);
         return 0;
     }
@@ -199,7 +182,7 @@ int isLegalOpcode(opcode op, char *ptr, unsigned short *iptr, int idx, int line_
     if(opr2 == -1) opr2 = opr1, opr1 = -1;
 
     /* Encode the first word of the instruction if there's space in memory */
-    if(idx < MEMORY_SIZE) encode_first_word(iptr, op, opr1, opr2);
+    if(idx < seg->limit) encode_first_word(seg->words + idx, op, opr1, opr2);
     else foundErr = EXIT_FAILURE;
 
     /* Further adjustment of operand order if necessary */
@@ -218,11 +201,10 @@ int isLegalOpcode(opcode op, char *ptr, unsigned short *iptr, int idx, int line_
                 printError(line_counter, INVALID_DEST_OPERAND);
                 return 0;
             }
-            if(foundErr) return foundErr;
 
-            /* Return the number of words used based on addressing methods */
-            if(opr1 >= 2 && opr2 >= 2) return 2;
-            return 3;
+            /* Count the words used based on addressing methods */
+            words = (opr1 >= 2 && opr2 >= 2) ? 2 : 3;
+            break;
 
         case cmp:
             if(opr1 == -1) {
@@ -233,11 +215,10 @@ int isLegalOpcode(opcode op, char *ptr, unsigned short *iptr, int idx, int line_
                 printError(line_counter, INVALID_DEST_OPERAND);
                 return 0;
             }
-            if(foundErr) return foundErr;
 
-            /* Return the number of words used based on addressing methods */
-            if(opr1 >= 2 && opr2 >= 2) return 2;
-            return 3;
+            /* Count the words used based on addressing methods */
+            words = (opr1 >= 2 && opr2 >= 2) ? 2 : 3;
+            break;
 
         case lea:
             if(opr1 != 1) {
@@ -248,8 +229,8 @@ int isLegalOpcode(opcode op, char *ptr, unsigned short *iptr, int idx, int line_
                 printError(line_counter, INVALID_DEST_OPERAND);
                 return 0;
             }
-            if(foundErr) return foundErr;
-            return 3;
+            words = 3;
+            break;
 
         case clr:
         case not:
@@ -262,12 +243,12 @@ int isLegalOpcode(opcode op, char *ptr, unsigned short *iptr, int idx, int line_
                 return 0;
             }
             /* Ensure there is no second operand */
-            if(*str2) {
+            if(str2.len) {
                 printError(line_counter, UNEXPECTED_OPERAND);
                 return 0;
             }
-            if(foundErr) return foundErr;
-            return 2;
+            words = 2;
+            break;
 
         case jmp:
         case bne:
@@ -278,12 +259,12 @@ int isLegalOpcode(opcode op, char *ptr, unsigned short *iptr, int idx, int line_
                 return 0;
             }
             /* Ensure there is no second operand */
-            if(*str2) {
+            if(str2.len) {
                 printError(line_counter, UNEXPECTED_OPERAND);
                 return 0;
             }
-            if(foundErr) return foundErr;
-            return 2;
+            words = 2;
+            break;
 
         case prn:
             /* instruction with one operand */
@@ -292,50 +273,59 @@ int isLegalOpcode(opcode op, char *ptr, unsigned short *iptr, int idx, int line_
                 return 0;
             }
             /* Ensure there is no second operand */
-            if(*str2) {
+            if(str2.len) {
                 printError(line_counter, UNEXPECTED_OPERAND);
                 return 0;
             }
-            if(foundErr) return foundErr;
-            return 2;
+            words = 2;
+            break;
 
         case rts:
         case stop:
             /* No operand instructions */
-            if(*str1) {
+            if(str1.len) {
                 printError(line_counter, UNEXPECTED_OPERAND);
                 return 0;
             }
-            if(foundErr) return foundErr;
-            return 1;
+            words = 1;
+            break;
 
         default:
             return 0; /* Return 0 for unsupported opcodes */
     }
+    if(foundErr) return foundErr;
+
+    /* Encode the extra words, recording the operands that refer to labels */
+    if(idx + words <= seg->limit &&
+       encode_operands(seg->words + idx + 1, idx + 1, opr1, opr2, str1, str2, line_counter, fixup_tb)) {
+        logErrorf("    %s\n", getError(ALLOC_FAILED));
+        return 0;
+    }
+    return words;
 }
 
 /**
  * @brief Validates and processes a data string.
  *
  * @param ptr The pointer to the data string.
- * @param dptr Pointer to where the processed data will be stored.
+ * @param seg Pointer to the data segment the processed data is stored into.
  * @param idx The current index in the data memory.
  * @param line_counter The line number for error reporting.
  * @return The number of data elements processed, or 0 if an error occurs.
  */
-int isLegalData(char *ptr, unsigned short *dptr, int idx, int line_counter) {
+int isLegalData(char *ptr, memory_segment *seg, int idx, int line_counter) {
     int num, countData = 0;
-    char str[MAX_LINE_SIZE + 1];
+    text_span str;
     int tmp, len;
 
     /* Check for the first token in the string */
-    if(nextToken(str, &ptr, ',')) {
+    if(nextSpan(&str, &ptr, ',')) {
         printError(line_counter, ILLEGAL_COMMA);
         return 0;
     }
 
     /* Iterate through each token */
-    while(*str && idx < MEMORY_SIZE) {
+    while(str.len && idx < seg->limit) {
         num = parseDataInt(str, line_counter);
         countData++;
 
@@ -343,47 +333,46 @@ int isLegalData(char *ptr, unsigned short *dptr, int idx, int line_counter) {
         if(num == DATA_MAX_VALUE + 1) return 0;
 
         /* Validate the length of the integer */
-        len = (int)strlen(str);
-        if(*str == '+') len--;
+        len = (int)str.len;
+        if(*str.text == '+') len--;
         if(len != countDigits(num)) {
             printError(line_counter, NOT_INTEGER);
             return 0;
         }
 
-        *dptr = num;        /* Store the number in the data pointer */
-        *dptr &= CLEAR_MSB; /* Clear the most significant bit */
-        if(++idx < MEMORY_SIZE) dptr++;
+        seg->words[idx] = num;        /* Store the number in the data segment */
+        seg->words[idx++] &= CLEAR_MSB; /* Clear the most significant bit */
 
         /* Move to the next token */
-        tmp = nextToken(str, &ptr, ',');
+        tmp = nextSpan(&str, &ptr, ',');
         if(check_commas(tmp, str, line_counter)) return 0; /* Check for comma errors */
     }
 
     /* Check for memory overflow */
-    if(idx >= MEMORY_SIZE) return 0;
+    if(idx >= seg->limit) return 0;
     return countData; /* Return the number of data elements processed */
 }
 
 /**
- * @brief Copies a string to a destination memory location as ASCII values.
+ * @brief Copies a string to a destination segment as ASCII values.
  *
- * @param dest The destination pointer where the ASCII values will be stored.
- * @param source The source string to be copied.
+ * @param seg The destination segment where the ASCII values will be stored.
+ * @param source The characters to be copied.
  * @param idx The current index in the memory.
  * @return 0 if successful, 1 if memory overflow occurs.
  */
-int strcpy_ascii(unsigned short *dest, char *source, int idx) {
+int strcpy_ascii(memory_segment *seg, text_span source, int idx) {
+    size_t i;
+
     /* Copy each character to the destination memory */
-    while(*source && idx < MEMORY_SIZE) {
-        *dest = (unsigned short)*source; /* Convert character to unsigned short */
-        *dest &= CLEAR_MSB;              /* Clear the most significant bit */
-        if(++idx < MEMORY_SIZE) dest++;
-        source++;
+    for(i = 0; i < source.len && idx < seg->limit; i++) {
+        seg->words[idx] = (unsigned short)source.text[i]; /* Convert character to unsigned short */
+        seg->words[idx++] &= CLEAR_MSB;                   /* Clear the most significant bit */
     }
     /* Check for memory overflow */
-    if(idx >= MEMORY_SIZE) return 1;
+    if(idx >= seg->limit) return 1;
 
-    *dest = '\0'; /* Null-terminate the destination string */
+    seg->words[idx] = '\0'; /* Null-terminate the destination string */
     return 0;
 }
 
@@ -391,24 +380,24 @@ int strcpy_ascii(unsigned short *dest, char *source, int idx) {
  * @brief Validates and processes a string directive.
  *
  * @param ptr The pointer to the string directive.
- * @param dptr Pointer to where the processed string will be stored.
+ * @param seg Pointer to the data segment the processed string is stored into.
  * @param idx The current index in the memory.
  * @param line_counter The line number for error reporting.
  * @return The length of the string if valid, otherwise 0.
  */
-int isLegalString(char *ptr, unsigned short *dptr, int idx, int line_counter) {
-    char str[MAX_LINE_SIZE + 1];
+int isLegalString(char *ptr, memory_segment *seg, int idx, int line_counter) {
+    text_span str;
     int len;
 
-    /* Retrieve the string from the pointer */
-    if(nextString(str, &ptr, line_counter)) return 0;
+    /* Retrieve the string from the pointer, as a span of the line */
+    if(nextString(&str, &ptr, line_counter)) return 0;
 
-    len = (int)strlen(str); /* Get the length of the string */
-    if(strcpy_ascii(dptr, str, idx)) return 0; /* Copy the string to memory */
+    len = (int)str.len; /* Get the length of the string */
+    if(strcpy_ascii(seg, str, idx)) return 0; /* Copy the string to memory */
 
-    nextToken(str, &ptr, ' ');
+    nextSpan(&str, &ptr, ' ');
     /* Ensure there are no additional tokens after the string */
-    if(*str) {
+    if(str.len) {
         printError(line_counter, EXTRANEOUS_TEXT_AFTER_STRING);
         return 0;
     }
@@ -0,0 +1,191 @@
+/**
+ * @author Tal Figenblat
+ * @date October 17, 2026
+ *
+ * @file extern_refs.c
+ * @brief Contains functions for the table of uses of external labels.
+ *
+ * A use is two integers, so recording one while the fixups are resolved costs a single store;
+ * the names and the formatting are only needed when the table is written.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "extern_refs.h"
+#include "stats.h"
+
+/**
+ * @brief Initializes an empty table for a given number of uses.
+ *
+ * @param tb Pointer to the table.
+ * @param size Largest number of uses, such as the number of fixups of the file.
+ * @return EXIT_SUCCESS if the table was initialized, EXIT_FAILURE if memory allocation failed.
+ */
+int initExternTable(extern_table *tb, int size) {
+    tb->count = 0;
+    tb->size = size;
+    tb->names = NULL;
+    tb->name_count = 0;
+    tb->items = (extern_ref *)malloc(sizeof(extern_ref) * (size + 1));
+    if(!tb->items) return EXIT_FAILURE;
+    noteHeapAlloc(sizeof(extern_ref) * (size + 1));
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Records a use of an external label.
+ *
+ * @param tb Pointer to the table, which must have room for the use.
+ * @param symbol The number of the external label.
+ * @param address Address of the word using the label.
+ */
+void addExternRef(extern_table *tb, int symbol, int address) {
+    tb->items[tb->count].symbol = symbol;
+    tb->items[tb->count++].address = address;
+}
+
+/**
+ * @brief Compares two names of external labels, given as pointers into the array of names.
+ *
+ * @param a Pointer to the pointer to the first name.
+ * @param b Pointer to the pointer to the second name.
+ * @return A negative, zero or positive number, as strcmp.
+ */
+static int compareNames(const void *a, const void *b) {
+    return strcmp(**(const char ***)a, **(const char ***)b);
+}
+
+/**
+ * @brief Computes the rank of each external label in the order of the groups.
+ *
+ * @param tb Pointer to the table, whose names are set.
+ * @param count Number of external labels.
+ * @param order The order of the groups.
+ * @param rank The array receiving the rank of each label by number.
+ * @return EXIT_SUCCESS if the ranks were computed, EXIT_FAILURE if memory allocation failed.
+ */
+static int rankSymbols(const extern_table *tb, int count, extern_order order, int *rank) {
+    const char ***sorted;
+    int i;
+
+    if(order == EXTERN_ORDER_GROUPED) {
+        for(i = 0; i < count; i++)
+            rank[i] = i;
+        return EXIT_SUCCESS;
+    }
+
+    /* Sort pointers into the array of names, whose offsets are the label numbers */
+    if(!(sorted = (const char ***)malloc(sizeof(const char **) * (count + 1)))) return EXIT_FAILURE;
+    noteHeapAlloc(sizeof(const char **) * (count + 1));
+    for(i = 0; i < count; i++)
+        sorted[i] = &tb->names[i];
+    qsort(sorted, (size_t)count, sizeof(const char **), compareNames);
+    for(i = 0; i < count; i++)
+        rank[sorted[i] - tb->names] = i;
+    noteHeapFree(sizeof(const char **) * (count + 1));
+    free(sorted);
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Puts the uses in the selected order, once they are all recorded.
+ *
+ * Grouping is a stable counting sort over the label numbers, so the uses of each label stay
+ * in source order.
+ *
+ * @param tb Pointer to the table.
+ * @param label_tb Pointer to the label table, whose external labels are numbered.
+ * @param order The order of the uses.
+ * @return EXIT_SUCCESS if the table was ordered, EXIT_FAILURE if memory allocation failed.
+ */
+int orderExternRefs(extern_table *tb, const label_table *label_tb, extern_order order) {
+    int i, count = label_tb->extern_count, *rank, *starts;
+    extern_ref *items;
+    label *ptr;
+
+    if(!(tb->names = (const char **)malloc(sizeof(const char *) * (count + 1)))) return EXIT_FAILURE;
+    tb->name_count = count;
+    noteHeapAlloc(sizeof(const char *) * (count + 1));
+    for(ptr = label_tb->extern_head; ptr; ptr = ptr->next_listed)
+        tb->names[ptr->extern_id] = ptr->name;
+    if(order == EXTERN_ORDER_SOURCE || tb->count < 2) return EXIT_SUCCESS;
+
+    rank = (int *)malloc(sizeof(int) * (count + 1));
+    starts = (int *)calloc((size_t)count + 1, sizeof(int));
+    items = (extern_ref *)malloc(sizeof(extern_ref) * (tb->size + 1));
+    if(!rank || !starts || !items || rankSymbols(tb, count, order, rank)) {
+        free(rank);
+        free(starts);
+        free(items);
+        return EXIT_FAILURE;
+    }
+
+    /* The ranks, the counts and the ordered copy of the uses are held together for a moment */
+    noteHeapAlloc(sizeof(int) * (2 * count + 2) + sizeof(extern_ref) * (tb->size + 1));
+
+    /* Count the uses of each label by rank, then place them after the groups of lower ranks */
+    for(i = 0; i < tb->count; i++)
+        starts[rank[tb->items[i].symbol] + 1]++;
+    for(i = 1; i < count; i++)
+        starts[i] += starts[i - 1];
+    for(i = 0; i < tb->count; i++)
+        items[starts[rank[tb->items[i].symbol]]++] = tb->items[i];
+
+    free(tb->items);
+    tb->items = items;
+    free(rank);
+    free(starts);
+    noteHeapFree(sizeof(int) * (2 * count + 2) + sizeof(extern_ref) * (tb->size + 1));
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Writes the ".ext" file: the name of the label and the address of each use, one per line.
+ *
+ * @param tb Pointer to the ordered table.
+ * @param w Pointer to the writer of the file.
+ */
+void writeExternRefs(const extern_table *tb, output_writer *w) {
+    const char *name;
+    int i;
+
+    for(i = 0; i < tb->count; i++) {
+        name = tb->names[tb->items[i].symbol];
+        writeBytes(w, name, strlen(name));
+        writeChar(w, ' ');
+        writeAddress(w, tb->items[i].address, tb->items[i].address < 1000);
+        writeChar(w, '\n');
+    }
+}
+
+/**
+ * @brief Fills the symbols of the uses for the binary object file, in the order of the table.
+ *
+ * @param tb Pointer to the ordered table.
+ * @param symbols The array receiving one symbol per use.
+ */
+void fillExternSymbols(const extern_table *tb, object_symbol *symbols) {
+    int i;
+
+    for(i = 0; i < tb->count; i++) {
+        symbols[i].name = tb->names[tb->items[i].symbol];
+        symbols[i].address = tb->items[i].address;
+    }
+}
+
+/**
+ * @brief Frees the memory of the table.
+ *
+ * @param tb Pointer to the table.
+ */
+void freeExternTable(extern_table *tb) {
+    if(tb->items) noteHeapFree(sizeof(extern_ref) * (tb->size + 1));
+    if(tb->names) noteHeapFree(sizeof(const char *) * (tb->name_count + 1));
+    free(tb->items);
+    free((void *)tb->names);
+    tb->items = NULL;
+    tb->names = NULL;
+    tb->name_count = 0;
+    tb->count = 0;
+    tb->size = 0;
+}
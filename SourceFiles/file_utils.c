@@ -14,6 +14,13 @@
 #include "label.h"
 #include "macr.h"
 #include "errors_handling.h"
+#include "options.h"
+#include "log_utils.h"
+#include "job_pool.h"
+#include "build_cache.h"
+#include "pipe_mode.h"
+#include "server.h"
+#include "stats.h"
 #include "file_utils.h"
 
 /**
@@ -21,26 +28,17 @@
  *
  * @param str The original string.
  * @param suffix The suffix to append.
- * @param label_tb Pointer to the label table for memory cleanup in case of failure.
- * @param macr_tb Pointer to the macro table for memory cleanup in case of failure.
- * @param fp1 Pointer to the first file for cleanup in case of failure.
- * @param fp2 Pointer to the second file for cleanup in case of failure.
- * @param fp3 Pointer to the third file for cleanup in case of failure.
- * @return char* The newly created string with the suffix appended.
+ * @return char* The newly created string with the suffix appended, or NULL if memory allocation failed.
  */
-char *append_suffix(const char *str, const char *suffix, label_table *label_tb,
-                    macr_table *macr_tb, FILE *fp1, FILE *fp2, FILE *fp3) {
+char *append_suffix(const char *str, const char *suffix) {
     size_t len1 = strlen(str);
     size_t len2 = strlen(suffix);
     char *result = (char *)malloc(len1 + len2 + 1);
 
     /* Check if memory allocation failed */
     if(!result) {
-        fprintf(stderr, "    %s\n", getError(ALLOC_FAILED));
-        if(label_tb) freeLabelTable(label_tb);
-        if(macr_tb) freeMacrTable(macr_tb);
-        close_multiple_files(fp1, fp2, fp3, NULL);
-        exit(EXIT_FAILURE);
+        logErrorf("    %s\n", getError(ALLOC_FAILED));
+        return NULL;
     }
 
     sprintf(result, "%s%s", str, suffix);
@@ -53,27 +51,18 @@ char *append_suffix(const char *str, const char *suffix, label_table *label_tb,
  * @param file_name The name of the file to open.
  * @param suffix The suffix to append to the file name.
  * @param mode The mode in which to open the file (e.g., "r", "w").
- * @param label_tb Pointer to the label table for memory cleanup in case of failure.
- * @param macr_tb Pointer to the macro table for memory cleanup in case of failure.
- * @param fp1 Pointer to the first file for cleanup in case of failure.
- * @param fp2 Pointer to the second file for cleanup in case of failure.
- * @param fp3 Pointer to the third file for cleanup in case of failure.
- * @return FILE* The file pointer of the opened file.
+ * @return FILE* The file pointer of the opened file, or NULL if the file could not be opened.
  */
-FILE *open_file_with_suffix(const char *file_name, const char *suffix, const char *mode,
-                            label_table *label_tb, macr_table *macr_tb, FILE *fp1, FILE *fp2, FILE *fp3) {
-    char *file_name_with_suffix = append_suffix(file_name, suffix, label_tb, macr_tb, fp1, fp2, fp3);
-    FILE *fp = fopen(file_name_with_suffix, mode);
+FILE *open_file_with_suffix(const char *file_name, const char *suffix, const char *mode) {
+    char *file_name_with_suffix = append_suffix(file_name, suffix);
+    FILE *fp;
+
+    if(!file_name_with_suffix) return NULL;
+    fp = fopen(file_name_with_suffix, mode);
 
     /* Check if the file opening failed */
-    if(!fp) {
-        fprintf(stderr, "    %s %s\n", getError(FILE_OPEN_FAILED), file_name_with_suffix);
-        if(label_tb) freeLabelTable(label_tb);
-        if(macr_tb) freeMacrTable(macr_tb);
-        free(file_name_with_suffix);
-        close_multiple_files(fp1, fp2, fp3, NULL);
-        exit(EXIT_FAILURE);
-    }
+    if(!fp)
+        logErrorf("    %s %s\n", getError(FILE_OPEN_FAILED), file_name_with_suffix);
 
     free(file_name_with_suffix);
     return fp;
@@ -84,15 +73,15 @@ FILE *open_file_with_suffix(const char *file_name, const char *suffix, const cha
  *
  * @param ptr Pointer to the array of instructions.
  * @param IC The instruction count.
- * @param fp The file pointer where the instructions will be printed.
+ * @param w The writer of the file where the instructions will be printed.
  */
-void print_instructions(unsigned short *ptr, int IC, FILE *fp) {
+void print_instructions(unsigned short *ptr, int IC, output_writer *w) {
     int i;
 
     for(i = 0; i < IC; i++) {
-        if(i < 1000)  fprintf(fp, "0"); /* Ensure consistent formatting for indices below 1000 */
-        fprintf(fp, "%d ", 100 + i);
-        fprintf(fp, "%05o\n", ptr[i]);
+        writeAddress(w, 100 + i, i < 1000); /* Ensure consistent formatting for indices below 1000 */
+        writeChar(w, ' ');
+        writeOctalWord(w, ptr[i]);
     }
 }
 
@@ -102,15 +91,15 @@ void print_instructions(unsigned short *ptr, int IC, FILE *fp) {
  * @param ptr Pointer to the array of data.
  * @param IC The instruction count to offset the data indices.
  * @param DC The data count.
- * @param fp The file pointer where the data will be printed.
+ * @param w The writer of the file where the data will be printed.
  */
-void print_data(unsigned short *ptr, int IC, int DC, FILE *fp) {
+void print_data(unsigned short *ptr, int IC, int DC, output_writer *w) {
     int i;
 
     for(i = 0; i < DC; i++) {
-        if(i < 1000)  fprintf(fp, "0"); /* Ensure consistent formatting for indices below 1000 */
-        fprintf(fp, "%d ", 100 + IC + i);
-        fprintf(fp, "%05o\n", ptr[i]);
+        writeAddress(w, 100 + IC + i, i < 1000); /* Ensure consistent formatting for indices below 1000 */
+        writeChar(w, ' ');
+        writeOctalWord(w, ptr[i]);
     }
 }
 
@@ -118,18 +107,19 @@ void print_data(unsigned short *ptr, int IC, int DC, FILE *fp) {
  * @brief Creates an entry file listing all labels marked as entry.
  *
  * @param label_tb Pointer to the label table.
- * @param fp The file pointer where the entry labels will be printed.
+ * @param w The writer of the file where the entry labels will be printed.
  */
-void create_entry_file(label_table *label_tb, FILE *fp) {
-    label *ptr = label_tb->head;
-
-    while(ptr) {
-        if(ptr->is_entry) {
-            fprintf(fp, "%s ", ptr->name);
-            if(ptr->address < 1000)  fprintf(fp, "0"); /* Ensure consistent formatting for addresses below 1000 */
-            fprintf(fp, "%d\n", ptr->address);
-        }
-        ptr = ptr->next;
+void create_entry_file(label_table *label_tb, output_writer *w) {
+    label *ptr;
+    int address;
+
+    /* Only the entry labels are visited */
+    for(ptr = label_tb->entry_head; ptr; ptr = ptr->next_listed) {
+        address = labelAddress(label_tb, ptr);
+        writeBytes(w, ptr->name, strlen(ptr->name));
+        writeChar(w, ' ');
+        writeAddress(w, address, address < 1000); /* Ensure consistent formatting for addresses below 1000 */
+        writeChar(w, '\n');
     }
 }
 
@@ -155,7 +145,7 @@ void close_multiple_files(FILE *fp1, FILE *fp2, FILE *fp3, FILE *fp4) {
  */
 void remove_file(const char *file_name) {
     if(remove(file_name))
-        fprintf(stderr, "    %s %s\n", getError(FILE_DELETION_FAILED), file_name);
+        logErrorf("    %s %s\n", getError(FILE_DELETION_FAILED), file_name);
 }
 
 /**
@@ -163,18 +153,65 @@ void remove_file(const char *file_name) {
  *
  * @param file_name The original file name.
  * @param suffix The suffix to append.
- * @param label_tb Pointer to the label table (used if necessary).
  */
-void process_file(const char *file_name, const char *suffix, void *label_tb) {
-    char *file_name_with_suffix = append_suffix(file_name, suffix, label_tb, NULL, NULL, NULL, NULL);
-    remove_file(file_name_with_suffix);
-    free(file_name_with_suffix);
+void process_file(const char *file_name, const char *suffix) {
+    char *file_name_with_suffix = append_suffix(file_name, suffix);
+
+    if(file_name_with_suffix) {
+        remove_file(file_name_with_suffix);
+        free(file_name_with_suffix);
+    }
+}
+
+/**
+ * @brief Removes a file left by an earlier run, if there is one, without reporting anything.
+ *
+ * @param file_name The original file name.
+ * @param suffix The suffix to append.
+ */
+void discard_file(const char *file_name, const char *suffix) {
+    char *file_name_with_suffix = append_suffix(file_name, suffix);
+
+    if(file_name_with_suffix) {
+        remove(file_name_with_suffix);
+        free(file_name_with_suffix);
+    }
+}
+
+/**
+ * @brief Writes the statistics of the files to the selected file, or to the standard error.
+ *
+ * @param opts Pointer to the options, holding the statistics of each file.
+ * @return int Returns 1 if the statistics could not be written, otherwise returns 0.
+ */
+static int reportStats(const assembler_options *opts) {
+    FILE *fp = opts->stats_path ? fopen(opts->stats_path, "w") : stderr;
+    int failed;
+
+    if(!fp) {
+        fprintf(stderr, "%s %s\n", getError(FILE_OPEN_FAILED), opts->stats_path);
+        return 1;
+    }
+    failed = writeStatsReport(fp, opts->stats, opts->files, opts->stats_list, opts->file_count);
+    if(opts->stats_path && fclose(fp)) failed = 1;
+    if(failed) fprintf(stderr, "%s %s\n", getError(FILE_WRITE_FAILED), opts->stats_path ? opts->stats_path : "stderr");
+    return failed;
 }
 
 /**
  * @brief The main assembler function.
  *
  * This function processes command-line arguments and runs the preprocessor on each input file.
+ * Options are applied first, so they affect every input file regardless of their position.
+ * With "-j N", up to N files are assembled in parallel, and their logs are printed in
+ * command-line order. With "--cache-dir DIR", files whose source did not change since an earlier
+ * run are restored from the build cache instead of being assembled. With "--macro-lib FILE",
+ * the macros of the library are parsed once and can be used by every file. With the file name
+ * "-", a single source is read from the standard input and its outputs are written to the
+ * standard output or to given file descriptors, without touching the file system. With
+ * "--serve SOCKET", the assembler stays running and assembles the sources sent by its clients.
+ * With "--stats" or "--stats-json", the time spent in each phase and the work done for each file
+ * are reported once every file is done, apart from the messages of the files.
  *
  * @param argc The number of command-line arguments.
  * @param argv The array of command-line arguments.
@@ -182,18 +219,80 @@ void process_file(const char *file_name, const char *suffix, void *label_tb) {
  */
 int assembler(int argc, char *argv[]) {
     int i, foundErr = 0;
+    assembler_options opts;
+    macr_table macro_lib;
+    arena lib_mem;
+
+    /* Apply the command-line options */
+    initOptions(&opts);
+    if(parseOptions(&opts, argc, argv)) {
+        freeOptions(&opts);
+        exit(EXIT_FAILURE);
+    }
 
     /* Check if at least one input file was provided */
-    if(argc < 2) {
+    if(!opts.file_count && !opts.serve_path) {
         fprintf(stderr, "%s\n", getError(MISSING_ARGUMENT));
+        freeOptions(&opts);
         exit(EXIT_FAILURE);
     }
 
-    /* Process each input file */
-    for(i = 1; i < argc; i++) {
-        if(preprocessor(argv[i]))
-            foundErr = 1;
+    /* A framed stream owns the standard output, so any other message goes to the standard error */
+    if(isPipeMode(&opts) && !hasOutputFds(&opts))
+        setLogOutput(stderr);
+
+    /* Load the macro library once, to be shared by every file */
+    initArena(&lib_mem);
+    initMacrTable(&macro_lib, &lib_mem);
+    if(opts.macro_lib_path) {
+        if(loadMacroLibrary(&macro_lib, opts.macro_lib_path)) {
+            freeMacrTable(&macro_lib);
+            freeArena(&lib_mem);
+            freeOptions(&opts);
+            exit(EXIT_FAILURE);
+        }
+        opts.macro_lib = &macro_lib;
+    }
+
+    openBuildCache(&opts);
+
+    /* Gather the statistics of each file, attached to the thread assembling it */
+    if(opts.stats && opts.file_count) {
+        opts.stats_list = (file_stats *)malloc(sizeof(file_stats) * opts.file_count);
+        if(!opts.stats_list || initThreadStats()) {
+            fprintf(stderr, "%s\n", getError(ALLOC_FAILED));
+            free(opts.stats_list);
+            opts.stats_list = NULL;
+        }
+        for(i = 0; opts.stats_list && i < opts.file_count; i++)
+            initFileStats(&opts.stats_list[i]);
+        if(opts.stats_list) setThreadStats(&opts.stats_list[0]);
     }
 
+    /* Serve clients, process the standard input, the input files on a pool of workers, or each in turn */
+    if(opts.serve_path)
+        foundErr = runServer(&opts);
+    else if(isPipeMode(&opts))
+        foundErr = assemblePipe(&opts);
+    else if(opts.jobs > 1 && opts.file_count > 1)
+        foundErr = runJobPool(&opts);
+    else {
+        for(i = 0; i < opts.file_count; i++) {
+            if(opts.stats_list) setThreadStats(&opts.stats_list[i]);
+            if(opts.cache_dir ? assembleCached(opts.files[i], &opts) : preprocessor(opts.files[i], &opts))
+                foundErr = 1;
+        }
+    }
+
+    if(opts.stats_list) {
+        setThreadStats(NULL);
+        if(reportStats(&opts)) foundErr = 1;
+    }
+
+    trimBuildCache(&opts);
+    freeMacrTable(&macro_lib);
+    freeArena(&lib_mem);
+
+    freeOptions(&opts);
     return foundErr;
 }
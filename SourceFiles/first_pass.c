@@ -15,6 +15,7 @@
 #include <string.h>
 #include "macr.h"
 #include "label.h"
+#include "fixup.h"
 #include "preprocessor.h"
 #include "token_utils.h"
 #include "globals.h"
@@ -22,56 +23,87 @@
 #include "first_pass.h"
 #include "second_pass.h"
 #include "file_utils.h"
+#include "buffer_utils.h"
+#include "log_utils.h"
+#include "source_reader.h"
+#include "stats.h"
+#include "segment.h"
 
 /**
  * @brief Performs the first pass of the assembler.
  *
- * This function reads through the assembly file line by line, processing
+ * This function visits the lines of the expanded source in place, processing
  * labels, directives, and opcodes. It handles memory allocation, error checking,
- * and builds the label table and instruction/data memory. The first pass is
- * crucial for identifying and preparing for the second pass.
+ * and builds the label table and instruction/data memory. Instructions are encoded
+ * completely, except for the addresses of labels, which are recorded in a fixup
+ * table and patched by the second pass.
  *
  * @param file_name The name of the file to be processed (without extension).
  * @param macr_tb A pointer to the macro table.
+ * @param am A pointer to the expanded source produced by the preprocessor.
+ * @param mem A pointer to the arena of the file, which owns the labels.
+ * @param opts Pointer to the command-line options.
+ * @param outputs Pointer to the set collecting the output files in memory, or NULL to write them.
  * @return int Returns `EXIT_SUCCESS` if the first pass completes successfully,
  *         or `EXIT_FAILURE` if an error occurs.
  */
-int first_pass(char *file_name, macr_table *macr_tb) {
-    char line[MAX_LINE_SIZE + 1], str[MAX_LINE_SIZE + 1], *ptr;
-    unsigned short instructions[MEMORY_SIZE] = {0}, data[MEMORY_SIZE] = {0};
-    unsigned short *iptr = instructions, *dptr = data;
+int first_pass(char *file_name, macr_table *macr_tb, text_buffer *am, arena *mem, const assembler_options *opts,
+               output_set *outputs) {
+    char *ptr;
+    text_span str;
+    memory_segment instructions, data;
     int IC = 0, DC = 0, is_out_of_memory = 0, is_entry = 0, is_extern = 0;
-    int foundErr = EXIT_SUCCESS, line_counter = 0, extra_words;
+    int foundErr = EXIT_SUCCESS, line_counter = 0, extra_words, status;
+    int memory_size = opts->large_memory ? (int)LARGE_MEMORY_SIZE : MEMORY_SIZE;
     label_table label_tb;
+    fixup_table fixup_tb;
     label *lb = NULL;
-    opcode op;
-    FILE *fp;
+    const keywordMapping *kw;
+    keyword_kind kind;
+    source_text src;
+    line_view view;
+    int pos;
 
-    /* Initialize the label table */
-    initLabelTable(&label_tb);
+    enterPhase(PHASE_FIRST_PASS);
 
-    printf(">>> Started working on the file %s.am\n", file_name);
+    /* Initialize the label and fixup tables */
+    initLabelTable(&label_tb, mem);
+    label_tb.stats = getThreadStats();
+    initFixupTable(&fixup_tb, mem);
 
-    /* Open the preprocessed file with the ".am" suffix */
-    fp = open_file_with_suffix(file_name, ".am", "r", NULL, macr_tb, NULL, NULL, NULL);
+    /* The segments grow on the heap as the lines are encoded */
+    initSegment(&instructions, memory_size);
+    initSegment(&data, memory_size);
 
-    /* Process each line of the file */
-    while((ptr = fgets(line, MAX_LINE_SIZE + 1, fp))) {
+    logPrintf(">>> Started working on the file %s.am\n", file_name);
+
+    /* Index the lines of the expanded source, which are then visited in place */
+    if(indexSourceText(&src, am->data, am->len)) {
+        logErrorf("    %s\n", getError(ALLOC_FAILED));
+        foundErr = EXIT_FAILURE;
+        src.starts = NULL, src.line_count = 0, src.owns_data = 0;
+    }
+    view.text = NULL;
+
+    /* Process each line of the expanded source */
+    for(pos = 0; pos < src.line_count; closeLineView(&view), pos++) {
+        ptr = openLineView(&src, pos, MAX_LINE_SIZE, &view);
         line_counter++;
 
         /* Skip comment lines */
         if(*ptr == ';') continue;
 
-        /* Extract the first token from the line */
-        nextToken(str, &ptr, ' ');
-        if(!(*str)) continue;
+        /* Find the first token of the line, without copying it */
+        nextSpan(&str, &ptr, ' ');
+        if(!str.len) continue;
 
         /* Label found: check if the token ends with a colon */
-        if(str[strlen(str) - 1] == ':') {
-            str[strlen(str) - 1] = '\0';  /* Remove colon */
+        if(str.text[str.len - 1] == ':') {
+            str.len--;  /* Remove colon */
 
             lb = find_label(&label_tb, str);  /* Find if the label already exists */
-            if(lb && (lb->is_extern || lb->is_entry > 1)) {
+            if(lb && ((lb->attributes & LABEL_EXTERN) ||
+                      (lb->attributes & (LABEL_ENTRY | LABEL_DEFINED)) == (LABEL_ENTRY | LABEL_DEFINED))) {
                 printError(line_counter, MULTIPLE_MACRO_DEFINITIONS);
                 foundErr = EXIT_FAILURE;
                 lb = NULL;
@@ -79,21 +111,35 @@ int first_pass(char *file_name, macr_table *macr_tb) {
             }
 
             /* Parse the label and check for errors */
-            if(parseLabel(&label_tb, macr_tb, str, fp)) {
+            if((status = parseLabel(&label_tb, macr_tb, str))) {
+                foundErr = EXIT_FAILURE;
+                if(status == EXIT_ABORT) break;
                 printError(line_counter, INVALID_LABEL);
                 foundErr = EXIT_FAILURE;
                 continue;
             }
             lb = find_label(&label_tb, str);
-            nextToken(str, &ptr, ' ');
+            setLabelAttributes(&label_tb, lb, LABEL_DEFINED);
+            nextSpan(&str, &ptr, ' ');
         }
 
+        /* Classify the command with a single keyword lookup */
+        kw = get_keyword_span(str);
+        kind = kw ? kw->kind : KEYWORD_NONE;
+
         /* Check for data directives (e.g., .data, .string) */
-        if(!strcmp(str, ".data") || !strcmp(str, ".string")) {
-            if(!strcmp(str, ".data"))
-                extra_words = isLegalData(ptr, dptr, DC, line_counter);
+        if(kind == KEYWORD_DATA || kind == KEYWORD_STRING) {
+            /* A line holds fewer values or characters than it is long */
+            if(reserveSegment(&data, (long)DC + MAX_LINE_SIZE)) {
+                logErrorf("    %s\n", getError(ALLOC_FAILED));
+                foundErr = EXIT_FAILURE;
+                break;
+            }
+
+            if(kind == KEYWORD_DATA)
+                extra_words = isLegalData(ptr, &data, DC, line_counter);
             else
-                extra_words = isLegalString(ptr, dptr, DC, line_counter);
+                extra_words = isLegalString(ptr, &data, DC, line_counter);
 
             if(!extra_words) {
                 foundErr = EXIT_FAILURE;
@@ -102,55 +148,71 @@ int first_pass(char *file_name, macr_table *macr_tb) {
 
             /* Assign label to data section */
             if(lb) {
-                lb->address = DC;
-                lb->is_data = 1;
+                lb->segment = SEGMENT_DATA;
+                lb->offset = DC;
             }
-            DC += extra_words, dptr += extra_words, lb = NULL;
+            DC += extra_words, lb = NULL;
 
             /* Check for opcode instructions */
-        } else if((op = get_opcode(str)) != unknown_opcode) {
-            extra_words = isLegalOpcode(op, ptr, iptr, IC, line_counter, &label_tb, macr_tb);
+        } else if(kind == KEYWORD_OPCODE) {
+            if(reserveSegment(&instructions, (long)IC + MAX_INSTRUCTION_WORDS)) {
+                logErrorf("    %s\n", getError(ALLOC_FAILED));
+                foundErr = EXIT_FAILURE;
+                break;
+            }
+
+            extra_words = isLegalOpcode((opcode)kw->value, ptr, &instructions, IC, line_counter, &label_tb, macr_tb, &fixup_tb);
             if(!extra_words) {
                 foundErr = EXIT_FAILURE;
                 continue;
             }
 
             /* Assign label to instruction section */
-            if(lb)
-                lb->address = IC + 100;
-            IC += extra_words, iptr += extra_words, lb = NULL;
+            if(lb) {
+                lb->segment = SEGMENT_CODE;
+                lb->offset = IC;
+            }
+            IC += extra_words, lb = NULL;
 
             /* Handle .entry and .extern directives */
-        } else if(!strcmp(str, ".entry") || !strcmp(str, ".extern")) {
+        } else if(kind == KEYWORD_ENTRY || kind == KEYWORD_EXTERN) {
             if(lb)
                 delLabelFromTable(&label_tb, lb);
 
-            if(!strcmp(str, ".entry"))
+            if(kind == KEYWORD_ENTRY)
                 is_entry = 1;
             else
                 is_extern = 1;
 
-            nextToken(str, &ptr, ' ');
+            nextSpan(&str, &ptr, ' ');
             lb = find_label(&label_tb, str);
-            if(lb && (lb->is_entry || lb->is_extern || is_extern)) {
+            if(lb && ((lb->attributes & (LABEL_ENTRY | LABEL_EXTERN)) || is_extern)) {
                 printError(line_counter, MULTIPLE_MACRO_DEFINITIONS);
                 foundErr = EXIT_FAILURE;
                 continue;
             }
 
             /* Parse the label for entry/extern */
-            if(parseLabel(&label_tb, macr_tb, str, fp)) {
+            if((status = parseLabel(&label_tb, macr_tb, str))) {
+                foundErr = EXIT_FAILURE;
+                if(status == EXIT_ABORT) break;
                 printError(line_counter, INVALID_LABEL);
                 foundErr = EXIT_FAILURE;
                 continue;
             }
             lb = find_label(&label_tb, str);
-            lb->is_entry = is_entry, lb->is_extern = is_extern;
+            setLabelAttributes(&label_tb, lb, (is_entry ? LABEL_ENTRY : 0) | (is_extern ? LABEL_EXTERN : 0));
+
+            /* The label of an entry must be defined by the end of the file */
+            if(is_entry && addFixup(&fixup_tb, FIXUP_ENTRY, 0, str, line_counter)) {
+                logErrorf("    %s\n", getError(ALLOC_FAILED));
+                foundErr = EXIT_FAILURE;
+            }
             is_entry = 0, is_extern = 0, lb = NULL;
 
             /* Error for missing dot in directive */
-        } else if(!strcmp(str, "entry") || !strcmp(str, "extern") ||
-                  !strcmp(str, "data") || !strcmp(str, "string")) {
+        } else if(spanEquals(str, "entry") || spanEquals(str, "extern") ||
+                  spanEquals(str, "data") || spanEquals(str, "string")) {
             printError(line_counter, MISSING_DOT_IN_DIRECTIVE);
             foundErr = EXIT_FAILURE;
 
@@ -163,27 +225,38 @@ int first_pass(char *file_name, macr_table *macr_tb) {
         }
 
         /* Check for memory overflow */
-        if(IC + DC >= MEMORY_SIZE && !is_out_of_memory) {
-            printf("    %s\n", getError(MEMORY_OVERFLOW));
+        if(IC + DC >= memory_size && !is_out_of_memory) {
+            logPrintf("    %s\n", getError(MEMORY_OVERFLOW));
             is_out_of_memory = 1;
             foundErr = EXIT_FAILURE;
         }
     }
 
-    /* Adjust the address of data labels based on the instruction counter */
-    increaseDataLabelTableAddress(&label_tb, IC + 100);
+    closeLineView(&view);
+    freeSourceText(&src);
+
+    if(label_tb.stats) label_tb.stats->labels += label_tb.count;
+
+    /* The data segment follows the instructions */
+    setSegmentBases(&label_tb, 100, IC + 100);
 
     /* Free memory used by the macro table */
     freeMacrTable(macr_tb);
-    fclose(fp);
 
-    /* If an error was found, free label table and exit */
+    /* If an error was found, free label and fixup tables and exit */
     if(foundErr) {
-        printf(">>> Finished working on the file %s.am\n", file_name);
+        logPrintf(">>> Finished working on the file %s.am\n", file_name);
         freeLabelTable(&label_tb);
+        freeFixupTable(&fixup_tb);
+        freeSegment(&instructions);
+        freeSegment(&data);
         return EXIT_FAILURE;
     }
 
-    /* Proceed to the second pass */
-    return second_pass(file_name, &label_tb, instructions, data, DC);
+    /* Proceed to the second pass, which resolves the label references */
+    status = second_pass(file_name, &label_tb, &fixup_tb, instructions.words, data.words, IC, DC, opts,
+                         outputs);
+    freeSegment(&instructions);
+    freeSegment(&data);
+    return status;
 }
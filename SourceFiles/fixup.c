@@ -0,0 +1,74 @@
+/**
+ * @author Tal Figenblat
+ * @date October 17, 2026
+ *
+ * @file fixup.c
+ * @brief Contains functions for managing the label references resolved after the first pass.
+ *
+ * The fixups are stored in a growable array in source order, so resolving them in one sweep
+ * reports errors and writes external references in the same order as the source.
+ */
+
+#include <stdlib.h>
+#include "arena.h"
+#include "fixup.h"
+#include "stats.h"
+
+/**
+ * @brief Initializes an empty fixup table.
+ *
+ * @param tb Pointer to the fixup table.
+ * @param mem Pointer to the arena the label names are copied into.
+ */
+void initFixupTable(fixup_table *tb, arena *mem) {
+    tb->items = NULL;
+    tb->count = 0;
+    tb->size = 0;
+    tb->mem = mem;
+}
+
+/**
+ * @brief Appends a fixup to the table.
+ *
+ * @param tb Pointer to the fixup table.
+ * @param kind The kind of the reference.
+ * @param idx Index of the instruction word to patch (ignored for entries).
+ * @param name Name of the referenced label, as a span; the table keeps its own copy in its arena.
+ * @param line_counter Line of the reference.
+ * @return EXIT_SUCCESS if the fixup was added, EXIT_FAILURE if memory allocation failed.
+ */
+int addFixup(fixup_table *tb, fixup_kind kind, int idx, text_span name, int line_counter) {
+    fixup *items, *fx;
+    int size;
+
+    /* Grow the array geometrically when it is full */
+    if(tb->count == tb->size) {
+        size = tb->size ? tb->size * 2 : FIXUP_TABLE_INIT_SIZE;
+        items = (fixup *)realloc(tb->items, size * sizeof(fixup));
+        if(!items) return EXIT_FAILURE;
+        noteHeapAlloc(sizeof(fixup) * (size - tb->size));
+        tb->items = items;
+        tb->size = size;
+    }
+
+    fx = &tb->items[tb->count];
+    fx->name = arenaMemdup(tb->mem, name.text, name.len);
+    if(!fx->name) return EXIT_FAILURE;
+    fx->kind = kind;
+    fx->idx = idx;
+    fx->line_counter = line_counter;
+    tb->count++;
+
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Frees the memory of the fixup table that is not owned by its arena.
+ *
+ * @param tb Pointer to the fixup table.
+ */
+void freeFixupTable(fixup_table *tb) {
+    noteHeapFree(sizeof(fixup) * tb->size);
+    free(tb->items);
+    initFixupTable(tb, tb->mem);
+}
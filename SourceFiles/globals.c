@@ -5,11 +5,99 @@
  * @file globals.c
  * @brief This file contains functions to map strings to their corresponding opcodes,
  * and registers in an assembler.
+ *
+ * All the reserved words (opcodes, registers, "macr", "endmacr" and the directives) are kept
+ * in a static perfect hash table, so classifying a word costs one probe.
  */
 
 #include <string.h>
 #include "globals.h"
 
+/**
+ * @brief Perfect hash table of the reserved words, indexed by `hash_keyword`.
+ *
+ * Every reserved word has a slot of its own, so a lookup never has to probe further.
+ * The table must be kept in sync with `hash_keyword` when a word is added.
+ */
+static const keywordMapping keyword_table[KEYWORD_TABLE_SIZE] = {
+        /*  0 */ {"endmacr", KEYWORD_ENDMACR, 0}, {NULL, KEYWORD_NONE, 0}, {NULL, KEYWORD_NONE, 0}, {NULL, KEYWORD_NONE, 0},
+        /*  4 */ {NULL, KEYWORD_NONE, 0}, {NULL, KEYWORD_NONE, 0}, {"r1", KEYWORD_REGISTER, r1}, {NULL, KEYWORD_NONE, 0},
+        /*  8 */ {"r4", KEYWORD_REGISTER, r4}, {"jmp", KEYWORD_OPCODE, jmp}, {"r7", KEYWORD_REGISTER, r7}, {NULL, KEYWORD_NONE, 0},
+        /* 12 */ {NULL, KEYWORD_NONE, 0}, {NULL, KEYWORD_NONE, 0}, {NULL, KEYWORD_NONE, 0}, {NULL, KEYWORD_NONE, 0},
+        /* 16 */ {NULL, KEYWORD_NONE, 0}, {"cmp", KEYWORD_OPCODE, cmp}, {".entry", KEYWORD_ENTRY, 0}, {NULL, KEYWORD_NONE, 0},
+        /* 20 */ {NULL, KEYWORD_NONE, 0}, {NULL, KEYWORD_NONE, 0}, {"clr", KEYWORD_OPCODE, clr}, {"macr", KEYWORD_MACR, 0},
+        /* 24 */ {NULL, KEYWORD_NONE, 0}, {"inc", KEYWORD_OPCODE, inc}, {NULL, KEYWORD_NONE, 0}, {NULL, KEYWORD_NONE, 0},
+        /* 28 */ {"r2", KEYWORD_REGISTER, r2}, {NULL, KEYWORD_NONE, 0}, {"r5", KEYWORD_REGISTER, r5}, {NULL, KEYWORD_NONE, 0},
+        /* 32 */ {"add", KEYWORD_OPCODE, add}, {NULL, KEYWORD_NONE, 0}, {NULL, KEYWORD_NONE, 0}, {NULL, KEYWORD_NONE, 0},
+        /* 36 */ {NULL, KEYWORD_NONE, 0}, {NULL, KEYWORD_NONE, 0}, {".string", KEYWORD_STRING, 0}, {"not", KEYWORD_OPCODE, not},
+        /* 40 */ {"prn", KEYWORD_OPCODE, prn}, {"jsr", KEYWORD_OPCODE, jsr}, {"lea", KEYWORD_OPCODE, lea}, {NULL, KEYWORD_NONE, 0},
+        /* 44 */ {"stop", KEYWORD_OPCODE, stop}, {".data", KEYWORD_DATA, 0}, {NULL, KEYWORD_NONE, 0}, {".extern", KEYWORD_EXTERN, 0},
+        /* 48 */ {"r0", KEYWORD_REGISTER, r0}, {"mov", KEYWORD_OPCODE, mov}, {"r3", KEYWORD_REGISTER, r3}, {"bne", KEYWORD_OPCODE, bne},
+        /* 52 */ {"r6", KEYWORD_REGISTER, r6}, {"red", KEYWORD_OPCODE, red}, {NULL, KEYWORD_NONE, 0}, {NULL, KEYWORD_NONE, 0},
+        /* 56 */ {NULL, KEYWORD_NONE, 0}, {NULL, KEYWORD_NONE, 0}, {NULL, KEYWORD_NONE, 0}, {"sub", KEYWORD_OPCODE, sub},
+        /* 60 */ {"dec", KEYWORD_OPCODE, dec}, {NULL, KEYWORD_NONE, 0}, {NULL, KEYWORD_NONE, 0}, {"rts", KEYWORD_OPCODE, rts}
+};
+
+/**
+ * @brief Computes the slot of a word in the keyword table.
+ *
+ * The hash mixes the first, second and last characters of the word. The multipliers were
+ * chosen so that no two reserved words share a slot.
+ *
+ * @param str The word to hash.
+ * @param len The length of the word, at least 2.
+ * @return The slot of the word in the keyword table.
+ */
+int hash_keyword(const char *str, size_t len) {
+    return ((unsigned char)str[0] * 8 + (unsigned char)str[1] * 13 + (unsigned char)str[len - 1] * 9)
+           & (KEYWORD_TABLE_SIZE - 1);
+}
+
+/**
+ * @brief Looks up a reserved word in the perfect hash table of keywords.
+ *
+ * The table is collision-free, so every lookup costs a single probe and one string compare.
+ *
+ * @param str The string to look up.
+ * @return Pointer to the keyword mapping, or NULL if the string is not a reserved word.
+ */
+const keywordMapping *get_keyword(const char *str) {
+    text_span token;
+
+    token.text = str;
+    token.len = strlen(str);
+    return get_keyword_span(token);
+}
+
+/**
+ * @brief Looks up a token in the perfect hash table of keywords, without copying it.
+ *
+ * @param token The token to look up.
+ * @return Pointer to the keyword mapping, or NULL if the token is not a reserved word.
+ */
+const keywordMapping *get_keyword_span(text_span token) {
+    const keywordMapping *kw;
+
+    /* No reserved word is shorter than a register or longer than "endmacr" */
+    if(token.len < 2 || token.len > MAX_KEYWORD_SIZE) return NULL;
+
+    kw = &keyword_table[hash_keyword(token.text, token.len)];
+    if(kw->name && !strncmp(token.text, kw->name, token.len) && !kw->name[token.len])
+        return kw;
+    return NULL;
+}
+
+/**
+ * @brief Retrieves the class of a reserved word.
+ *
+ * @param str The string to classify.
+ * @return The class of the reserved word, or `KEYWORD_NONE` if the string is not reserved.
+ */
+keyword_kind get_keyword_kind(const char *str) {
+    const keywordMapping *kw = get_keyword(str);
+    return kw ? kw->kind : KEYWORD_NONE;
+}
+
 /**
  * @brief Retrieves the opcode corresponding to a given string.
  *
@@ -17,25 +105,10 @@
  * @return The corresponding opcode value, or `unknown_opcode` if not found.
  */
 opcode get_opcode(const char *str) {
-    size_t i;
-
-    /* Array of known opcodes and their string representations */
-    const opcodeMapping opcode_map[] = {
-            {"mov", mov}, {"cmp", cmp},
-            {"add", add}, {"sub", sub},
-            {"lea", lea}, {"clr", clr},
-            {"not", not}, {"inc", inc},
-            {"dec", dec}, {"jmp", jmp},
-            {"bne", bne}, {"red", red},
-            {"prn", prn}, {"jsr", jsr},
-            {"rts", rts}, {"stop", stop}
-    };
-
-    /* Iterate through the array to find the matching opcode */
-    for(i = 0; i < OPCODE_COUNT; ++i) {
-        if(!strcmp(str, opcode_map[i].name))
-            return opcode_map[i].value;
-    }
+    const keywordMapping *kw = get_keyword(str);
+
+    if(kw && kw->kind == KEYWORD_OPCODE)
+        return (opcode)kw->value;
 
     /* Return this value if the string does not match any opcode */
     return unknown_opcode;
@@ -48,22 +121,25 @@ opcode get_opcode(const char *str) {
  * @return The corresponding register value, or `unknown_register` if not found.
  */
 regis get_register(const char *str) {
-    size_t i;
-
-    /* Array of known registers and their string representations */
-    const registerMapping register_map[] = {
-            {"r0", r0}, {"r1", r1},
-            {"r2", r2}, {"r3", r3},
-            {"r4", r4}, {"r5", r5},
-            {"r6", r6}, {"r7", r7}
-    };
-
-    /* Iterate through the array to find the matching register */
-    for(i = 0; i < REGISTER_COUNT; ++i) {
-        if(!strcmp(str, register_map[i].name))
-            return register_map[i].value;
-    }
-
-    /* Return this value if the string does not match any register */
+    text_span token;
+
+    token.text = str;
+    token.len = strlen(str);
+    return get_register_span(token);
+}
+
+/**
+ * @brief Retrieves the register corresponding to a token, without copying it.
+ *
+ * @param token The token naming the register.
+ * @return The corresponding register value, or `unknown_register` if not found.
+ */
+regis get_register_span(text_span token) {
+    const keywordMapping *kw = get_keyword_span(token);
+
+    if(kw && kw->kind == KEYWORD_REGISTER)
+        return (regis)kw->value;
+
+    /* Return this value if the token does not match any register */
     return unknown_register;
 }
@@ -43,34 +43,34 @@ int countDigits(int num) {
  * @param line_counter The line number for error reporting.
  * @return The parsed integer value, or max + 1 if there is an error.
  */
-int parseInt(char *str, int min, int max, int line_counter) {
+int parseInt(text_span str, int min, int max, int line_counter) {
     int result = 0;
     int sign = 1;
+    size_t i = 0;
 
     /* Handling negative numbers */
-    if(*str == '+') str++;
-    else if(*str == '-') {
+    if(str.len && *str.text == '+') i++;
+    else if(str.len && *str.text == '-') {
         sign = -1;
-        str++;
+        i++;
     }
 
     /* Parsing positive numbers */
-    while(*str) {
+    for(; i < str.len; i++) {
         /* Checking if each character is a digit */
-        if(*str < '0' || *str > '9') {
+        if(str.text[i] < '0' || str.text[i] > '9') {
             printError(line_counter, NOT_INTEGER);
             return max + 1;
         }
 
         /* Converting character to integer and accumulating result */
-        result = result * 10 + (*str - '0');
+        result = result * 10 + (str.text[i] - '0');
 
         /* Checking if result is within the acceptable range */
         if(sign * result < min || sign * result > max) {
             printError(line_counter, NUMBER_OUT_OF_RANGE);
             return max + 1;
         }
-        str++;
     }
 
     return sign * result;
@@ -83,7 +83,7 @@ int parseInt(char *str, int min, int max, int line_counter) {
  * @param line_counter The line number for error reporting.
  * @return The parsed integer value, or DATA_MAX_VALUE + 1 if there is an error.
  */
-int parseDataInt(char *str, int line_counter) {
+int parseDataInt(text_span str, int line_counter) {
     return parseInt(str, DATA_MIN_VALUE, DATA_MAX_VALUE, line_counter);
 }
 
@@ -97,7 +97,8 @@ int parseDataInt(char *str, int line_counter) {
  * @param line_counter The line number for error reporting.
  * @return The parsed integer value, or INSTRUCTION_MAX_VALUE + 1 if there is an error.
  */
-int parseInstructionInt(char *str, int line_counter) {
-    if(*str != '#') return INSTRUCTION_MAX_VALUE + 1;
-    return parseInt(str + 1, INSTRUCTION_MIN_VALUE, INSTRUCTION_MAX_VALUE, line_counter);
+int parseInstructionInt(text_span str, int line_counter) {
+    if(!str.len || *str.text != '#') return INSTRUCTION_MAX_VALUE + 1;
+    str.text++, str.len--;
+    return parseInt(str, INSTRUCTION_MIN_VALUE, INSTRUCTION_MAX_VALUE, line_counter);
 }
@@ -0,0 +1,116 @@
+/**
+ * @author Tal Figenblat
+ * @date October 17, 2026
+ *
+ * @file job_pool.c
+ * @brief Contains functions for assembling several files in parallel on a pool of worker threads.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include "preprocessor.h"
+#include "errors_handling.h"
+#include "log_utils.h"
+#include "job_pool.h"
+#include "build_cache.h"
+#include "stats.h"
+
+/**
+ * @brief Assembles files taken from the pool until no file is left.
+ *
+ * @param arg Pointer to the job pool.
+ * @return NULL.
+ */
+void *runJobWorker(void *arg) {
+    job_pool *pool = (job_pool *)arg;
+    int i, result;
+
+    while(1) {
+        /* Take the next file */
+        pthread_mutex_lock(&pool->lock);
+        i = pool->next < pool->opts->file_count ? pool->next++ : -1;
+        pthread_mutex_unlock(&pool->lock);
+        if(i < 0) break;
+
+        /* Assemble it, collecting its messages in its own log */
+        setThreadLog(&pool->logs[i]);
+        setThreadStats(pool->opts->stats_list ? &pool->opts->stats_list[i] : NULL);
+        if(pool->opts->cache_dir)
+            result = assembleCached(pool->opts->files[i], pool->opts);
+        else
+            result = preprocessor(pool->opts->files[i], pool->opts);
+        setThreadLog(NULL);
+        setThreadStats(NULL);
+
+        pthread_mutex_lock(&pool->lock);
+        pool->results[i] = result;
+        pool->done[i] = 1;
+        pthread_cond_broadcast(&pool->file_done);
+        pthread_mutex_unlock(&pool->lock);
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Assembles the files given in the options on up to `opts->jobs` worker threads.
+ *
+ * @param opts Pointer to the options, holding the files to assemble.
+ * @return int Returns 1 if errors were found in any file, otherwise returns 0.
+ */
+int runJobPool(const assembler_options *opts) {
+    int i, count = opts->file_count, workers = 0, foundErr = 0;
+    int thread_count = opts->jobs < count ? opts->jobs : count;
+    pthread_t *threads;
+    job_pool pool;
+
+    pool.opts = opts;
+    pool.next = 0;
+    pool.logs = (file_log *)malloc(sizeof(file_log) * count);
+    pool.results = (int *)calloc(count, sizeof(int));
+    pool.done = (int *)calloc(count, sizeof(int));
+    threads = (pthread_t *)malloc(sizeof(pthread_t) * thread_count);
+
+    if(!pool.logs || !pool.results || !pool.done || !threads || initThreadLogs()) {
+        fprintf(stderr, "%s\n", getError(ALLOC_FAILED));
+        free(pool.logs);
+        free(pool.results);
+        free(pool.done);
+        free(threads);
+        return 1;
+    }
+
+    for(i = 0; i < count; i++)
+        initFileLog(&pool.logs[i]);
+    pthread_mutex_init(&pool.lock, NULL);
+    pthread_cond_init(&pool.file_done, NULL);
+
+    /* Start the workers; if none could be started, assemble the files on this thread */
+    while(workers < thread_count && !pthread_create(&threads[workers], NULL, runJobWorker, &pool))
+        workers++;
+    if(!workers) runJobWorker(&pool);
+
+    /* Print the log of each file in command-line order, as soon as it is done */
+    for(i = 0; i < count; i++) {
+        pthread_mutex_lock(&pool.lock);
+        while(!pool.done[i])
+            pthread_cond_wait(&pool.file_done, &pool.lock);
+        pthread_mutex_unlock(&pool.lock);
+
+        flushFileLog(&pool.logs[i]);
+        freeFileLog(&pool.logs[i]);
+        if(pool.results[i]) foundErr = 1;
+    }
+
+    for(i = 0; i < workers; i++)
+        pthread_join(threads[i], NULL);
+
+    pthread_cond_destroy(&pool.file_done);
+    pthread_mutex_destroy(&pool.lock);
+    free(pool.logs);
+    free(pool.results);
+    free(pool.done);
+    free(threads);
+    return foundErr;
+}
@@ -15,14 +15,35 @@
 #include "macr.h"
 #include "globals.h"
 #include "errors_handling.h"
+#include "log_utils.h"
+#include "stats.h"
 
 /**
  * @brief Initializes the label table by setting the head to NULL.
  *
+ * The hash index is allocated lazily when the first label is added.
+ *
  * @param tb Pointer to the label_table to be emptied.
+ * @param mem Pointer to the arena the labels are allocated from.
  */
-void initLabelTable(label_table *tb) {
+void initLabelTable(label_table *tb, arena *mem) {
+    int i;
+
     tb->head = NULL;
+    tb->tail = NULL;
+    tb->entry_head = NULL;
+    tb->entry_tail = NULL;
+    tb->extern_head = NULL;
+    tb->extern_tail = NULL;
+    tb->index = NULL;
+    tb->size = 0;
+    tb->count = 0;
+    tb->entry_count = 0;
+    tb->extern_count = 0;
+    for(i = 0; i < SEGMENT_COUNT; i++)
+        tb->bases[i] = 0;
+    tb->mem = mem;
+    tb->stats = NULL;
 }
 
 /**
@@ -32,13 +53,56 @@ void initLabelTable(label_table *tb) {
  * @return Pointer to the last label in the table, or NULL if the table is empty.
  */
 label *getLabelTail(label_table *tb) {
-    label *ptr = tb->head;
+    return tb->tail;
+}
+
+/**
+ * @brief Finds the slot of a name in the hash index of the label table.
+ *
+ * Probes linearly from the home slot of the name until the name or an empty slot is found.
+ *
+ * @param tb Pointer to the label_table, whose index must be allocated.
+ * @param name Name of the label to look for.
+ * @return The slot holding the label with the given name, or the empty slot where it would be inserted.
+ */
+int findLabelSlot(label_table *tb, text_span name) {
+    int mask = tb->size - 1;
+    int i = (int)(hash_span(name) & mask);
+
+    COUNT_STAT(tb->stats, label_probes, 1);
+    while(tb->index[i] && !spanEquals(name, tb->index[i]->name)) {
+        i = (i + 1) & mask;
+        COUNT_STAT(tb->stats, label_probes, 1);
+    }
+    return i;
+}
+
+/**
+ * @brief Rebuilds the hash index of the label table with a new number of slots.
+ *
+ * @param tb Pointer to the label_table.
+ * @param size The new number of slots (a power of two).
+ * @return EXIT_SUCCESS if the index was rebuilt, EXIT_FAILURE if memory allocation failed.
+ */
+int resizeLabelIndex(label_table *tb, int size) {
+    label **old_index = tb->index;
+    label *ptr;
 
-    if(!ptr) return NULL;
+    tb->index = (label **)calloc(size, sizeof(label *));
+    if(!tb->index) {
+        tb->index = old_index;
+        return EXIT_FAILURE;
+    }
+    noteHeapAlloc(sizeof(label *) * size);
+    if(old_index) noteHeapFree(sizeof(label *) * tb->size);
+    tb->size = size;
 
-    /* Traverse the list to find the tail label */
-    while(ptr->next) ptr = ptr->next;
-    return ptr;
+    /* Re-insert every label, in definition order */
+    for(ptr = tb->head; ptr; ptr = ptr->next)
+        tb->index[findLabelSlot(tb, makeSpan(ptr->name))] = ptr;
+
+    free(old_index);
+    return EXIT_SUCCESS;
 }
 
 /**
@@ -46,13 +110,80 @@ label *getLabelTail(label_table *tb) {
  *
  * @param tb Pointer to the label_table.
  * @param ptr Pointer to the label to be added.
+ * @return EXIT_SUCCESS if the label was added, EXIT_FAILURE if the hash index could not be grown.
  */
-void addToLabelTable(label_table *tb, label *ptr) {
-    label *tmp = getLabelTail(tb);
+int addToLabelTable(label_table *tb, label *ptr) {
+    /* Keep the load factor of the index at most 3/4 */
+    if(!tb->index) {
+        if(resizeLabelIndex(tb, LABEL_INDEX_INIT_SIZE)) return EXIT_FAILURE;
+    } else if((tb->count + 1) * 4 > tb->size * 3) {
+        if(resizeLabelIndex(tb, tb->size * 2)) return EXIT_FAILURE;
+    }
 
     /* If the table is empty, set the new label as the head */
-    if(!tmp) tb->head = ptr;
-    else tmp->next = ptr; /* Otherwise, add the new label at the end of the list */
+    if(!tb->tail) tb->head = ptr;
+    else tb->tail->next = ptr; /* Otherwise, add the new label at the end of the list */
+    tb->tail = ptr;
+
+    tb->index[findLabelSlot(tb, makeSpan(ptr->name))] = ptr;
+    tb->count++;
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Removes a label from the hash index of the label table.
+ *
+ * The entries following the removed one in its probe sequence are shifted back,
+ * so lookups never need tombstones.
+ *
+ * @param tb Pointer to the label_table.
+ * @param lb Pointer to the label to be removed.
+ */
+void delLabelFromIndex(label_table *tb, label *lb) {
+    int mask = tb->size - 1;
+    int i = findLabelSlot(tb, makeSpan(lb->name)), j = i, home;
+
+    tb->index[i] = NULL;
+    while(tb->index[j = (j + 1) & mask]) {
+        home = (int)(hash_name(tb->index[j]->name) & mask);
+
+        /* Move the entry into the hole unless its home slot lies cyclically in (i, j] */
+        if((i <= j) ? (home <= i || home > j) : (home <= i && home > j)) {
+            tb->index[i] = tb->index[j];
+            tb->index[j] = NULL;
+            i = j;
+        }
+    }
+}
+
+/**
+ * @brief Appends a label to the list of entry labels or to the list of external labels.
+ *
+ * @param head Pointer to the head of the list.
+ * @param tail Pointer to the tail of the list.
+ * @param lb Pointer to the label.
+ */
+static void appendListed(label **head, label **tail, label *lb) {
+    if(!*tail) *head = lb;
+    else (*tail)->next_listed = lb;
+    *tail = lb;
+}
+
+/**
+ * @brief Removes a label from the list of entry labels or from the list of external labels.
+ *
+ * @param head Pointer to the head of the list.
+ * @param tail Pointer to the tail of the list.
+ * @param lb Pointer to the label, which must be in the list.
+ */
+static void unlinkListed(label **head, label **tail, label *lb) {
+    label *prev = NULL, *ptr;
+
+    for(ptr = *head; ptr != lb; ptr = ptr->next_listed)
+        prev = ptr;
+    if(prev) prev->next_listed = lb->next_listed;
+    else *head = lb->next_listed;
+    if(*tail == lb) *tail = prev;
 }
 
 /**
@@ -64,54 +195,99 @@ void addToLabelTable(label_table *tb, label *ptr) {
 void delLabelFromTable(label_table *tb, label *lb) {
     label *ptr = tb->head;
 
+    delLabelFromIndex(tb, lb);
+    tb->count--;
+
+    /* Unlink the label from the list of its attribute as well */
+    if(lb->attributes & LABEL_EXTERN) {
+        unlinkListed(&tb->extern_head, &tb->extern_tail, lb);
+        tb->extern_count--;
+    }
+    if(lb->attributes & LABEL_ENTRY) {
+        unlinkListed(&tb->entry_head, &tb->entry_tail, lb);
+        tb->entry_count--;
+    }
+
     /* Handle case where the label to be deleted is the head of the list */
     if(ptr == lb) {
         tb->head = lb->next;
-        free(lb->name);
-        free(lb);
+        if(tb->tail == lb) tb->tail = NULL;
         return;
     }
     /* Traverse the list to find the label to be deleted */
     while(ptr->next != lb) ptr = ptr->next;
 
     ptr->next = lb->next;
-    free(lb->name);
-    free(lb);
+    if(tb->tail == lb) tb->tail = ptr;
 }
 
 /**
- * @brief Increases the address of data labels by a specified number.
+ * @brief Adds attributes to a label, keeping the counters and the entry and extern lists of the table.
  *
  * @param tb Pointer to the label_table.
- * @param num Number by which to increase the addresses.
+ * @param lb Pointer to the label.
+ * @param attributes The LABEL_ENTRY, LABEL_EXTERN and LABEL_DEFINED bits to add.
  */
-void increaseDataLabelTableAddress(label_table *tb, int num) {
-    label *ptr = tb->head;
+void setLabelAttributes(label_table *tb, label *lb, int attributes) {
+    attributes &= ~lb->attributes;
+    lb->attributes |= attributes;
 
-    /* Traverse the list and update addresses for data labels */
-    while(ptr) {
-        if(ptr->is_data)
-            ptr->address += num;
-        ptr = ptr->next;
+    /* Labels are marked when they are added, so the lists keep declaration order */
+    if(attributes & LABEL_EXTERN) {
+        lb->segment = SEGMENT_EXTERN;
+        lb->offset = 0;
+        appendListed(&tb->extern_head, &tb->extern_tail, lb);
+        tb->extern_count++;
+    }
+    if(attributes & LABEL_ENTRY) {
+        appendListed(&tb->entry_head, &tb->entry_tail, lb);
+        tb->entry_count++;
     }
 }
 
 /**
- * @brief Frees all memory allocated for the label table.
+ * @brief Sets the addresses of the segments, once the sizes of the instructions are known.
+ *
+ * The external labels are numbered at the same time, in the order they were declared.
+ *
+ * @param tb Pointer to the label_table.
+ * @param code_base Address of the first instruction word.
+ * @param data_base Address of the first data word.
+ */
+void setSegmentBases(label_table *tb, int code_base, int data_base) {
+    label *ptr;
+    int id = 0;
+
+    for(ptr = tb->extern_head; ptr; ptr = ptr->next_listed)
+        ptr->extern_id = id++;
+    tb->bases[SEGMENT_NONE] = 0;
+    tb->bases[SEGMENT_CODE] = code_base;
+    tb->bases[SEGMENT_DATA] = data_base;
+    tb->bases[SEGMENT_EXTERN] = 0;
+}
+
+/**
+ * @brief Returns the address of a label, from its segment and offset.
+ *
+ * @param tb Pointer to the label_table, whose segment addresses are set.
+ * @param lb Pointer to the label.
+ * @return The address of the label, or 0 if it is external or not defined.
+ */
+int labelAddress(const label_table *tb, const label *lb) {
+    return tb->bases[lb->segment] + lb->offset;
+}
+
+/**
+ * @brief Frees the memory of the label table that is not owned by its arena.
+ *
+ * The labels themselves are released together with the arena.
  *
  * @param tb Pointer to the label_table to be freed.
  */
 void freeLabelTable(label_table *tb) {
-    label *ptr, *tmp;
-
-    ptr = tb->head;
-    while(ptr) {
-        tmp = ptr;
-        ptr = ptr->next;
-        if(tmp->name)
-            free(tmp->name);
-        free(tmp);
-    }
+    if(tb->index) noteHeapFree(sizeof(label *) * tb->size);
+    free(tb->index);
+    initLabelTable(tb, tb->mem);
 }
 
 /**
@@ -121,16 +297,12 @@ void freeLabelTable(label_table *tb) {
  * @param name Name of the label to find.
  * @return Pointer to the label if found, or NULL if not found.
  */
-label *find_label(label_table *tb, char *name) {
-    label *ptr = tb->head;
+label *find_label(label_table *tb, text_span name) {
+    COUNT_STAT(tb->stats, label_lookups, 1);
+    if(!tb->index) return NULL;
 
-    /* Traverse the list to find the label with the given name */
-    while(ptr) {
-        if(!strcmp(name, ptr->name))
-            return ptr;
-        ptr = ptr->next;
-    }
-    return NULL;
+    /* Look the name up in the hash index */
+    return tb->index[findLabelSlot(tb, name)];
 }
 
 /**
@@ -144,74 +316,67 @@ label *find_label(label_table *tb, char *name) {
  * @param name Name of the label to check.
  * @return 1 if the name is legal, 0 otherwise.
  */
-int isLegalLabelName(label_table *label_tb, macr_table *macr_tb, char *name) {
-    opcode op = get_opcode(name);
-    regis rg = get_register(name);
-    label *lb = find_label(label_tb, name);
-    macr *mcr = find_macr(macr_tb, name);
+int isLegalLabelName(label_table *label_tb, macr_table *macr_tb, text_span name) {
     return  isLegalName(name) &&
-            strcmp(name, "macr") != 0 &&
-            strcmp(name, "endmacr") != 0 &&
-            (op == unknown_opcode) &&
-            (rg == unknown_register) &&
-            (lb == NULL) &&
-            (mcr == NULL);
+            (get_keyword_span(name) == NULL) &&  /* Not an opcode, register, "macr" or "endmacr" */
+            (find_label(label_tb, name) == NULL) &&
+            (find_macr(macr_tb, name) == NULL);
 }
 
 /**
  * @brief Parses and adds a label to the label table if valid.
  *
- * This function checks if the label already exists as an entry label. If it does, it increments
- * the entry count. If the label is not legal, it returns failure. Otherwise, it allocates memory
- * for a new label, initializes its fields, and adds it to the label table.
+ * This function checks if the label already exists as an entry label whose definition was not
+ * seen yet. If it does, the definition belongs to that label. If the label is not legal, it
+ * returns failure. Otherwise, it allocates memory for a new label from the arena of the table,
+ * initializes its fields, and adds it to the label table.
  *
  * @param label_tb Pointer to the label_table where the label will be added.
  * @param macr_tb Pointer to the macro_table used for checking label legality.
- * @param str Name of the label to parse.
- * @param fp File pointer for error handling and cleanup.
- * @return EXIT_SUCCESS if the label was successfully parsed and added, EXIT_FAILURE otherwise.
+ * @param str Name of the label to parse, as a span of the source line.
+ * @return EXIT_SUCCESS if the label was successfully parsed and added, EXIT_FAILURE if it is not legal,
+ *         or EXIT_ABORT if memory allocation failed.
  */
-int parseLabel(label_table *label_tb, macr_table *macr_tb, char *str, FILE *fp) {
+int parseLabel(label_table *label_tb, macr_table *macr_tb, text_span str) {
     /* Check if the label already exists and is marked as an entry */
     label *lb = find_label(label_tb, str);
-    if(lb && lb->is_entry == 1) {
-        lb->is_entry++;
+    if(lb && (lb->attributes & (LABEL_ENTRY | LABEL_DEFINED)) == LABEL_ENTRY) {
+        lb->attributes |= LABEL_DEFINED;
         return EXIT_SUCCESS;
     }
 
     /* Validate if the label name is legal */
     if(!isLegalLabelName(label_tb, macr_tb, str)) return EXIT_FAILURE;
 
-    lb = (label *)malloc(sizeof(label));
+    lb = (label *)arenaAlloc(label_tb->mem, sizeof(label));
     if(!lb) {
         /* Handle memory allocation failure */
-        fprintf(stderr, "    %s\n", getError(ALLOC_FAILED));
-        freeMacrTable(macr_tb);
-        freeLabelTable(label_tb);
-        fclose(fp);
-        exit(EXIT_FAILURE);
+        logErrorf("    %s\n", getError(ALLOC_FAILED));
+        return EXIT_ABORT;
     }
 
     /* Initialize label fields */
-    lb->address = 0;
-    lb->is_data = 0;
-    lb->is_extern = 0;
-    lb->is_entry = 0;
+    lb->segment = SEGMENT_NONE;
+    lb->offset = 0;
+    lb->attributes = 0;
+    lb->extern_id = -1;
     lb->next = NULL;
+    lb->next_listed = NULL;
 
     /* Duplicate the label name */
-    lb->name = my_strdup(str);
+    lb->name = arenaMemdup(label_tb->mem, str.text, str.len);
     if(!(lb->name)) {
         /* Handle failure to duplicate the label name */
-        fprintf(stderr, "    %s\n", getError(ALLOC_FAILED));
-        freeMacrTable(macr_tb);
-        freeLabelTable(label_tb);
-        fclose(fp);
-        exit(EXIT_FAILURE);
+        logErrorf("    %s\n", getError(ALLOC_FAILED));
+        return EXIT_ABORT;
     }
 
     /* Add the new label to the label table */
-    addToLabelTable(label_tb, lb);
+    if(addToLabelTable(label_tb, lb)) {
+        /* Handle failure to grow the hash index */
+        logErrorf("    %s\n", getError(ALLOC_FAILED));
+        return EXIT_ABORT;
+    }
 
     return EXIT_SUCCESS;
 }
@@ -222,34 +387,6 @@ int parseLabel(label_table *label_tb, macr_table *macr_tb, char *str, FILE *fp)
  * @param label_tb Pointer to the label_table.
  * @return 1 if there is at least one entry label, 0 otherwise.
  */
-int has_entry_label(label_table *label_tb) {
-    label *ptr = label_tb->head;
-
-    /* Traverse the list to check for entry labels */
-    while(ptr) {
-        if(ptr->is_entry)
-            return 1;
-        ptr = ptr->next;
-    }
-
-    return 0;
-}
-
-/**
- * @brief Checks if there are any labels with the extern flag set.
- *
- * @param label_tb Pointer to the label_table.
- * @return 1 if there is at least one extern label, 0 otherwise.
- */
-int has_extern_label(label_table *label_tb) {
-    label *ptr = label_tb->head;
-
-    /* Traverse the list to check for extern labels */
-    while(ptr) {
-        if(ptr->is_extern > 1)
-            return 1;
-        ptr = ptr->next;
-    }
-
-    return 0;
+int has_entry_label(const label_table *label_tb) {
+    return label_tb->entry_count > 0;
 }
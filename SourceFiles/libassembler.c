@@ -0,0 +1,194 @@
+/**
+ * @author Tal Figenblat
+ * @date October 17, 2026
+ *
+ * @file libassembler.c
+ * @brief Contains the functions for embedding the assembler in another program.
+ *
+ * Each source goes through the same preprocessor and passes as a file given on the command line,
+ * with its source given in memory, its outputs collected in an output set, and its messages and
+ * errors collected in a file log attached to the calling thread for the duration of the call.
+ * The entries and externals are taken from the labels the second pass kept in the output set,
+ * and no object file is formatted unless its text is asked for.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "preprocessor.h"
+#include "errors_handling.h"
+#include "log_utils.h"
+#include "output_writer.h"
+#include "libassembler.h"
+
+/**
+ * @def ASM_SOURCE_NAME
+ * @brief Name of a source held in memory, as it appears in the messages.
+ */
+#define ASM_SOURCE_NAME "buffer"
+
+/**
+ * @struct asm_context
+ * @brief The context of the assembler, holding the memory reused across sources.
+ */
+struct asm_context {
+    assembler_options opts;       /**< The options every source is assembled with. */
+    file_log log;                 /**< The messages and errors of the current source. */
+    output_set outputs;           /**< The outputs of the current source. */
+    asm_symbol *symbols;          /**< The entry labels followed by the uses of external labels. */
+    int symbol_size;              /**< Capacity of the symbols array. */
+    asm_diagnostic *diagnostics;  /**< The errors of the current source, with their messages. */
+    int diagnostic_size;          /**< Capacity of the diagnostics array. */
+};
+
+/**
+ * @brief Creates a context of the assembler.
+ *
+ * @return The context, or NULL if memory allocation failed.
+ */
+asm_context *asm_context_create(void) {
+    asm_context *ctx;
+
+    if(initThreadLogs()) return NULL;
+    ctx = (asm_context *)malloc(sizeof(asm_context));
+    if(!ctx) return NULL;
+
+    /* Neither the expanded source nor the text of the object files is needed by the caller */
+    initOptions(&ctx->opts);
+    ctx->opts.emit_am = 0;
+    ctx->opts.object_format = OBJECT_NONE;
+
+    initFileLog(&ctx->log);
+    ctx->log.keep_diagnostics = 1;
+    initOutputSet(&ctx->outputs);
+    ctx->outputs.keep_symbols = 1;
+    ctx->symbols = NULL;
+    ctx->symbol_size = 0;
+    ctx->diagnostics = NULL;
+    ctx->diagnostic_size = 0;
+    return ctx;
+}
+
+/**
+ * @brief Selects whether the content of the ".ob" file is returned with each result.
+ *
+ * @param ctx The context.
+ * @param keep Nonzero to return the content of the ".ob" file, 0 not to.
+ */
+void asm_context_keep_object_text(asm_context *ctx, int keep) {
+    ctx->opts.object_format = keep ? OBJECT_TEXT : OBJECT_NONE;
+}
+
+/**
+ * @brief Grows an array of the context so it holds at least a number of items.
+ *
+ * @param array Pointer to the array.
+ * @param size Pointer to the capacity of the array, in items.
+ * @param count The number of items needed.
+ * @param item_size Size of an item, in bytes.
+ * @return EXIT_SUCCESS if the array is large enough, EXIT_FAILURE if memory allocation failed.
+ */
+static int reserveContextArray(void **array, int *size, int count, size_t item_size) {
+    void *grown;
+
+    if(count <= *size) return EXIT_SUCCESS;
+    grown = realloc(*array, item_size * count);
+    if(!grown) return EXIT_FAILURE;
+    *array = grown;
+    *size = count;
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Assembles a source held in memory.
+ *
+ * @param ctx The context.
+ * @param src The source, which does not have to be null-terminated.
+ * @param len Length of the source, in bytes.
+ * @param result Pointer to the result to fill, which is filled even when errors were found.
+ * @return 0 if the source was assembled without errors, 1 otherwise.
+ */
+int assemble_buffer(asm_context *ctx, const char *src, size_t len, asm_result *result) {
+    char name[] = ASM_SOURCE_NAME;
+    file_log *outer = getThreadLog();
+    int i, status, symbol_count;
+    void *array;
+
+    /* Start from an empty log and empty outputs, keeping their memory */
+    clearFileLog(&ctx->log);
+    clearOutputSet(&ctx->outputs);
+
+    setThreadLog(&ctx->log);
+    status = preprocessSource(name, &ctx->opts, src ? src : "", src ? len : 0, &ctx->outputs) != EXIT_SUCCESS;
+    setThreadLog(outer);
+
+    /* Point the entries and externals at their names, and attach the messages to the diagnostics */
+    symbol_count = ctx->outputs.entry_count + ctx->outputs.extern_count;
+    array = ctx->symbols;
+    if(reserveContextArray(&array, &ctx->symbol_size, symbol_count, sizeof(asm_symbol))) {
+        status = 1;
+        ctx->outputs.entry_count = ctx->outputs.extern_count = symbol_count = 0;
+    }
+    ctx->symbols = (asm_symbol *)array;
+    for(i = 0; i < symbol_count; i++) {
+        ctx->symbols[i].name = ctx->outputs.names.data + ctx->outputs.symbols[i].name;
+        ctx->symbols[i].address = ctx->outputs.symbols[i].address;
+    }
+
+    array = ctx->diagnostics;
+    if(reserveContextArray(&array, &ctx->diagnostic_size, ctx->log.diagnostic_count, sizeof(asm_diagnostic))) {
+        status = 1;
+        ctx->log.diagnostic_count = 0;
+    }
+    ctx->diagnostics = (asm_diagnostic *)array;
+    for(i = 0; i < ctx->log.diagnostic_count; i++) {
+        ctx->diagnostics[i].line = ctx->log.diagnostics[i].line;
+        ctx->diagnostics[i].code = ctx->log.diagnostics[i].code;
+        ctx->diagnostics[i].message = getError(ctx->log.diagnostics[i].code);
+    }
+    if(ctx->log.failed || ctx->log.err.len) status = 1;
+
+    result->status = status;
+    result->words = ctx->outputs.words;
+    result->ic = ctx->outputs.ic;
+    result->dc = ctx->outputs.dc;
+    result->entries = ctx->symbols;
+    result->entry_count = ctx->outputs.entry_count;
+    result->externals = ctx->symbols + ctx->outputs.entry_count;
+    result->extern_count = ctx->outputs.extern_count;
+    result->diagnostics = ctx->diagnostics;
+    result->diagnostic_count = ctx->log.diagnostic_count;
+    result->messages = ctx->log.out.data ? ctx->log.out.data : "";
+    result->messages_len = ctx->log.out.len;
+    result->object = ctx->outputs.present[OUTPUT_OB] && ctx->outputs.files[OUTPUT_OB].data ?
+                     ctx->outputs.files[OUTPUT_OB].data : "";
+    result->object_len = ctx->outputs.present[OUTPUT_OB] ? ctx->outputs.files[OUTPUT_OB].len : 0;
+    return status;
+}
+
+/**
+ * @brief Releases the memory the context kept from earlier sources, keeping the context usable.
+ *
+ * @param ctx The context.
+ */
+void asm_context_reset(asm_context *ctx) {
+    freeFileLog(&ctx->log);
+    ctx->log.keep_diagnostics = 1;
+    freeOutputSet(&ctx->outputs);
+    free(ctx->symbols);
+    free(ctx->diagnostics);
+    ctx->symbols = NULL;
+    ctx->symbol_size = 0;
+    ctx->diagnostics = NULL;
+    ctx->diagnostic_size = 0;
+}
+
+/**
+ * @brief Destroys a context of the assembler.
+ *
+ * @param ctx The context, or NULL.
+ */
+void asm_context_destroy(asm_context *ctx) {
+    if(!ctx) return;
+    asm_context_reset(ctx);
+    free(ctx);
+}
@@ -0,0 +1,422 @@
+/**
+ * @author Tal Figenblat
+ * @date October 17, 2026
+ *
+ * @file linker.c
+ * @brief Contains functions for linking several assembled objects into a single memory image.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "linker.h"
+#include "macr.h"
+#include "opcode_utils.h"
+#include "file_utils.h"
+#include "errors_handling.h"
+
+/**
+ * @brief A step of the linker run on each object.
+ */
+typedef void (*link_step)(linker *lk, int i);
+
+/**
+ * @struct link_phase
+ * @brief Holds a step run on every object by the worker threads.
+ */
+typedef struct {
+    linker *lk;     /**< The linker. */
+    link_step step; /**< The step. */
+} link_phase;
+
+/**
+ * @brief Initializes a linker for a list of objects.
+ *
+ * @param lk Pointer to the linker.
+ * @param names The names of the objects (without extension), in link order.
+ * @param count Number of objects.
+ * @param jobs Largest number of worker threads.
+ * @param limit Largest number of words of the image.
+ * @return EXIT_SUCCESS if the linker was initialized, EXIT_FAILURE if memory allocation failed.
+ */
+int initLinker(linker *lk, char **names, int count, int jobs, long limit) {
+    int i;
+
+    memset(lk, 0, sizeof(*lk));
+    lk->jobs = jobs;
+    lk->limit = limit;
+    if(!(lk->objects = (link_object *)calloc(count + 1, sizeof(link_object)))) return EXIT_FAILURE;
+
+    lk->object_count = count;
+    for(i = 0; i < count; i++) {
+        lk->objects[i].name = names[i];
+        initTextBuffer(&lk->objects[i].buf);
+        initFileLog(&lk->objects[i].log);
+    }
+    pthread_mutex_init(&lk->lock, NULL);
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Runs a step on objects taken from the linker until no object is left.
+ *
+ * This is the body of each worker thread. The messages of each object are collected in its log.
+ *
+ * @param arg Pointer to the phase.
+ * @return NULL.
+ */
+static void *runLinkWorker(void *arg) {
+    link_phase *phase = (link_phase *)arg;
+    linker *lk = phase->lk;
+    int i;
+
+    while(1) {
+        pthread_mutex_lock(&lk->lock);
+        i = lk->next < lk->object_count ? lk->next++ : -1;
+        pthread_mutex_unlock(&lk->lock);
+        if(i < 0) break;
+
+        setThreadLog(&lk->objects[i].log);
+        phase->step(lk, i);
+        setThreadLog(NULL);
+    }
+    return NULL;
+}
+
+/**
+ * @brief Runs a step on every object, on up to `lk->jobs` worker threads.
+ *
+ * @param lk Pointer to the linker.
+ * @param step The step.
+ */
+static void runLinkPhase(linker *lk, link_step step) {
+    int i, workers = 0, thread_count = lk->jobs < lk->object_count ? lk->jobs : lk->object_count;
+    pthread_t *threads = NULL;
+    link_phase phase;
+
+    phase.lk = lk;
+    phase.step = step;
+    lk->next = 0;
+
+    /* Start the workers; if none could be started, run the step on this thread */
+    if(thread_count > 1 && (threads = (pthread_t *)malloc(sizeof(pthread_t) * thread_count))) {
+        while(workers < thread_count && !pthread_create(&threads[workers], NULL, runLinkWorker, &phase))
+            workers++;
+    }
+    if(!workers) runLinkWorker(&phase);
+
+    for(i = 0; i < workers; i++)
+        pthread_join(threads[i], NULL);
+    free(threads);
+}
+
+/**
+ * @brief Reads an object file.
+ *
+ * @param lk Pointer to the linker.
+ * @param i Index of the object.
+ */
+static void loadStep(linker *lk, int i) {
+    link_object *obj = &lk->objects[i];
+
+    if(loadObjectFile(&obj->view, &obj->buf, obj->name)) obj->failed = 1;
+}
+
+/**
+ * @brief Translates an address of an object to its address in the image.
+ *
+ * @param obj Pointer to the object.
+ * @param address The address in the object.
+ * @return The address in the image, or -1 if the address is outside the object.
+ */
+static long relocateAddress(const link_object *obj, long address) {
+    long offset = address - obj->view.load_address;
+
+    if(offset >= 0 && offset < obj->view.ic) return obj->code_base + offset;
+    if(offset >= obj->view.ic && offset < obj->view.ic + obj->view.dc) return obj->data_base + offset - obj->view.ic;
+    return -1;
+}
+
+/**
+ * @brief Encodes an address of the image as a relocatable word, as `encode_label_word` does.
+ *
+ * @param address The address, which must not exceed MAX_WORD_ADDRESS.
+ * @return The word.
+ */
+static unsigned short encodeAddressWord(long address) {
+    return (unsigned short)(((unsigned long)address << 3 | 1 << 1) & CLEAR_MSB);
+}
+
+/**
+ * @brief Copies the words of an object into the image, relocating its addresses and patching its
+ * uses of external labels.
+ *
+ * Only the words of direct addressing operands carry the "R" bit alone, so every such instruction
+ * word holds an address of the object.
+ *
+ * @param lk Pointer to the linker.
+ * @param i Index of the object.
+ */
+static void resolveStep(linker *lk, int i) {
+    link_object *obj = &lk->objects[i];
+    unsigned short *code = lk->words + (obj->code_base - OBJECT_LOAD_ADDRESS);
+    unsigned short *data = lk->words + (obj->data_base - OBJECT_LOAD_ADDRESS);
+    unsigned short word;
+    object_symbol sym;
+    long j, address, offset, found;
+
+    for(j = 0; j < obj->view.ic; j++) {
+        word = getObjectWord(&obj->view, j);
+        if((word & 7) == 1 << 1) {
+            if((address = relocateAddress(obj, (long)(word >> 3))) < 0) {
+                logErrorf("    %s: the word at address %ld of %s\n", getError(ADDRESS_OUTSIDE_OBJECT),
+                          obj->view.load_address + j, obj->name);
+                obj->failed = 1;
+                continue;
+            }
+            if(address > MAX_WORD_ADDRESS) {
+                logErrorf("    %s: the word at address %ld of %s refers to %ld\n", getError(ADDRESS_TOO_LARGE),
+                          obj->view.load_address + j, obj->name, address);
+                obj->failed = 1;
+                continue;
+            }
+            word = encodeAddressWord(address);
+        }
+        code[j] = word;
+    }
+    for(j = 0; j < obj->view.dc; j++)
+        data[j] = getObjectWord(&obj->view, obj->view.ic + j);
+
+    /* Patch each use of an external label with the address it is exported at */
+    for(j = 0; j < obj->view.extern_count; j++) {
+        sym = getObjectExtern(&obj->view, j);
+        offset = sym.address - obj->view.load_address;
+        if(offset < 0 || offset >= obj->view.ic) {
+            logErrorf("    %s: %s at address %ld of %s\n", getError(EXTERN_OUTSIDE_CODE),
+                      sym.name, sym.address, obj->name);
+            obj->failed = 1;
+        } else if((found = findExport(lk, sym.name)) < 0) {
+            logErrorf("    %s: %s at address %ld of %s\n", getError(UNRESOLVED_EXTERN),
+                      sym.name, sym.address, obj->name);
+            obj->failed = 1;
+        } else if(lk->exports[found].address > MAX_WORD_ADDRESS) {
+            logErrorf("    %s: %s at address %ld of %s refers to %ld\n", getError(ADDRESS_TOO_LARGE),
+                      sym.name, sym.address, obj->name, lk->exports[found].address);
+            obj->failed = 1;
+        } else code[offset] = encodeAddressWord(lk->exports[found].address);
+    }
+}
+
+/**
+ * @brief Finds the slot of a name in the hash index of the export table.
+ *
+ * @param lk Pointer to the linker, whose index must be allocated.
+ * @param name Name of the label to look for.
+ * @return The slot holding the label with the given name, or the empty slot where it would be inserted.
+ */
+static long findExportSlot(const linker *lk, const char *name) {
+    long mask = lk->index_size - 1;
+    long i = (long)(hash_name(name) & (unsigned long)mask);
+
+    while(lk->index[i] && strcmp(name, lk->exports[lk->index[i] - 1].name))
+        i = (i + 1) & mask;
+    return i;
+}
+
+/**
+ * @brief Looks up an entry label in the export table.
+ *
+ * @param lk Pointer to the linker.
+ * @param name The name of the label.
+ * @return The index of the label in the export table, or -1 if no object exports it.
+ */
+long findExport(const linker *lk, const char *name) {
+    if(!lk->index) return -1;
+    return lk->index[findExportSlot(lk, name)] - 1;
+}
+
+/**
+ * @brief Lays the objects out in the image, one after the other.
+ *
+ * @param lk Pointer to the linker, whose objects are loaded.
+ * @return EXIT_SUCCESS if the image fits in the memory, EXIT_FAILURE otherwise.
+ */
+static int layoutObjects(linker *lk) {
+    long code = OBJECT_LOAD_ADDRESS, data;
+    int i;
+
+    lk->ic = lk->dc = 0;
+    for(i = 0; i < lk->object_count; i++) {
+        lk->ic += lk->objects[i].view.ic;
+        lk->dc += lk->objects[i].view.dc;
+    }
+    if(lk->ic + lk->dc >= lk->limit) {
+        logErrorf("    %s: %ld words, in a memory of %ld words\n", getError(IMAGE_TOO_LARGE), lk->ic + lk->dc, lk->limit);
+        return EXIT_FAILURE;
+    }
+
+    data = OBJECT_LOAD_ADDRESS + lk->ic;
+    for(i = 0; i < lk->object_count; i++) {
+        lk->objects[i].code_base = code;
+        lk->objects[i].data_base = data;
+        code += lk->objects[i].view.ic;
+        data += lk->objects[i].view.dc;
+    }
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Collects the entry labels of all the objects into the export table, reporting duplicates.
+ *
+ * @param lk Pointer to the linker, whose objects are laid out.
+ * @return EXIT_SUCCESS if the table was built, EXIT_FAILURE if memory allocation failed.
+ */
+static int buildExportTable(linker *lk) {
+    link_object *obj;
+    object_symbol sym;
+    long j, slot, address, total = 0;
+    int i;
+
+    for(i = 0; i < lk->object_count; i++)
+        total += lk->objects[i].view.entry_count;
+
+    /* The index is at most half full, so it never grows */
+    for(lk->index_size = EXPORT_INDEX_INIT_SIZE; lk->index_size < 2 * total; lk->index_size *= 2)
+        ;
+    lk->exports = (object_symbol *)malloc(sizeof(object_symbol) * (total + 1));
+    lk->export_objects = (int *)malloc(sizeof(int) * (total + 1));
+    lk->index = (long *)calloc(lk->index_size, sizeof(long));
+    if(!lk->exports || !lk->export_objects || !lk->index) {
+        logErrorf("    %s\n", getError(ALLOC_FAILED));
+        return EXIT_FAILURE;
+    }
+
+    for(i = 0; i < lk->object_count; i++) {
+        obj = &lk->objects[i];
+        setThreadLog(&obj->log);
+        for(j = 0; j < obj->view.entry_count; j++) {
+            sym = getObjectEntry(&obj->view, j);
+            slot = findExportSlot(lk, sym.name);
+            if((address = relocateAddress(obj, sym.address)) < 0) {
+                logErrorf("    %s: the entry label %s of %s\n", getError(ADDRESS_OUTSIDE_OBJECT), sym.name, obj->name);
+                obj->failed = 1;
+            } else if(lk->index[slot]) {
+                logErrorf("    %s: %s in %s and %s\n", getError(DUPLICATE_EXPORT), sym.name,
+                          lk->objects[lk->export_objects[lk->index[slot] - 1]].name, obj->name);
+                obj->failed = 1;
+            } else {
+                lk->exports[lk->export_count].name = sym.name;
+                lk->exports[lk->export_count].address = address;
+                lk->export_objects[lk->export_count] = i;
+                lk->index[slot] = ++lk->export_count;
+            }
+        }
+        setThreadLog(NULL);
+    }
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Links the objects into one image, printing the errors found in each object.
+ *
+ * Duplicate entry labels, uses of undefined external labels, invalid objects, images too
+ * large for the memory and addresses too large for a word are reported.
+ *
+ * @param lk Pointer to the linker.
+ * @return EXIT_SUCCESS if the image was linked, EXIT_FAILURE if errors were found.
+ */
+int linkObjects(linker *lk) {
+    int i, foundErr = EXIT_SUCCESS;
+
+    runLinkPhase(lk, loadStep);
+    for(i = 0; i < lk->object_count; i++) {
+        if(lk->objects[i].failed) foundErr = EXIT_FAILURE;
+    }
+
+    /* The image is laid out and the exports collected once every object is loaded */
+    if(!foundErr && (layoutObjects(lk) || buildExportTable(lk))) foundErr = EXIT_FAILURE;
+    if(!foundErr && !(lk->words = (unsigned short *)calloc(lk->ic + lk->dc + 1, sizeof(unsigned short)))) {
+        logErrorf("    %s\n", getError(ALLOC_FAILED));
+        foundErr = EXIT_FAILURE;
+    }
+
+    /* The export table is only read from here on, so the objects are resolved in parallel */
+    if(!foundErr) runLinkPhase(lk, resolveStep);
+
+    /* Print the messages of each object in link order */
+    for(i = 0; i < lk->object_count; i++) {
+        flushFileLog(&lk->objects[i].log);
+        if(lk->objects[i].failed) foundErr = EXIT_FAILURE;
+    }
+    return foundErr;
+}
+
+/**
+ * @brief Writes the linked image, with the entry labels of all the objects.
+ *
+ * The text files are NAME.ob, and NAME.ent if an object has entry labels; the binary file is NAME.obj.
+ *
+ * @param lk Pointer to the linker.
+ * @param name The name of the image (without extension).
+ * @param format The formats the image is written in.
+ * @return EXIT_SUCCESS if the files were written, EXIT_FAILURE otherwise.
+ */
+int writeLinkedImage(const linker *lk, const char *name, object_format format) {
+    int status = EXIT_SUCCESS;
+    output_writer w;
+    long i;
+
+    if(format & OBJECT_TEXT) {
+        if(openOutputWriter(&w, name, ".ob")) return EXIT_FAILURE;
+        writeBytes(&w, "  ", 2);
+        writeDecimal(&w, (unsigned long)lk->ic);
+        writeChar(&w, ' ');
+        writeDecimal(&w, (unsigned long)lk->dc);
+        writeChar(&w, '\n');
+        print_instructions(lk->words, (int)lk->ic, &w);
+        print_data(lk->words + lk->ic, (int)lk->ic, (int)lk->dc, &w);
+        if(closeOutputWriter(&w)) status = EXIT_FAILURE;
+
+        if(lk->export_count) {
+            if(openOutputWriter(&w, name, ".ent")) return EXIT_FAILURE;
+            for(i = 0; i < lk->export_count; i++) {
+                writeBytes(&w, lk->exports[i].name, strlen(lk->exports[i].name));
+                writeChar(&w, ' ');
+                writeAddress(&w, (int)lk->exports[i].address, lk->exports[i].address < 1000);
+                writeChar(&w, '\n');
+            }
+            if(closeOutputWriter(&w)) status = EXIT_FAILURE;
+        }
+    }
+
+    if(format & OBJECT_BINARY) {
+        if(openOutputWriter(&w, name, ".obj")) return EXIT_FAILURE;
+        writeObjectFile(&w, lk->words, (int)lk->ic, lk->words + lk->ic, (int)lk->dc, lk->exports,
+                        (int)lk->export_count, NULL, 0);
+        if(closeOutputWriter(&w)) status = EXIT_FAILURE;
+    }
+    return status;
+}
+
+/**
+ * @brief Frees the memory of a linker, closing its objects.
+ *
+ * @param lk Pointer to the linker.
+ */
+void freeLinker(linker *lk) {
+    int i;
+
+    for(i = 0; i < lk->object_count; i++) {
+        closeObjectView(&lk->objects[i].view);
+        freeTextBuffer(&lk->objects[i].buf);
+        freeFileLog(&lk->objects[i].log);
+    }
+    if(lk->objects) pthread_mutex_destroy(&lk->lock);
+    free(lk->objects);
+    free(lk->exports);
+    free(lk->export_objects);
+    free(lk->index);
+    free(lk->words);
+    memset(lk, 0, sizeof(*lk));
+}
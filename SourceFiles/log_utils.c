@@ -0,0 +1,369 @@
+/**
+ * @author Tal Figenblat
+ * @date October 17, 2026
+ *
+ * @file log_utils.c
+ * @brief Contains functions for printing the messages of the assembler, right away or into a file log.
+ *
+ * The file log of a thread is kept in thread-specific storage, so the functions that
+ * report errors do not need to know whether they run on a worker thread. Its records
+ * keep the order the messages of both streams were printed in, so a flushed log reads
+ * the same as if it had been printed right away.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <pthread.h>
+#include "errors_handling.h"
+#include "log_utils.h"
+
+/* Key of the file log attached to each thread, valid once log_key_ready is set */
+static pthread_key_t log_key;
+static int log_key_ready = 0;
+
+/* Creates the key once, even when several threads ask for it at the same time */
+static pthread_once_t log_key_once = PTHREAD_ONCE_INIT;
+
+/* Stream the messages are printed to when no file log is attached, or NULL for the standard output */
+static FILE *log_output = NULL;
+
+/**
+ * @brief Creates the key of the file logs attached to each thread.
+ */
+static void createLogKey(void) {
+    if(!pthread_key_create(&log_key, NULL)) log_key_ready = 1;
+}
+
+/**
+ * @brief Enables attaching file logs to threads.
+ *
+ * Safe to call from several threads at once: the key is created by the first call only.
+ *
+ * @return EXIT_SUCCESS if file logs can be attached, EXIT_FAILURE otherwise.
+ */
+int initThreadLogs(void) {
+    pthread_once(&log_key_once, createLogKey);
+    return log_key_ready ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/**
+ * @brief Attaches a file log to the calling thread.
+ *
+ * @param log Pointer to the file log, or NULL to print the messages of the thread right away.
+ */
+void setThreadLog(file_log *log) {
+    if(log_key_ready) pthread_setspecific(log_key, log);
+}
+
+/**
+ * @brief Returns the file log attached to the calling thread.
+ *
+ * @return Pointer to the file log, or NULL if the messages are printed right away.
+ */
+file_log *getThreadLog(void) {
+    return log_key_ready ? (file_log *)pthread_getspecific(log_key) : NULL;
+}
+
+/**
+ * @brief Selects the stream messages are printed to when no file log is attached.
+ *
+ * @param fp The stream, or NULL for the standard output.
+ */
+void setLogOutput(FILE *fp) {
+    log_output = fp;
+}
+
+/**
+ * @brief Appends text to a file log, after the messages of both streams.
+ *
+ * Consecutive text printed to the same stream shares a record.
+ *
+ * @param log Pointer to the file log.
+ * @param stream The stream the text is printed to.
+ * @param text The text.
+ * @param len Length of the text, in bytes.
+ */
+void appendLogText(file_log *log, log_stream stream, const char *text, size_t len) {
+    log_record *grown;
+    int size;
+
+    if(!len) return;
+    if(appendTextBuffer(stream == LOG_STREAM_ERR ? &log->err : &log->out, text, len)) {
+        log->failed = 1;
+        return;
+    }
+
+    if(log->record_count && log->records[log->record_count - 1].stream == stream) {
+        log->records[log->record_count - 1].len += len;
+        return;
+    }
+
+    /* Grow the array geometrically; text left without a record is still printed, last */
+    if(log->record_count == log->record_size) {
+        size = log->record_size ? log->record_size * 2 : LOG_RECORDS_INIT_SIZE;
+        grown = (log_record *)realloc(log->records, sizeof(log_record) * size);
+        if(!grown) {
+            log->failed = 1;
+            return;
+        }
+        log->records = grown;
+        log->record_size = size;
+    }
+
+    log->records[log->record_count].stream = stream;
+    log->records[log->record_count].len = len;
+    log->record_count++;
+}
+
+/**
+ * @brief Appends a formatted message to a file log, after the messages of both streams.
+ *
+ * The message is formatted on the stack when it is short enough, and on the heap otherwise.
+ * Both argument lists must hold the same arguments, since the second one is only read when
+ * the message does not fit on the stack.
+ *
+ * @param log Pointer to the file log.
+ * @param stream The stream the message is printed to.
+ * @param format The format string.
+ * @param ap1 The arguments of the message.
+ * @param ap2 The same arguments, for formatting on the heap.
+ */
+void appendLogMessage(file_log *log, log_stream stream, const char *format, va_list ap1, va_list ap2) {
+    char line[LOG_LINE_SIZE], *msg = line;
+    int len = vsnprintf(line, sizeof(line), format, ap1);
+
+    if(len < 0) return;
+    if(len >= (int)sizeof(line)) {
+        msg = (char *)malloc(len + 1);
+        if(!msg) {
+            log->failed = 1;
+            return;
+        }
+        vsnprintf(msg, len + 1, format, ap2);
+    }
+
+    appendLogText(log, stream, msg, (size_t)len);
+    if(msg != line) free(msg);
+}
+
+/**
+ * @brief Prints a formatted message to the log output, or to the file log of the calling thread.
+ *
+ * The log output is the standard output, unless another stream was selected with `setLogOutput`.
+ *
+ * @param format The format string, as for `printf`.
+ */
+void logPrintf(const char *format, ...) {
+    file_log *log = getThreadLog();
+    va_list ap1, ap2;
+
+    va_start(ap1, format);
+    if(!log) vfprintf(log_output ? log_output : stdout, format, ap1);
+    else {
+        va_start(ap2, format);
+        appendLogMessage(log, LOG_STREAM_OUT, format, ap1, ap2);
+        va_end(ap2);
+    }
+    va_end(ap1);
+}
+
+/**
+ * @brief Prints a formatted message to the standard error, or to the file log of the calling thread.
+ *
+ * @param format The format string, as for `printf`.
+ */
+void logErrorf(const char *format, ...) {
+    file_log *log = getThreadLog();
+    va_list ap1, ap2;
+
+    va_start(ap1, format);
+    if(!log) vfprintf(stderr, format, ap1);
+    else {
+        va_start(ap2, format);
+        appendLogMessage(log, LOG_STREAM_ERR, format, ap1, ap2);
+        va_end(ap2);
+    }
+    va_end(ap1);
+}
+
+/**
+ * @brief Keeps an error reported on a line of a source as a diagnostic of the log of the calling thread.
+ *
+ * Nothing is kept unless the file log of the thread keeps diagnostics.
+ *
+ * @param line The line the error was found in.
+ * @param code The error, as an `Error` code.
+ */
+void logDiagnostic(int line, int code) {
+    file_log *log = getThreadLog();
+    log_diagnostic *grown;
+    int size;
+
+    if(!log || !log->keep_diagnostics) return;
+
+    /* Grow the array geometrically */
+    if(log->diagnostic_count == log->diagnostic_size) {
+        size = log->diagnostic_size ? log->diagnostic_size * 2 : LOG_DIAGNOSTICS_INIT_SIZE;
+        grown = (log_diagnostic *)realloc(log->diagnostics, sizeof(log_diagnostic) * size);
+        if(!grown) {
+            log->failed = 1;
+            return;
+        }
+        log->diagnostics = grown;
+        log->diagnostic_size = size;
+    }
+
+    log->diagnostics[log->diagnostic_count].line = line;
+    log->diagnostics[log->diagnostic_count].code = code;
+    log->diagnostic_count++;
+}
+
+/**
+ * @brief Initializes an empty file log.
+ *
+ * @param log Pointer to the file log.
+ */
+void initFileLog(file_log *log) {
+    initTextBuffer(&log->out);
+    initTextBuffer(&log->err);
+    log->records = NULL;
+    log->record_count = 0;
+    log->record_size = 0;
+    log->failed = 0;
+    log->keep_diagnostics = 0;
+    log->diagnostics = NULL;
+    log->diagnostic_count = 0;
+    log->diagnostic_size = 0;
+}
+
+/**
+ * @brief Empties a file log, keeping its memory.
+ *
+ * @param log Pointer to the file log.
+ */
+void clearFileLog(file_log *log) {
+    clearTextBuffer(&log->out);
+    clearTextBuffer(&log->err);
+    log->record_count = 0;
+    log->failed = 0;
+    log->diagnostic_count = 0;
+}
+
+/**
+ * @brief Returns the next run of text of a file log, in the order it was printed.
+ *
+ * The records are walked first. Text that was appended to a buffer without a record, or that a
+ * record no longer covers because its buffer was cleared, is bounded by the buffer, and whatever
+ * the records miss is returned last, the standard output first.
+ *
+ * @param log Pointer to the file log.
+ * @param next Index of the next record to walk, starting at 0.
+ * @param done Bytes of each stream returned so far, starting at 0.
+ * @param stream Set to the stream of the text.
+ * @param text Set to the start of the text.
+ * @return Length of the text, or 0 once the whole log was returned.
+ */
+static size_t nextLogRun(const file_log *log, int *next, size_t done[2], log_stream *stream, const char **text) {
+    const text_buffer *buf;
+    size_t len;
+
+    while(*next < log->record_count + 2) {
+        if(*next < log->record_count) {
+            *stream = log->records[*next].stream;
+            len = log->records[*next].len;
+        } else {
+            *stream = *next == log->record_count ? LOG_STREAM_OUT : LOG_STREAM_ERR;
+            len = (size_t)-1;
+        }
+        (*next)++;
+
+        buf = *stream == LOG_STREAM_ERR ? &log->err : &log->out;
+        if(len > buf->len - done[*stream]) len = buf->len - done[*stream];
+        if(len) {
+            *text = buf->data + done[*stream];
+            done[*stream] += len;
+            return len;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Prints the messages collected in a file log to their streams, in the order they were printed.
+ *
+ * @param log Pointer to the file log.
+ */
+void flushFileLog(const file_log *log) {
+    FILE *out = log_output ? log_output : stdout;
+    size_t done[2] = {0, 0}, len;
+    log_stream stream;
+    const char *text;
+    int next = 0;
+
+    while((len = nextLogRun(log, &next, done, &stream, &text))) {
+        /* The log output is buffered, so it is flushed before the standard error is written */
+        if(stream == LOG_STREAM_ERR) {
+            fflush(out);
+            fwrite(text, 1, len, stderr);
+        } else {
+            fwrite(text, 1, len, out);
+        }
+    }
+    fflush(out);
+    if(log->failed) fprintf(stderr, "    %s\n", getError(ALLOC_FAILED));
+}
+
+/**
+ * @brief Appends the messages of both streams of a file log to a buffer, in the order they were printed.
+ *
+ * @param log Pointer to the file log.
+ * @param dest Pointer to the buffer.
+ * @return EXIT_SUCCESS if the messages were appended, EXIT_FAILURE if memory allocation failed.
+ */
+int mergeFileLog(const file_log *log, text_buffer *dest) {
+    size_t done[2] = {0, 0}, len;
+    log_stream stream;
+    const char *text;
+    int next = 0;
+
+    while((len = nextLogRun(log, &next, done, &stream, &text)))
+        if(appendTextBuffer(dest, text, len)) return EXIT_FAILURE;
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Passes the messages collected in a file log on to the log of the calling thread.
+ *
+ * When the calling thread has no file log, the messages are printed right away.
+ *
+ * @param log Pointer to the file log.
+ */
+void logFileLog(const file_log *log) {
+    file_log *outer = getThreadLog();
+    size_t done[2] = {0, 0}, len;
+    log_stream stream;
+    const char *text;
+    int next = 0;
+
+    if(!outer) {
+        flushFileLog(log);
+        return;
+    }
+    while((len = nextLogRun(log, &next, done, &stream, &text)))
+        appendLogText(outer, stream, text, len);
+    if(log->failed) outer->failed = 1;
+}
+
+/**
+ * @brief Frees the memory of a file log.
+ *
+ * @param log Pointer to the file log.
+ */
+void freeFileLog(file_log *log) {
+    freeTextBuffer(&log->out);
+    freeTextBuffer(&log->err);
+    free(log->records);
+    free(log->diagnostics);
+    initFileLog(log);
+}
@@ -16,9 +16,12 @@
 #include <ctype.h>
 #include "macr.h"
 #include "errors_handling.h"
+#include "log_utils.h"
 #include "preprocessor.h"
 #include "token_utils.h"
 #include "globals.h"
+#include "source_reader.h"
+#include "stats.h"
 
 /**
  * @brief Checks if a given name is a legal macro name.
@@ -29,17 +32,18 @@
  * @param name The name to be checked.
  * @return 1 if the name is legal, 0 otherwise.
  */
-int isLegalName(char *name) {
-    if(!name || !(*name)) return 0;  /* Check if the name is NULL or empty */
-    if(!isalpha(*name)) return 0;    /* Check if the first character is alphabetic */
+int isLegalName(text_span name) {
+    size_t i;
 
-    if(strlen(name) > MAX_LABEL_SIZE)
+    if(!name.len) return 0;                               /* Check if the name is empty */
+    if(!isalpha((unsigned char)*name.text)) return 0;     /* Check if the first character is alphabetic */
+
+    if(name.len > MAX_LABEL_SIZE)
         return 0;  /* Check if the length of the name exceeds the maximum allowed size */
 
-    while(*name) {
-        if(!isalnum(*name) && *name != '_')
+    for(i = 1; i < name.len; i++) {
+        if(!isalnum((unsigned char)name.text[i]) && name.text[i] != '_')
             return 0;  /* Check if the name contains only valid characters */
-        name++;
     }
 
     return 1;
@@ -48,10 +52,21 @@ int isLegalName(char *name) {
 /**
  * @brief Initializes a macro table by setting its head to NULL.
  *
+ * The hash index is allocated lazily when the first macro is added.
+ *
  * @param tb Pointer to the macro table to be initialized.
+ * @param mem Pointer to the arena the macros are allocated from.
  */
-void initMacrTable(macr_table *tb) {
+void initMacrTable(macr_table *tb, arena *mem) {
     tb->head = NULL;
+    tb->tail = NULL;
+    tb->index = NULL;
+    tb->size = 0;
+    tb->count = 0;
+    tb->mem = mem;
+    initTextBuffer(&tb->body);
+    tb->parent = NULL;
+    tb->stats = NULL;
 }
 
 /**
@@ -61,13 +76,54 @@ void initMacrTable(macr_table *tb) {
  * @return Pointer to the last macro in the table, or NULL if the table is empty.
  */
 macr *getMacrTail(macr_table *tb) {
-    macr *ptr = tb->head;
+    return tb->tail;
+}
+
+/**
+ * @brief Finds the slot of a name in the hash index of the macro table.
+ *
+ * @param tb Pointer to the macro table, whose index must be allocated.
+ * @param name The name of the macro to look for.
+ * @return The slot holding the macro with the given name, or the empty slot where it would be inserted.
+ */
+int findMacrSlot(const macr_table *tb, text_span name) {
+    int mask = tb->size - 1;
+    int i = (int)(hash_span(name) & mask);
+
+    COUNT_STAT(tb->stats, macro_probes, 1);
+    while(tb->index[i] && !spanEquals(name, tb->index[i]->name)) {
+        i = (i + 1) & mask;
+        COUNT_STAT(tb->stats, macro_probes, 1);
+    }
+    return i;
+}
 
-    if(!ptr) return NULL;  /* If the table is empty, return NULL */
+/**
+ * @brief Rebuilds the hash index of the macro table with a new number of slots.
+ *
+ * @param tb Pointer to the macro table.
+ * @param size The new number of slots (a power of two).
+ * @return EXIT_SUCCESS if the index was rebuilt, EXIT_FAILURE if memory allocation failed.
+ */
+int resizeMacrIndex(macr_table *tb, int size) {
+    macr **old_index = tb->index;
+    macr *ptr;
 
-    /* Traverse the list to find the tail macro */
-    while(ptr -> next) ptr = ptr->next;
-    return ptr;
+    tb->index = (macr **)calloc(size, sizeof(macr *));
+    if(!tb->index) {
+        tb->index = old_index;
+        return EXIT_FAILURE;
+    }
+    noteHeapAlloc(sizeof(macr *) * size);
+    if(old_index) noteHeapFree(sizeof(macr *) * tb->size);
+    tb->size = size;
+
+    /* Re-insert every macro, in definition order */
+    for(ptr = tb->head; ptr; ptr = ptr->next)
+        tb->index[findMacrSlot(tb, makeSpan(ptr->name))] = ptr;
+
+    free(old_index);
+    return EXIT_SUCCESS;
 }
 
 /**
@@ -75,50 +131,74 @@ macr *getMacrTail(macr_table *tb) {
  *
  * @param tb Pointer to the macro table.
  * @param ptr Pointer to the macro to be added.
+ * @return EXIT_SUCCESS if the macro was added, EXIT_FAILURE if the hash index could not be grown.
  */
-void addToMacrTable(macr_table *tb, macr *ptr) {
-    macr *tmp = getMacrTail(tb);
+int addToMacrTable(macr_table *tb, macr *ptr) {
+    /* Keep the load factor of the index at most 3/4 */
+    if(!tb->index) {
+        if(resizeMacrIndex(tb, MACR_INDEX_INIT_SIZE)) return EXIT_FAILURE;
+    } else if((tb->count + 1) * 4 > tb->size * 3) {
+        if(resizeMacrIndex(tb, tb->size * 2)) return EXIT_FAILURE;
+    }
 
     /* If the table is empty, set the new macro as the head */
-    if(!tmp) tb->head = ptr;
-    else tmp->next = ptr;  /* Otherwise, add the new macro at the end of the list */
+    if(!tb->tail) tb->head = ptr;
+    else tb->tail->next = ptr;  /* Otherwise, add the new macro at the end of the list */
+    tb->tail = ptr;
+
+    tb->index[findMacrSlot(tb, makeSpan(ptr->name))] = ptr;
+    tb->count++;
+    return EXIT_SUCCESS;
 }
 
 /**
- * @brief Frees all macros in the macro table and releases associated memory.
+ * @brief Frees the memory of the macro table that is not owned by its arena.
+ *
+ * The macros themselves are released together with the arena.
  *
  * @param tb Pointer to the macro table to be freed.
  */
 void freeMacrTable(macr_table *tb) {
-    macr *ptr, *tmp;
-
-    ptr = tb->head;
-    while(ptr) {
-        tmp = ptr;
-        ptr = ptr->next;
-        if(tmp->name)
-            free(tmp->name);
-        if(tmp->info)
-            free(tmp->info);
-        free(tmp);
-    }
+    if(tb->index) noteHeapFree(sizeof(macr *) * tb->size);
+    free(tb->index);
+    freeTextBuffer(&tb->body);
+    initMacrTable(tb, tb->mem);
+}
+
+/**
+ * @brief Checks cheaply whether a token could be the name of a macro at all.
+ *
+ * Tokens that cannot be legal macro names, such as labels ending with ':', directives,
+ * opcodes and other reserved words, are rejected without touching the macro table.
+ *
+ * @param name The token to be checked.
+ * @return 1 if the token may name a macro, 0 otherwise.
+ */
+int isMacrCandidate(text_span name) {
+    if(!name.len || name.len > MAX_LABEL_SIZE) return 0;  /* Empty or too long to be a name */
+    if(!isalpha((unsigned char)*name.text)) return 0;     /* Directives, comments, operands */
+    if(name.text[name.len - 1] == ':') return 0;          /* Label definitions */
+    return get_keyword_span(name) == NULL;                /* Opcodes, registers and "macr" are reserved */
 }
 
 /**
- * @brief Finds a macro by name in the macro table.
+ * @brief Finds a macro by name in the macro table, then in its macro library.
  *
  * @param tb Pointer to the macro table.
  * @param name The name of the macro to find.
  * @return Pointer to the macro if found, or NULL if not found.
  */
-macr *find_macr(macr_table *tb, char *name) {
-    macr *ptr = NULL;
-    if(tb) ptr = tb->head;
+macr *find_macr(const macr_table *tb, text_span name) {
+    macr *mcr;
 
-    while(ptr) {
-        if(!strcmp(name, ptr->name))
-            return ptr;  /* Return the macro if the name matches */
-        ptr = ptr->next;
+    if(!tb) return NULL;
+    COUNT_STAT(tb->stats, macro_lookups, 1);
+    if(!isMacrCandidate(name)) return NULL;
+
+    /* Look the name up in the hash index of each table in turn */
+    for(; tb; tb = tb->parent) {
+        if(tb->index && (mcr = tb->index[findMacrSlot(tb, name)]))
+            return mcr;
     }
     return NULL;
 }
@@ -127,22 +207,16 @@ macr *find_macr(macr_table *tb, char *name) {
  * @brief Checks if a macro name is legal.
  *
  * A legal macro name is one that is a valid identifier, not a reserved keyword, and does not
- * conflict with existing macros, opcodes, or registers.
+ * conflict with existing macros (including those of the macro library), opcodes, or registers.
  *
  * @param tb Pointer to the macro table.
  * @param name The name to be checked.
  * @return 1 if the name is legal, 0 otherwise.
  */
-int isLegalMacrName(macr_table *tb, char *name) {
-    opcode op = get_opcode(name);
-    regis rg = get_register(name);
-    macr *mcr = find_macr(tb, name);
+int isLegalMacrName(const macr_table *tb, text_span name) {
     return  isLegalName(name) &&
-            strcmp(name, "macr") != 0 &&
-            strcmp(name, "endmacr") != 0 &&
-            (op == unknown_opcode) &&
-            (rg == unknown_register) &&
-            (mcr == NULL);
+            (get_keyword_span(name) == NULL) &&  /* Not an opcode, register, "macr" or "endmacr" */
+            (find_macr(tb, name) == NULL);
 }
 
 /**
@@ -159,69 +233,187 @@ char *my_strdup(const char *s) {
     return res;
 }
 
+/**
+ * @brief Computes the hash value of a name for the symbol table indexes.
+ *
+ * Uses the FNV-1a hash, which is cheap to compute and spreads short identifiers well.
+ *
+ * @param name The name to be hashed.
+ * @return The hash value of the name.
+ */
+unsigned long hash_name(const char *name) {
+    return hash_span(makeSpan(name));
+}
+
+/**
+ * @brief Computes the hash value of a token, like `hash_name`, without copying it.
+ *
+ * @param name The token to be hashed.
+ * @return The hash value of the token.
+ */
+unsigned long hash_span(text_span name) {
+    unsigned long hash = 2166136261UL;
+    size_t i;
+
+    for(i = 0; i < name.len; i++) {
+        hash ^= (unsigned char)name.text[i];
+        hash = (hash * 16777619UL) & 0xFFFFFFFFUL; /* Keep the hash 32 bits wide on every platform */
+    }
+    return hash;
+}
+
 /**
  * @brief Saves macro information from a file into the macro table.
  *
- * Reads macro definitions from the provided file pointers and saves them into the macro table.
- * Handles memory allocation failures and checks for syntax errors.
+ * Reads the lines following the definition from the source text and saves them into the macro table.
+ * Handles memory allocation failures and checks for syntax errors. The body is captured in
+ * linear time and stored with its length, so expanding it is a single copy of known length.
  *
  * @param tb Pointer to the macro table.
- * @param name The name of the macro to save.
+ * @param name The name of the macro to save, as a span of the definition line.
  * @param line_counter Counter for the current line in the file.
- * @param fp1 File pointer to read macro definitions from.
- * @param fp2 Additional file pointer for error handling.
- * @return The updated line counter if successful, or EXIT_FAILURE if an error occurs.
- */
-int save_macr(macr_table *tb, char *name, int line_counter, FILE *fp1, FILE *fp2) {
-    char *info, *new_info, *ptr, line[MAX_LINE_SIZE + 2];
-    int len = 0, foundErr = EXIT_SUCCESS;
-    macr *mcr = (macr *)malloc(sizeof(macr));
+ * @param src Pointer to the source text to read macro definitions from.
+ * @param pos Pointer to the index of the current line, advanced past the end of the macro.
+ * @return The updated line counter if successful, EXIT_FAILURE if a syntax error occurs,
+ *         or EXIT_ABORT if memory allocation failed.
+ */
+int save_macr(macr_table *tb, text_span name, int line_counter, source_text *src, int *pos) {
+    char *ptr;
+    int foundErr = EXIT_SUCCESS, status;
+    text_span token;
+    const keywordMapping *kw;
+    line_view view;
+    macr *mcr = (macr *)arenaAlloc(tb->mem, sizeof(macr));
     if(!mcr) {
-        fprintf(stderr, "    %s\n", getError(ALLOC_FAILED));
-        freeMacrTable(tb);
-        fclose(fp1);
-        fclose(fp2);
-        exit(EXIT_FAILURE);
+        logErrorf("    %s\n", getError(ALLOC_FAILED));
+        return EXIT_ABORT;
     }
 
     mcr->next = NULL;
-    mcr->name = my_strdup(name); /* Duplicate the macro name */
-    addToMacrTable(tb, mcr);
-    allocFail(mcr->name, tb, fp1, fp2);
-
-    info = (char *)malloc(0); /* Allocate initial memory for macro information */
-    allocFail(info, tb, fp1, fp2);
+    mcr->info = NULL;
+    mcr->len = 0;
+    mcr->name = arenaMemdup(tb->mem, name.text, name.len); /* Duplicate the macro name */
+    if(!mcr->name || addToMacrTable(tb, mcr)) {
+        logErrorf("    %s\n", getError(ALLOC_FAILED));
+        return EXIT_ABORT;
+    }
 
-    while((ptr = fgets(line, MAX_LINE_SIZE + 2, fp1))) {
+    /* Capture the body in the scratch buffer, which grows geometrically */
+    clearTextBuffer(&tb->body);
+    while(++(*pos) < src->line_count) {
         line_counter++;
-        /* Check for syntax errors */
-        if(checkLine(fp1, line, line_counter)) foundErr = EXIT_FAILURE;
+        /* Check for syntax errors, still reading the start of a line that is too long */
+        if(checkLine(getLineLength(src, *pos), line_counter)) foundErr = EXIT_FAILURE;
+        ptr = openLineView(src, *pos, MAX_LINE_SIZE, &view);
 
-        nextToken(name, &ptr, ' ');
-        if(!strcmp(name, "endmacr")) {
+        nextSpan(&token, &ptr, ' ');
+        kw = get_keyword_span(token);
+        if(kw && kw->kind == KEYWORD_ENDMACR) {
             if(*ptr && !isspace(*ptr)) {
                 printError(line_counter, EXTRANEOUS_TEXT_AFTER_ENDMACR);
-                return EXIT_FAILURE;
+                foundErr = EXIT_FAILURE;
             }
+            closeLineView(&view);
             break; /* Exit the loop if "endmacr" is encountered */
         }
 
-        new_info = (char *)realloc(info, len + MAX_LINE_SIZE + 1);
-        if(!new_info) {
-            fprintf(stderr, "    %s\n", getError(REALLOC_FAILED));
-            free(info);
-            freeMacrTable(tb);
-            fclose(fp1);
-            fclose(fp2);
-            exit(EXIT_FAILURE);
+        /* Append the new line to the macro information */
+        status = appendTextBuffer(&tb->body, view.text, view.len);
+        closeLineView(&view);
+        if(status) {
+            logErrorf("    %s\n", getError(REALLOC_FAILED));
+            return EXIT_ABORT;
         }
-        info = new_info;
-        ptr = info + len;
-        strcpy(ptr, line); /* Append the new line to the macro information */
-        len = (int)strlen(info); /* Update the length of the macro information */
     }
-    mcr->info = info;
+
+    /* Copy the macro information into the arena, keeping its length */
+    mcr->info = arenaMemdup(tb->mem, tb->body.data ? tb->body.data : "", tb->body.len);
+    if(!mcr->info) {
+        logErrorf("    %s\n", getError(ALLOC_FAILED));
+        return EXIT_ABORT;
+    }
+    mcr->len = tb->body.len;
 
     if(foundErr) return EXIT_FAILURE;
     return line_counter;
 }
+
+/**
+ * @brief Loads a macro library into a macro table, which is then frozen and shared by every file.
+ *
+ * A macro library holds only macro definitions, empty lines and comments. Its macro names follow
+ * the rules of `isLegalMacrName`, so a library cannot define the same macro twice. Once loaded,
+ * the table is only read, so the workers assembling files in parallel may share it.
+ *
+ * @param tb Pointer to an empty macro table receiving the macros.
+ * @param path The path of the macro library.
+ * @return EXIT_SUCCESS if the library was loaded, EXIT_FAILURE otherwise.
+ */
+int loadMacroLibrary(macr_table *tb, const char *path) {
+    char *ptr;
+    int foundErr = EXIT_SUCCESS, line_counter = 0, exit_code, pos;
+    const keywordMapping *kw;
+    text_span str, name, extra;
+    source_text src;
+    line_view view;
+
+    logPrintf(">>> Started working on the macro library %s\n", path);
+
+    /* Read the library with a single call and index its lines */
+    if(readSourceFile(&src, path, "")) {
+        logPrintf(">>> Finished working on the macro library %s\n", path);
+        return EXIT_FAILURE;
+    }
+
+    for(pos = 0; pos < src.line_count; pos++) {
+        line_counter++;
+
+        if(checkLine(getLineLength(&src, pos), line_counter)) {
+            foundErr = EXIT_FAILURE;
+            continue;
+        }
+        ptr = openLineView(&src, pos, MAX_LINE_SIZE, &view);
+
+        nextSpan(&str, &ptr, ' ');
+        nextSpan(&name, &ptr, ' ');
+        nextSpan(&extra, &ptr, ' ');
+        closeLineView(&view);
+
+        /* Skip empty lines and comments */
+        if(!str.len || *str.text == ';') continue;
+
+        /* Anything else must be a macro definition */
+        if(!(kw = get_keyword_span(str)) || kw->kind != KEYWORD_MACR) {
+            printError(line_counter, TEXT_OUTSIDE_MACRO);
+            foundErr = EXIT_FAILURE;
+            continue;
+        }
+        if(extra.len || !name.len) {
+            printError(line_counter, extra.len ? EXTRANEOUS_TEXT_AFTER_MACRO : MISSING_NAME_IN_MACRO);
+            foundErr = EXIT_FAILURE;
+            continue;
+        }
+        if(!isLegalMacrName(tb, name)) {
+            printError(line_counter, INVALID_MACRO_NAME);
+            foundErr = EXIT_FAILURE;
+            continue;
+        }
+
+        exit_code = save_macr(tb, name, line_counter, &src, &pos);
+        if(exit_code == EXIT_ABORT) {
+            foundErr = EXIT_FAILURE;
+            break;
+        }
+        if(exit_code == EXIT_FAILURE) foundErr = EXIT_FAILURE;
+        line_counter = pos + 1; /* The lines of a library are not expanded, so they map one to one */
+    }
+
+    /* The names and bodies were copied to the arena, so the source and scratch buffer can go */
+    freeSourceText(&src);
+    freeTextBuffer(&tb->body);
+
+    if(!foundErr)
+        logPrintf("    No errors were found in the macro library %s\n", path);
+    logPrintf(">>> Finished working on the macro library %s\n", path);
+    return foundErr;
+}
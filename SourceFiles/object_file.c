@@ -0,0 +1,397 @@
+/**
+ * @author Tal Figenblat
+ * @date October 17, 2026
+ *
+ * @file object_file.c
+ * @brief Contains functions for writing and reading the binary object file.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "object_file.h"
+#include "file_utils.h"
+#include "build_cache.h"
+#include "log_utils.h"
+
+/**
+ * @brief Writes a 32-bit little-endian number.
+ *
+ * @param w Pointer to the writer.
+ * @param num The number.
+ */
+static void writeLE32(output_writer *w, unsigned long num) {
+    char bytes[4];
+
+    bytes[0] = (char)(num & 0xff);
+    bytes[1] = (char)((num >> 8) & 0xff);
+    bytes[2] = (char)((num >> 16) & 0xff);
+    bytes[3] = (char)((num >> 24) & 0xff);
+    writeBytes(w, bytes, 4);
+}
+
+/**
+ * @brief Reads a 32-bit little-endian number.
+ *
+ * @param ptr Pointer to the first byte.
+ * @return The number.
+ */
+static unsigned long readLE32(const unsigned char *ptr) {
+    return (unsigned long)ptr[0] | (unsigned long)ptr[1] << 8 | (unsigned long)ptr[2] << 16 |
+           (unsigned long)ptr[3] << 24;
+}
+
+/**
+ * @brief Writes the records of a symbol table, giving each name the next offset in the names.
+ *
+ * @param w Pointer to the writer.
+ * @param symbols The symbols.
+ * @param count Number of symbols.
+ * @param offset Pointer to the offset of the next name, advanced past the names of the symbols.
+ */
+static void writeSymbolTable(output_writer *w, const object_symbol *symbols, int count, unsigned long *offset) {
+    int i;
+
+    for(i = 0; i < count; i++) {
+        writeLE32(w, *offset);
+        writeLE32(w, (unsigned long)symbols[i].address);
+        *offset += strlen(symbols[i].name) + 1;
+    }
+}
+
+/**
+ * @brief Writes the memory image and the symbols of a source as an object file.
+ *
+ * @param w Pointer to the writer of the object file.
+ * @param instructions The instruction words.
+ * @param IC Number of instruction words.
+ * @param data The data words.
+ * @param DC Number of data words.
+ * @param entries The entry labels.
+ * @param entry_count Number of entry labels.
+ * @param externs The uses of external labels.
+ * @param extern_count Number of uses of external labels.
+ */
+void writeObjectFile(output_writer *w, const unsigned short *instructions, int IC, const unsigned short *data, int DC,
+                     const object_symbol *entries, int entry_count, const object_symbol *externs, int extern_count) {
+    unsigned long names_size = 0;
+    char word[2];
+    int i;
+
+    for(i = 0; i < entry_count; i++)
+        names_size += strlen(entries[i].name) + 1;
+    for(i = 0; i < extern_count; i++)
+        names_size += strlen(externs[i].name) + 1;
+
+    writeBytes(w, OBJECT_MAGIC, 4);
+    writeLE32(w, OBJECT_VERSION);
+    writeLE32(w, OBJECT_LOAD_ADDRESS);
+    writeLE32(w, (unsigned long)IC);
+    writeLE32(w, (unsigned long)DC);
+    writeLE32(w, (unsigned long)entry_count);
+    writeLE32(w, (unsigned long)extern_count);
+    writeLE32(w, names_size);
+
+    /* The words, padded so the tables stay aligned */
+    for(i = 0; i < IC + DC; i++) {
+        unsigned short value = i < IC ? instructions[i] : data[i - IC];
+
+        word[0] = (char)(value & 0xff);
+        word[1] = (char)(value >> 8);
+        writeBytes(w, word, 2);
+    }
+    if((IC + DC) % 2) writeBytes(w, "\0\0", 2);
+
+    names_size = 0;
+    writeSymbolTable(w, entries, entry_count, &names_size);
+    writeSymbolTable(w, externs, extern_count, &names_size);
+    for(i = 0; i < entry_count; i++)
+        writeBytes(w, entries[i].name, strlen(entries[i].name) + 1);
+    for(i = 0; i < extern_count; i++)
+        writeBytes(w, externs[i].name, strlen(externs[i].name) + 1);
+}
+
+/**
+ * @brief Checks that every record of a symbol table names a string of the names.
+ *
+ * @param view Pointer to the view, whose names are already known.
+ * @param table The records.
+ * @param count Number of records.
+ * @return EXIT_SUCCESS if every name is valid, EXIT_FAILURE otherwise.
+ */
+static int checkSymbolTable(const object_view *view, const unsigned char *table, long count) {
+    long i;
+
+    for(i = 0; i < count; i++) {
+        if(readLE32(table + i * OBJECT_SYMBOL_SIZE) >= view->names_size) return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Checks the bytes of an object file and prepares a view of them.
+ *
+ * @param view Pointer to the view.
+ * @param data The bytes of the file, which must stay valid while the view is used.
+ * @param size Number of bytes.
+ * @return EXIT_SUCCESS if the bytes hold a valid object file, EXIT_FAILURE otherwise.
+ */
+int openObjectView(object_view *view, const void *data, size_t size) {
+    const unsigned char *bytes = (const unsigned char *)data;
+    unsigned long words, symbols;
+
+    memset(view, 0, sizeof(*view));
+    if(size < OBJECT_HEADER_SIZE || memcmp(bytes, OBJECT_MAGIC, 4) || readLE32(bytes + 4) != OBJECT_VERSION)
+        return EXIT_FAILURE;
+
+    view->data = bytes;
+    view->size = size;
+    view->load_address = (long)readLE32(bytes + 8);
+    view->ic = (long)readLE32(bytes + 12);
+    view->dc = (long)readLE32(bytes + 16);
+    view->entry_count = (long)readLE32(bytes + 20);
+    view->extern_count = (long)readLE32(bytes + 24);
+    view->names_size = readLE32(bytes + 28);
+
+    /* The counts must describe exactly the bytes of the file */
+    words = (unsigned long)view->ic + (unsigned long)view->dc;
+    symbols = (unsigned long)view->entry_count + (unsigned long)view->extern_count;
+    if(words > size / 2 || symbols > size / OBJECT_SYMBOL_SIZE || view->names_size > size ||
+       OBJECT_HEADER_SIZE + (words + words % 2) * 2 + symbols * OBJECT_SYMBOL_SIZE + view->names_size != size)
+        return EXIT_FAILURE;
+
+    view->words = bytes + OBJECT_HEADER_SIZE;
+    view->entries = view->words + (words + words % 2) * 2;
+    view->externs = view->entries + view->entry_count * OBJECT_SYMBOL_SIZE;
+    view->names = (const char *)(view->externs + view->extern_count * OBJECT_SYMBOL_SIZE);
+
+    /* Every name ends within the names */
+    if(view->names_size && view->names[view->names_size - 1]) return EXIT_FAILURE;
+    if(checkSymbolTable(view, view->entries, view->entry_count) ||
+       checkSymbolTable(view, view->externs, view->extern_count))
+        return EXIT_FAILURE;
+
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Maps an object file into memory and prepares a view of it.
+ *
+ * @param view Pointer to the view.
+ * @param path The path of the object file.
+ * @return EXIT_SUCCESS if the file was mapped and is valid, EXIT_FAILURE otherwise.
+ */
+int mapObjectFile(object_view *view, const char *path) {
+    struct stat st;
+    void *data;
+    int fd;
+
+    memset(view, 0, sizeof(*view));
+    if((fd = open(path, O_RDONLY)) < 0) return EXIT_FAILURE;
+    if(fstat(fd, &st) || st.st_size < OBJECT_HEADER_SIZE) {
+        close(fd);
+        return EXIT_FAILURE;
+    }
+
+    data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if(data == MAP_FAILED) return EXIT_FAILURE;
+
+    if(openObjectView(view, data, (size_t)st.st_size)) {
+        munmap(data, (size_t)st.st_size);
+        memset(view, 0, sizeof(*view));
+        return EXIT_FAILURE;
+    }
+    view->mapped = 1;
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Releases a view, unmapping its file if it was mapped.
+ *
+ * @param view Pointer to the view.
+ */
+void closeObjectView(object_view *view) {
+    if(view->mapped) munmap((void *)view->data, view->size);
+    memset(view, 0, sizeof(*view));
+}
+
+/**
+ * @brief Returns a word of the memory image.
+ *
+ * @param view Pointer to the view.
+ * @param i Index of the word, instruction words first.
+ * @return The word.
+ */
+unsigned short getObjectWord(const object_view *view, long i) {
+    return (unsigned short)(view->words[2 * i] | view->words[2 * i + 1] << 8);
+}
+
+/**
+ * @brief Returns an entry label.
+ *
+ * @param view Pointer to the view.
+ * @param i Index of the entry label.
+ * @return The entry label, whose name points into the view.
+ */
+object_symbol getObjectEntry(const object_view *view, long i) {
+    object_symbol sym;
+
+    sym.name = view->names + readLE32(view->entries + i * OBJECT_SYMBOL_SIZE);
+    sym.address = (long)readLE32(view->entries + i * OBJECT_SYMBOL_SIZE + 4);
+    return sym;
+}
+
+/**
+ * @brief Returns a use of an external label.
+ *
+ * @param view Pointer to the view.
+ * @param i Index of the use.
+ * @return The use, whose name points into the view.
+ */
+object_symbol getObjectExtern(const object_view *view, long i) {
+    object_symbol sym;
+
+    sym.name = view->names + readLE32(view->externs + i * OBJECT_SYMBOL_SIZE);
+    sym.address = (long)readLE32(view->externs + i * OBJECT_SYMBOL_SIZE + 4);
+    return sym;
+}
+
+/**
+ * @brief Reads a text file listing symbols, one "name address" line each, if it exists.
+ *
+ * The names are terminated in place, so they point into the buffer.
+ *
+ * @param name The name of the object (without extension).
+ * @param suffix The suffix of the file.
+ * @param buf Pointer to an empty buffer receiving the file.
+ * @param count Pointer to the variable receiving the number of symbols.
+ * @return The symbols, to be freed by the caller, or NULL if the file is invalid or memory allocation failed.
+ */
+static object_symbol *readSymbolFile(const char *name, const char *suffix, text_buffer *buf, int *count) {
+    char *path = append_suffix(name, suffix), *ptr, *end, *space;
+    object_symbol *symbols;
+    int lines = 0;
+
+    *count = 0;
+    if(!path) return NULL;
+    if(readWholeFile(path, buf) == EXIT_FAILURE) {
+        logErrorf("Unable to read the file %s\n", path);
+        free(path);
+        return NULL;
+    }
+    free(path);
+
+    for(ptr = buf->data; ptr && (ptr = strchr(ptr, '\n')); ptr++)
+        lines++;
+    if(!(symbols = (object_symbol *)malloc(sizeof(object_symbol) * (lines + 1)))) return NULL;
+
+    for(ptr = buf->data; ptr && *ptr; ptr = end + 1) {
+        if(!(end = strchr(ptr, '\n')) || !(space = strchr(ptr, ' ')) || space > end) break;
+        *space = '\0';
+        symbols[*count].name = ptr;
+        symbols[(*count)++].address = strtol(space + 1, NULL, 10);
+    }
+    if(ptr && *ptr) {
+        logErrorf("Invalid line in the file %s%s\n", name, suffix);
+        free(symbols);
+        return NULL;
+    }
+    return symbols;
+}
+
+/**
+ * @brief Reads the memory image of a text ".ob" file.
+ *
+ * @param buf Pointer to the content of the file.
+ * @param IC Pointer to the variable receiving the number of instruction words.
+ * @param DC Pointer to the variable receiving the number of data words.
+ * @return The words, to be freed by the caller, or NULL if the file is invalid or memory allocation failed.
+ */
+static unsigned short *readImageText(const text_buffer *buf, int *IC, int *DC) {
+    unsigned short *words;
+    char *ptr, *end;
+    long i;
+
+    if(!buf->data || sscanf(buf->data, "%d %d", IC, DC) != 2 || *IC < 0 || *DC < 0) return NULL;
+    if(!(words = (unsigned short *)malloc(sizeof(unsigned short) * (*IC + *DC + 1)))) return NULL;
+
+    /* Each line is an address followed by an octal word */
+    ptr = strchr(buf->data, '\n');
+    for(i = 0; ptr && i < *IC + *DC; i++) {
+        if(strtol(ptr + 1, &end, 10) != OBJECT_LOAD_ADDRESS + i || *end != ' ') break;
+        words[i] = (unsigned short)strtol(end + 1, &ptr, 8);
+        if(*ptr != '\n') break;
+    }
+    if(!ptr || i < *IC + *DC || ptr[1]) {
+        free(words);
+        return NULL;
+    }
+    return words;
+}
+
+/**
+ * @brief Reads the text ".ob", ".ent" and ".ext" files of a source into an object file in memory.
+ *
+ * The ".ent" and ".ext" files are read if they exist.
+ *
+ * @param name The name of the object (without extension).
+ * @param dest Pointer to the buffer receiving the bytes of the object file.
+ * @return EXIT_SUCCESS if the files were read, EXIT_FAILURE otherwise.
+ */
+int readTextObject(const char *name, text_buffer *dest) {
+    text_buffer ob, ent, ext;
+    object_symbol *entries = NULL, *externs = NULL;
+    unsigned short *words = NULL;
+    int IC, DC, entry_count, extern_count, status = EXIT_FAILURE;
+    char *path = append_suffix(name, ".ob");
+    output_writer w;
+
+    initTextBuffer(&ob);
+    initTextBuffer(&ent);
+    initTextBuffer(&ext);
+    if(path && readWholeFile(path, &ob)) logErrorf("Unable to read the file %s\n", path);
+    else if(path && !(words = readImageText(&ob, &IC, &DC))) logErrorf("Invalid object file %s\n", path);
+    else if(path && (entries = readSymbolFile(name, ".ent", &ent, &entry_count)) &&
+            (externs = readSymbolFile(name, ".ext", &ext, &extern_count)) && !openMemoryWriter(&w, dest)) {
+        writeObjectFile(&w, words, IC, words + IC, DC, entries, entry_count, externs, extern_count);
+        status = closeOutputWriter(&w);
+    }
+
+    free(path);
+    free(words);
+    free(entries);
+    free(externs);
+    freeTextBuffer(&ob);
+    freeTextBuffer(&ent);
+    freeTextBuffer(&ext);
+    return status;
+}
+
+/**
+ * @brief Prepares a view of the object of a source, from its ".obj" file if it exists, or from its text files.
+ *
+ * @param view Pointer to the view.
+ * @param buf Pointer to an empty buffer holding the object file when it is read from the text files.
+ * @param name The name of the object (without extension).
+ * @return EXIT_SUCCESS if the object was read and is valid, EXIT_FAILURE otherwise.
+ */
+int loadObjectFile(object_view *view, text_buffer *buf, const char *name) {
+    char *path = append_suffix(name, ".obj");
+    struct stat st;
+    int status;
+
+    memset(view, 0, sizeof(*view));
+    if(!path) return EXIT_FAILURE;
+    if(!stat(path, &st)) {
+        if((status = mapObjectFile(view, path))) logErrorf("Invalid object file %s\n", path);
+    } else if(!(status = readTextObject(name, buf)) && (status = openObjectView(view, buf->data, buf->len)))
+        logErrorf("Invalid object %s\n", name);
+
+    free(path);
+    return status;
+}
@@ -11,8 +11,11 @@
  */
 
 #include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
 #include "label.h"
 #include "macr.h"
+#include "fixup.h"
 #include "integer_utils.h"
 #include "preprocessor.h"
 #include "token_utils.h"
@@ -29,7 +32,7 @@
  * This function checks if the string corresponds to an immediate addressing
  * method (method 0).
  */
-int is0(char *str, int line_counter) {
+int is0(text_span str, int line_counter) {
     if(parseInstructionInt(str, line_counter) != INSTRUCTION_MAX_VALUE + 1)
         return 1;
     return 0;
@@ -46,7 +49,7 @@ int is0(char *str, int line_counter) {
  * This function checks if the string corresponds to a direct addressing method
  * (method 1).
  */
-int is1(label_table *label_tb, macr_table *macr_tb, char *str) {
+int is1(label_table *label_tb, macr_table *macr_tb, text_span str) {
     if(find_label(label_tb, str) || isLegalLabelName(label_tb, macr_tb, str))
         return 1;
     return 0;
@@ -61,10 +64,12 @@ int is1(label_table *label_tb, macr_table *macr_tb, char *str) {
  * This function checks if the string corresponds to an indirect register
  * addressing method (method 2).
  */
-int is2(char *str) {
-    char *ptr = str;
+int is2(text_span str) {
+    if(!str.len || *str.text != '*') return 0;
 
-    if(*ptr == '*' && get_register(ptr + 1) != unknown_register)
+    /* Look the register up after the '*' prefix */
+    str.text++, str.len--;
+    if(get_register_span(str) != unknown_register)
         return 1;
     return 0;
 }
@@ -78,8 +83,8 @@ int is2(char *str) {
  * This function checks if the string corresponds to a direct register
  * addressing method (method 3).
  */
-int is3(char *str) {
-    if(get_register(str) != unknown_register)
+int is3(text_span str) {
+    if(get_register_span(str) != unknown_register)
         return 1;
     return 0;
 }
@@ -96,7 +101,7 @@ int is3(char *str) {
  * This function identifies the addressing method by checking the string
  * against the known methods (0-3) and returns the corresponding method.
  */
-int which_address_method(label_table *label_tb, macr_table *macr_tb, char *str, int line_counter) {
+int which_address_method(label_table *label_tb, macr_table *macr_tb, text_span str, int line_counter) {
     if(is0(str, line_counter)) return 0;
     if(is1(label_tb, macr_tb, str)) return 1;
     if(is2(str)) return 2;
@@ -124,39 +129,20 @@ void encode_first_word(unsigned short *ptr, opcode op, int opr1, int opr2) {
 }
 
 /**
- * @brief Checks if a label is legal, printing an error if not.
- *
- * @param str The label string to check.
- * @param line_counter The line number of the instruction.
- * @param label_tb Pointer to the label table.
- * @return 1 if the label is legal, 0 otherwise.
- */
-int checkLabel(char *str, int line_counter, label_table *label_tb) {
-    if(isLegalLabelName(label_tb, NULL, str)) {
-        printError(line_counter, UNDEFINED_LABEL);
-        return 0;
-    }
-    return 1;
-}
-
-/**
- * @brief Encodes an extra word based on the operand and label information.
+ * @brief Encodes an extra word based on the operand information.
  *
  * @param ptr Pointer to the word to encode.
- * @param idx The index to use for encoding.
  * @param opr1 The first operand.
  * @param opr2 The second operand.
  * @param str1 The string representation of the first operand.
- * @param label_tb Pointer to the label table.
- * @param fp Pointer to the output file.
  *
  * This function encodes the operand information into the extra word of the instruction.
- * It handles immediate values, direct addressing with labels, and register-based addressing.
+ * It handles immediate values and register-based addressing. Words of direct addressing
+ * operands are left empty here and patched by `encode_label_word` once the label is known.
  * The encoding respects the bit assignments as per the table provided.
  */
-void encode_extra_word(unsigned short *ptr, int idx, int opr1, int opr2, char *str1, label_table *label_tb, FILE *fp) {
+void encode_extra_word(unsigned short *ptr, int opr1, int opr2, text_span str1) {
     int num;
-    label *lb;
     regis rg;
 
     switch(opr1) {
@@ -166,23 +152,10 @@ void encode_extra_word(unsigned short *ptr, int idx, int opr1, int opr2, char *s
             *ptr |= num << 3; /* Shift the immediate value to the correct bit position */
             *ptr |= 1 << 2; /* Set the relevant bit indicating immediate addressing */
             break;
-        case 1:
-            /* Direct addressing: Encode the label's address */
-            lb = find_label(label_tb, str1);
-            *ptr |= lb->address << 3; /* Shift the label address to the correct bit position */
-            if(lb->is_extern) {
-                fprintf(fp, "%s ", lb->name);
-                if(100 + idx < 1000) fprintf(fp, "0");
-                fprintf(fp, "%d\n", 100 + idx);
-                lb->is_extern++;
-                *ptr |= 1; /* Set the extern bit */
-            }
-            else *ptr |= 1 << 1;
-            break;
         case 2:
             /* Internal label: Set the bit indicating internal addressing */
-            str1++; /* Skip the '*' prefix */
-            rg = get_register(str1);
+            str1.text++, str1.len--; /* Skip the '*' prefix */
+            rg = get_register_span(str1);
 
             *ptr |= 1 << 2; /* Set the relevant bit indicating register addressing */
             if(opr2 == -1) *ptr |= rg << 3;  /* If only one operand, shift to the correct bit position */
@@ -190,58 +163,69 @@ void encode_extra_word(unsigned short *ptr, int idx, int opr1, int opr2, char *s
             break;
         case 3:
             /* Direct register addressing: Similar to case 2 but without skipping the prefix */
-            rg = get_register(str1);
+            rg = get_register_span(str1);
 
             *ptr |= 1 << 2;  /* Set the relevant bit indicating register addressing */
             if(opr2 == -1) *ptr |= rg << 3;  /* If only one operand, shift to the correct bit position */
             else *ptr |= rg << 6;            /* If two operands, shift accordingly */
             break;
         default:
-            /* No encoding needed for unsupported operand types */
+            /* Direct addressing is patched later, other operand types need no encoding */
             break;
     }
     *ptr &= CLEAR_MSB; /* Clear the most significant bit to maintain consistency */
 }
 
 /**
- * @brief Parses an opcode instruction and encodes the corresponding words.
+ * @brief Encodes the extra words of an instruction and records its label references.
  *
- * @param ptr Pointer to the string containing the opcode.
- * @param iptr Pointer to the pointer to the instruction word.
- * @param idx The index to use for encoding.
+ * @param iptr Pointer to the first extra word of the instruction.
+ * @param idx The index of the first extra word in the instruction memory.
+ * @param opr1 The first operand's addressing method, or -1 if there is no operand.
+ * @param opr2 The second operand's addressing method, or -1 if there is no second operand.
+ * @param str1 The string representation of the first operand.
+ * @param str2 The string representation of the second operand.
  * @param line_counter The line number of the instruction.
- * @param label_tb Pointer to the label table.
- * @param fp Pointer to the output file.
- * @return EXIT_SUCCESS on successful parsing, EXIT_FAILURE on error.
+ * @param fixup_tb Pointer to the fixup table receiving the direct addressing operands.
+ * @return EXIT_SUCCESS on success, EXIT_FAILURE if a fixup could not be recorded.
  *
- * This function parses an opcode and its operands, determining the addressing methods
- * for each operand and encoding the instruction accordingly. It also handles errors
- * related to undefined labels and unsupported addressing methods.
+ * Two register operands share a single extra word; every other operand has a word of its own.
  */
-int parseOpcode(char *ptr, unsigned short **iptr, int idx, int line_counter, label_table *label_tb, FILE *fp) {
-    char str1[MAX_LABEL_SIZE + 1], str2[MAX_LABEL_SIZE + 1];
-    int opr1, opr2;
-
-    nextToken(str1, &ptr, ',');
-    nextToken(str2, &ptr, ',');
-
-    /* Check if the operands are valid labels */
-    if(!checkLabel(str1, line_counter, label_tb) || !checkLabel(str2, line_counter, label_tb))
-        return EXIT_FAILURE;
-
-    opr1 = which_address_method(label_tb, NULL, str1, 0); /* 0 has no meaning */
-    opr2 = which_address_method(label_tb, NULL, str2, 0); /* 0 has no meaning */
-
-    /* Encode the extra word for the first operand */
-    encode_extra_word(*iptr, idx, opr1, opr2, str1, label_tb, fp);
+int encode_operands(unsigned short *iptr, int idx, int opr1, int opr2, text_span str1, text_span str2,
+                    int line_counter, fixup_table *fixup_tb) {
+    /* Encode the extra word for the first operand; an instruction never touches words past its own */
+    if(opr1 != -1) encode_extra_word(iptr, opr1, opr2, str1);
+    if(opr1 == 1 && addFixup(fixup_tb, FIXUP_OPERAND, idx, str1, line_counter)) return EXIT_FAILURE;
 
     /* Advance the index and instruction pointer if both operands are not using the same register */
-    if(!(opr1 == -1 || (opr1 >= 2 && opr2 >= 2))) idx++, (*iptr)++;
+    if(!(opr1 == -1 || (opr1 >= 2 && opr2 >= 2))) idx++, iptr++;
 
     /* Encode the extra word for the second operand */
-    encode_extra_word(*iptr, idx, opr2, -1, str2, label_tb, fp);
+    if(opr2 != -1) encode_extra_word(iptr, opr2, -1, str2);
+    if(opr2 == 1 && addFixup(fixup_tb, FIXUP_OPERAND, idx, str2, line_counter)) return EXIT_FAILURE;
 
-    /* Advance the instruction pointer if the second operand is valid */
-    if(opr2 != -1) (*iptr)++;
     return EXIT_SUCCESS;
 }
+
+/**
+ * @brief Encodes the address of a label into the extra word of a direct addressing operand.
+ *
+ * @param ptr Pointer to the word to encode.
+ * @param idx The index of the word in the instruction memory.
+ * @param label_tb Pointer to the label table, whose segment addresses are set.
+ * @param lb Pointer to the referenced label.
+ * @param externs Pointer to the table of external references.
+ *
+ * External labels are encoded with the "E" bit and their use is recorded in the table of
+ * external references; other labels are encoded with the "R" bit.
+ */
+void encode_label_word(unsigned short *ptr, int idx, const label_table *label_tb, const label *lb,
+                       extern_table *externs) {
+    *ptr |= labelAddress(label_tb, lb) << 3; /* Shift the label address to the correct bit position */
+    if(lb->segment == SEGMENT_EXTERN) {
+        addExternRef(externs, lb->extern_id, 100 + idx); /* Written once every use is known */
+        *ptr |= 1; /* Set the extern bit */
+    }
+    else *ptr |= 1 << 1;
+    *ptr &= CLEAR_MSB; /* Clear the most significant bit to maintain consistency */
+}
@@ -0,0 +1,264 @@
+/**
+ * @author Tal Figenblat
+ * @date October 17, 2026
+ *
+ * @file options.c
+ * @brief Contains functions for parsing the command-line options of the assembler.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include "errors_handling.h"
+#include "options.h"
+
+/**
+ * @brief Initializes the options with their default values.
+ *
+ * @param opts Pointer to the options.
+ */
+void initOptions(assembler_options *opts) {
+    int i;
+
+    opts->emit_am = 1;
+    opts->jobs = 1;
+    opts->arena_stats = 0;
+    opts->large_memory = 0;
+    opts->object_format = OBJECT_TEXT;
+    opts->relocations = 0;
+    opts->ext_order = EXTERN_ORDER_SOURCE;
+    opts->cache_dir = NULL;
+    opts->cache_size = DEFAULT_CACHE_SIZE_MB;
+    opts->macro_lib_path = NULL;
+    opts->macro_lib = NULL;
+    for(i = 0; i < OUTPUT_KIND_COUNT; i++)
+        opts->output_fds[i] = -1;
+    opts->serve_path = NULL;
+    opts->stats = STATS_OFF;
+    opts->stats_path = NULL;
+    opts->stats_list = NULL;
+    opts->files = NULL;
+    opts->file_count = 0;
+}
+
+/**
+ * @brief Checks whether a command-line argument is an option.
+ *
+ * A lone "-" is not an option, but the file name standing for the standard input.
+ *
+ * @param arg The command-line argument.
+ * @return 1 if the argument is an option, 0 if it is a file name.
+ */
+int isOption(const char *arg) {
+    return *arg == '-' && arg[1];
+}
+
+/**
+ * @brief Finds the output selected by an option such as "--ob-fd".
+ *
+ * @param arg The command-line argument.
+ * @return The kind of the output, or -1 if the argument does not select an output descriptor.
+ */
+int getOutputFdOption(const char *arg) {
+    int i;
+    size_t len;
+
+    if(strncmp(arg, "--", 2)) return -1;
+    for(i = 0; i < OUTPUT_KIND_COUNT; i++) {
+        len = strlen(output_suffixes[i] + 1);
+        if(!strncmp(arg + 2, output_suffixes[i] + 1, len) && !strcmp(arg + 2 + len, "-fd"))
+            return i;
+    }
+    return -1;
+}
+
+/**
+ * @brief Parses the number of parallel jobs given to the "-j" option.
+ *
+ * @param str The number of jobs.
+ * @param jobs Pointer to the variable receiving the number of jobs.
+ * @return EXIT_SUCCESS if the number is valid, EXIT_FAILURE otherwise.
+ */
+int parseJobs(const char *str, int *jobs) {
+    return parsePositive(str, MAX_JOBS, jobs);
+}
+
+/**
+ * @brief Parses a positive decimal number given to an option.
+ *
+ * @param str The number.
+ * @param max The largest accepted value.
+ * @param value Pointer to the variable receiving the number.
+ * @return EXIT_SUCCESS if the number is valid, EXIT_FAILURE otherwise.
+ */
+int parsePositive(const char *str, int max, int *value) {
+    int num = 0;
+
+    if(!str || !*str) return EXIT_FAILURE;
+    for(; *str; str++) {
+        if(!isdigit((unsigned char)*str)) return EXIT_FAILURE;
+        num = num * 10 + (*str - '0');
+        if(num > max) return EXIT_FAILURE;
+    }
+    if(!num) return EXIT_FAILURE;
+
+    *value = num;
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Parses the command-line arguments into options and file names.
+ *
+ * @param opts Pointer to the options.
+ * @param argc The number of command-line arguments.
+ * @param argv The array of command-line arguments.
+ * @return EXIT_SUCCESS if all the arguments were parsed, EXIT_FAILURE otherwise.
+ */
+int parseOptions(assembler_options *opts, int argc, char *argv[]) {
+    int i, kind;
+    const char *value;
+
+    /* There are at most argc - 1 file names */
+    opts->files = (char **)malloc(sizeof(char *) * (argc > 1 ? argc - 1 : 1));
+    if(!opts->files) {
+        fprintf(stderr, "%s\n", getError(ALLOC_FAILED));
+        return EXIT_FAILURE;
+    }
+
+    for(i = 1; i < argc; i++) {
+        if(!isOption(argv[i]))
+            opts->files[opts->file_count++] = argv[i];
+        else if(!strcmp(argv[i], "--emit-am"))
+            opts->emit_am = 1;
+        else if(!strcmp(argv[i], "--no-emit-am"))
+            opts->emit_am = 0;
+        else if(!strcmp(argv[i], "--arena-stats"))
+            opts->arena_stats = 1;
+        else if(!strcmp(argv[i], "--large"))
+            opts->large_memory = 1;
+        else if(!strcmp(argv[i], "--stats"))
+            opts->stats = STATS_TEXT;
+        else if(!strcmp(argv[i], "--stats-json"))
+            opts->stats = STATS_JSON;
+        else if(!strcmp(argv[i], "--relocations"))
+            opts->relocations = 1;
+        else if(!strcmp(argv[i], "--object-format")) {
+            value = i + 1 < argc ? argv[++i] : NULL;
+            if(value && !strcmp(value, "text"))
+                opts->object_format = OBJECT_TEXT;
+            else if(value && !strcmp(value, "binary"))
+                opts->object_format = OBJECT_BINARY;
+            else if(value && !strcmp(value, "both"))
+                opts->object_format = OBJECT_BOTH;
+            else {
+                fprintf(stderr, "%s --object-format %s\n", getError(INVALID_OPTION_VALUE), value ? value : "");
+                return EXIT_FAILURE;
+            }
+        }
+        else if(!strcmp(argv[i], "--ext-order")) {
+            value = i + 1 < argc ? argv[++i] : NULL;
+            if(value && !strcmp(value, "source"))
+                opts->ext_order = EXTERN_ORDER_SOURCE;
+            else if(value && !strcmp(value, "grouped"))
+                opts->ext_order = EXTERN_ORDER_GROUPED;
+            else if(value && !strcmp(value, "sorted"))
+                opts->ext_order = EXTERN_ORDER_SORTED;
+            else {
+                fprintf(stderr, "%s --ext-order %s\n", getError(INVALID_OPTION_VALUE), value ? value : "");
+                return EXIT_FAILURE;
+            }
+        }
+        else if(!strcmp(argv[i], "--stats-file")) {
+            /* The file is the next argument */
+            if(i + 1 == argc || !*argv[i + 1]) {
+                fprintf(stderr, "%s --stats-file\n", getError(INVALID_OPTION_VALUE));
+                return EXIT_FAILURE;
+            }
+            opts->stats_path = argv[++i];
+        }
+        else if(!strcmp(argv[i], "--cache-dir")) {
+            /* The directory is the next argument */
+            if(i + 1 == argc || !*argv[i + 1]) {
+                fprintf(stderr, "%s --cache-dir\n", getError(INVALID_OPTION_VALUE));
+                return EXIT_FAILURE;
+            }
+            opts->cache_dir = argv[++i];
+        } else if(!strcmp(argv[i], "--macro-lib")) {
+            /* The library is the next argument */
+            if(i + 1 == argc || !*argv[i + 1]) {
+                fprintf(stderr, "%s --macro-lib\n", getError(INVALID_OPTION_VALUE));
+                return EXIT_FAILURE;
+            }
+            opts->macro_lib_path = argv[++i];
+        } else if(!strcmp(argv[i], "--serve")) {
+            /* The socket is the next argument */
+            if(i + 1 == argc || !*argv[i + 1]) {
+                fprintf(stderr, "%s --serve\n", getError(INVALID_OPTION_VALUE));
+                return EXIT_FAILURE;
+            }
+            opts->serve_path = argv[++i];
+        } else if(!strcmp(argv[i], "--cache-size")) {
+            value = i + 1 < argc ? argv[++i] : NULL;
+            if(parsePositive(value, MAX_CACHE_SIZE_MB, &opts->cache_size)) {
+                fprintf(stderr, "%s --cache-size %s\n", getError(INVALID_OPTION_VALUE), value ? value : "");
+                return EXIT_FAILURE;
+            }
+        }
+        else if((kind = getOutputFdOption(argv[i])) >= 0) {
+            value = i + 1 < argc ? argv[++i] : NULL;
+            if(parsePositive(value, MAX_OUTPUT_FD, &opts->output_fds[kind])) {
+                fprintf(stderr, "%s --%s-fd %s\n", getError(INVALID_OPTION_VALUE), output_suffixes[kind] + 1,
+                        value ? value : "");
+                return EXIT_FAILURE;
+            }
+        } else if(!strncmp(argv[i], "-j", 2)) {
+            /* The number of jobs is either attached or the next argument */
+            value = argv[i][2] ? argv[i] + 2 : (i + 1 < argc ? argv[++i] : NULL);
+            if(parseJobs(value, &opts->jobs)) {
+                fprintf(stderr, "%s -j %s\n", getError(INVALID_OPTION_VALUE), value ? value : "");
+                return EXIT_FAILURE;
+            }
+        } else {
+            fprintf(stderr, "%s %s\n", getError(UNKNOWN_OPTION), argv[i]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    /* The server takes its sources from its clients */
+    if(opts->serve_path && opts->file_count) {
+        fprintf(stderr, "%s --serve %s\n", getError(INVALID_OPTION_VALUE), opts->serve_path);
+        return EXIT_FAILURE;
+    }
+
+    /* The standard input is assembled on its own */
+    for(i = 0; i < opts->file_count && opts->file_count > 1; i++) {
+        if(!strcmp(opts->files[i], STDIN_ARGUMENT)) {
+            fprintf(stderr, "%s\n", getError(STDIN_NOT_ALONE));
+            return EXIT_FAILURE;
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Checks whether the options select the pipe mode.
+ *
+ * @param opts Pointer to the options.
+ * @return 1 if the source is read from the standard input, 0 otherwise.
+ */
+int isPipeMode(const assembler_options *opts) {
+    return opts->file_count == 1 && !strcmp(opts->files[0], STDIN_ARGUMENT);
+}
+
+/**
+ * @brief Frees the memory of the options.
+ *
+ * @param opts Pointer to the options.
+ */
+void freeOptions(assembler_options *opts) {
+    free(opts->files);
+    free(opts->stats_list);
+    initOptions(opts);
+}
@@ -0,0 +1,369 @@
+/**
+ * @author Tal Figenblat
+ * @date October 17, 2026
+ *
+ * @file output_writer.c
+ * @brief Contains functions for writing the output files through a buffer, formatting numbers with lookup tables.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "file_utils.h"
+#include "errors_handling.h"
+#include "log_utils.h"
+#include "stats.h"
+#include "output_writer.h"
+
+/* The decimal digits of 0 to 99, two characters each */
+static const char decimal_pairs[] =
+        "00010203040506070809101112131415161718192021222324"
+        "25262728293031323334353637383940414243444546474849"
+        "50515253545556575859606162636465666768697071727374"
+        "75767778798081828384858687888990919293949596979899";
+
+/* The octal digits of 0 to 63, two characters each */
+static const char octal_pairs[] =
+        "0001020304050607101112131415161720212223242526273031323334353637"
+        "4041424344454647505152535455565760616263646566677071727374757677";
+
+const char *output_suffixes[OUTPUT_KIND_COUNT] = {".am", ".ob", ".ent", ".ext", ".obj", ".rel"};
+
+/**
+ * @brief Initializes an empty set of output files.
+ *
+ * @param outputs Pointer to the set.
+ */
+void initOutputSet(output_set *outputs) {
+    int i;
+
+    for(i = 0; i < OUTPUT_KIND_COUNT; i++) {
+        initTextBuffer(&outputs->files[i]);
+        outputs->present[i] = 0;
+    }
+    outputs->words = NULL;
+    outputs->ic = 0;
+    outputs->dc = 0;
+    outputs->keep_symbols = 0;
+    outputs->symbols = NULL;
+    outputs->symbol_size = 0;
+    outputs->entry_count = 0;
+    outputs->extern_count = 0;
+    initTextBuffer(&outputs->names);
+}
+
+/**
+ * @brief Empties a set of output files, keeping its memory for reuse.
+ *
+ * @param outputs Pointer to the set.
+ */
+void clearOutputSet(output_set *outputs) {
+    int i;
+
+    for(i = 0; i < OUTPUT_KIND_COUNT; i++) {
+        clearTextBuffer(&outputs->files[i]);
+        outputs->present[i] = 0;
+    }
+    outputs->ic = 0;
+    outputs->dc = 0;
+    outputs->entry_count = 0;
+    outputs->extern_count = 0;
+    clearTextBuffer(&outputs->names);
+}
+
+/**
+ * @brief Keeps a copy of the memory image of a source in a set of output files.
+ *
+ * @param outputs Pointer to the set.
+ * @param instructions The instruction words.
+ * @param IC Number of instruction words.
+ * @param data The data words.
+ * @param DC Number of data words.
+ * @return EXIT_SUCCESS if the image was copied, EXIT_FAILURE if memory allocation failed.
+ */
+int setOutputImage(output_set *outputs, const unsigned short *instructions, int IC, const unsigned short *data, int DC) {
+    unsigned short *words = (unsigned short *)realloc(outputs->words, sizeof(unsigned short) * (IC + DC + 1));
+
+    if(!words) return EXIT_FAILURE;
+    if(IC) memcpy(words, instructions, sizeof(unsigned short) * IC);
+    if(DC) memcpy(words + IC, data, sizeof(unsigned short) * DC);
+
+    outputs->words = words;
+    outputs->ic = IC;
+    outputs->dc = DC;
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Makes room for a number of symbols in a set of output files.
+ *
+ * @param outputs Pointer to the set.
+ * @param count The number of symbols needed.
+ * @return EXIT_SUCCESS if the symbols array is large enough, EXIT_FAILURE if memory allocation failed.
+ */
+int reserveOutputSymbols(output_set *outputs, int count) {
+    output_symbol *symbols;
+
+    if(count <= outputs->symbol_size) return EXIT_SUCCESS;
+    symbols = (output_symbol *)realloc(outputs->symbols, sizeof(output_symbol) * count);
+    if(!symbols) return EXIT_FAILURE;
+    outputs->symbols = symbols;
+    outputs->symbol_size = count;
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Keeps a copy of the name of a label in a set of output files.
+ *
+ * @param outputs Pointer to the set.
+ * @param name The name of the label.
+ * @param offset Pointer to the variable receiving the offset of the copy in the names of the set.
+ * @return EXIT_SUCCESS if the name was copied, EXIT_FAILURE if memory allocation failed.
+ */
+int addOutputName(output_set *outputs, const char *name, size_t *offset) {
+    *offset = outputs->names.len;
+    return appendTextBuffer(&outputs->names, name, strlen(name) + 1);
+}
+
+/**
+ * @brief Frees the memory of a set of output files, leaving it empty.
+ *
+ * Whether the set keeps the symbols is left as it was.
+ *
+ * @param outputs Pointer to the set.
+ */
+void freeOutputSet(output_set *outputs) {
+    int i, keep_symbols = outputs->keep_symbols;
+
+    for(i = 0; i < OUTPUT_KIND_COUNT; i++)
+        freeTextBuffer(&outputs->files[i]);
+    free(outputs->words);
+    free(outputs->symbols);
+    freeTextBuffer(&outputs->names);
+    initOutputSet(outputs);
+    outputs->keep_symbols = keep_symbols;
+}
+
+/**
+ * @brief Marks a writer as not open, so closing it before it is opened fails harmlessly.
+ *
+ * @param w Pointer to the writer.
+ */
+void initOutputWriter(output_writer *w) {
+    w->fd = -1;
+    w->dest = NULL;
+    w->name = NULL;
+    w->buf = NULL;
+    w->len = 0;
+    w->failed = 0;
+}
+
+/**
+ * @brief Creates or truncates an output file and prepares a writer for it.
+ *
+ * @param w Pointer to the writer.
+ * @param file_name The name of the file (without extension).
+ * @param suffix The suffix of the file.
+ * @return EXIT_SUCCESS if the file was opened, EXIT_FAILURE otherwise.
+ */
+int openOutputWriter(output_writer *w, const char *file_name, const char *suffix) {
+    initOutputWriter(w);
+    w->name = append_suffix(file_name, suffix);
+    if(!w->name) return EXIT_FAILURE;
+
+    w->buf = (char *)malloc(OUTPUT_BUFFER_SIZE);
+    if(!w->buf) {
+        logErrorf("    %s\n", getError(ALLOC_FAILED));
+        free(w->name);
+        return EXIT_FAILURE;
+    }
+    noteHeapAlloc(OUTPUT_BUFFER_SIZE);
+
+    w->fd = open(w->name, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+    if(w->fd < 0) {
+        logErrorf("    %s %s\n", getError(FILE_OPEN_FAILED), w->name);
+        noteHeapFree(OUTPUT_BUFFER_SIZE);
+        free(w->buf);
+        free(w->name);
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Prepares a writer that collects an output file in memory.
+ *
+ * @param w Pointer to the writer.
+ * @param dest Pointer to the buffer receiving the file, which is emptied first.
+ * @return EXIT_SUCCESS if the writer is ready, EXIT_FAILURE if memory allocation failed.
+ */
+int openMemoryWriter(output_writer *w, text_buffer *dest) {
+    initOutputWriter(w);
+
+    w->buf = (char *)malloc(OUTPUT_BUFFER_SIZE);
+    if(!w->buf) {
+        logErrorf("    %s\n", getError(ALLOC_FAILED));
+        return EXIT_FAILURE;
+    }
+    noteHeapAlloc(OUTPUT_BUFFER_SIZE);
+
+    clearTextBuffer(dest);
+    w->dest = dest;
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Prepares a writer for an output file of a source, in memory or on the file system.
+ *
+ * @param w Pointer to the writer.
+ * @param file_name The name of the source (without extension).
+ * @param kind The output file.
+ * @param outputs Pointer to the set collecting the outputs in memory, or NULL to create the file.
+ * @return EXIT_SUCCESS if the writer is ready, EXIT_FAILURE otherwise.
+ */
+int openOutputKind(output_writer *w, const char *file_name, output_kind kind, output_set *outputs) {
+    if(outputs) return openMemoryWriter(w, &outputs->files[kind]);
+    return openOutputWriter(w, file_name, output_suffixes[kind]);
+}
+
+/**
+ * @brief Writes the buffered bytes to the file.
+ *
+ * @param w Pointer to the writer.
+ */
+void flushOutputWriter(output_writer *w) {
+    file_stats *stats = getThreadStats();
+    size_t done = 0;
+    ssize_t n;
+
+    if(stats) stats->bytes_written += w->len;
+
+    /* A writer collecting the file in memory appends the bytes to its buffer */
+    if(w->dest) {
+        if(!w->failed && appendTextBuffer(w->dest, w->buf, w->len)) w->failed = 1;
+        w->len = 0;
+        return;
+    }
+
+    /* Retry short writes and interrupted calls */
+    while(!w->failed && done < w->len) {
+        n = write(w->fd, w->buf + done, w->len - done);
+        if(n < 0 && errno == EINTR) continue;
+        if(n <= 0) w->failed = 1;
+        else done += n;
+    }
+    w->len = 0;
+}
+
+/**
+ * @brief Writes bytes of known length.
+ *
+ * @param w Pointer to the writer.
+ * @param str The bytes to write.
+ * @param len Number of bytes.
+ */
+void writeBytes(output_writer *w, const char *str, size_t len) {
+    size_t n;
+
+    while(len) {
+        if(w->len == OUTPUT_BUFFER_SIZE) flushOutputWriter(w);
+        n = OUTPUT_BUFFER_SIZE - w->len;
+        if(n > len) n = len;
+        memcpy(w->buf + w->len, str, n);
+        w->len += n, str += n, len -= n;
+    }
+}
+
+/**
+ * @brief Writes a single character.
+ *
+ * @param w Pointer to the writer.
+ * @param c The character to write.
+ */
+void writeChar(output_writer *w, char c) {
+    if(w->len == OUTPUT_BUFFER_SIZE) flushOutputWriter(w);
+    w->buf[w->len++] = c;
+}
+
+/**
+ * @brief Writes a non-negative number in decimal.
+ *
+ * @param w Pointer to the writer.
+ * @param num The number to write.
+ */
+void writeDecimal(output_writer *w, unsigned long num) {
+    char digits[MAX_FORMATTED_SIZE], *ptr = digits + sizeof(digits);
+
+    /* Produce two digits per table lookup, from the least significant ones */
+    while(num >= 100) {
+        ptr -= 2;
+        memcpy(ptr, decimal_pairs + (num % 100) * 2, 2);
+        num /= 100;
+    }
+    if(num >= 10) {
+        ptr -= 2;
+        memcpy(ptr, decimal_pairs + num * 2, 2);
+    } else *--ptr = (char)('0' + num);
+
+    writeBytes(w, ptr, digits + sizeof(digits) - ptr);
+}
+
+/**
+ * @brief Writes an address in decimal, optionally preceded by a padding "0".
+ *
+ * @param w Pointer to the writer.
+ * @param address The address to write.
+ * @param pad Whether to precede the address with "0".
+ */
+void writeAddress(output_writer *w, int address, int pad) {
+    if(pad) writeChar(w, '0');
+    writeDecimal(w, (unsigned long)address);
+}
+
+/**
+ * @brief Writes a memory word as five octal digits followed by a newline, like "%05o\n".
+ *
+ * @param w Pointer to the writer.
+ * @param word The memory word to write.
+ */
+void writeOctalWord(output_writer *w, unsigned short word) {
+    char *ptr;
+
+    if(OUTPUT_BUFFER_SIZE - w->len < MAX_FORMATTED_SIZE) flushOutputWriter(w);
+    ptr = w->buf + w->len;
+
+    /* A word with its most significant bit set needs a sixth digit */
+    if(word >> 15) *ptr++ = '1';
+    *ptr++ = (char)('0' + ((word >> 12) & 7));
+    memcpy(ptr, octal_pairs + ((word >> 6) & 63) * 2, 2);
+    memcpy(ptr + 2, octal_pairs + (word & 63) * 2, 2);
+    ptr[4] = '\n';
+
+    w->len = ptr + 5 - w->buf;
+}
+
+/**
+ * @brief Flushes the buffered bytes and closes the file.
+ *
+ * @param w Pointer to the writer.
+ * @return EXIT_SUCCESS if the whole file was written, EXIT_FAILURE otherwise.
+ */
+int closeOutputWriter(output_writer *w) {
+    int failed;
+
+    if(w->fd < 0 && !w->dest) return EXIT_FAILURE;
+    flushOutputWriter(w);
+    if(w->fd >= 0 && close(w->fd)) w->failed = 1;
+    failed = w->failed;
+    if(failed && w->dest) logErrorf("    %s\n", getError(ALLOC_FAILED));
+    else if(failed) logErrorf("    %s %s\n", getError(FILE_WRITE_FAILED), w->name);
+
+    noteHeapFree(OUTPUT_BUFFER_SIZE);
+    free(w->buf);
+    free(w->name);
+    initOutputWriter(w);
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
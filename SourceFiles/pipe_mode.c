@@ -0,0 +1,170 @@
+/**
+ * @author Tal Figenblat
+ * @date October 17, 2026
+ *
+ * @file pipe_mode.c
+ * @brief Contains functions for assembling a source read from the standard input.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <unistd.h>
+#include "preprocessor.h"
+#include "errors_handling.h"
+#include "log_utils.h"
+#include "pipe_mode.h"
+
+/**
+ * @brief Checks whether the outputs are written to file descriptors rather than as a framed stream.
+ *
+ * @param opts Pointer to the command-line options.
+ * @return 1 if at least one output descriptor was given, 0 otherwise.
+ */
+int hasOutputFds(const assembler_options *opts) {
+    int i;
+
+    for(i = 0; i < OUTPUT_KIND_COUNT; i++) {
+        if(opts->output_fds[i] >= 0) return 1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Writes a frame of the framed stream.
+ *
+ * @param fp The stream.
+ * @param name The name of the frame.
+ * @param buf Pointer to the content of the frame.
+ * @return EXIT_SUCCESS if the frame was written, EXIT_FAILURE otherwise.
+ */
+int writeStreamFrame(FILE *fp, const char *name, const text_buffer *buf) {
+    if(fprintf(fp, "%s %lu\n", name, (unsigned long)buf->len) < 0) return EXIT_FAILURE;
+    return writeTextBuffer(buf, fp);
+}
+
+/**
+ * @brief Writes the outcome of assembling a source as a framed stream.
+ *
+ * The frames hold the messages, the diagnostics when the log keeps them, and each output
+ * produced, in a fixed order.
+ *
+ * @param fp The stream.
+ * @param result The value returned by the preprocessor.
+ * @param log Pointer to the log of the source.
+ * @param outputs Pointer to the outputs of the source.
+ * @return EXIT_SUCCESS if the whole stream was written, EXIT_FAILURE otherwise.
+ */
+int writeOutputStream(FILE *fp, int result, const file_log *log, const output_set *outputs) {
+    text_buffer diags;
+    int i, status = EXIT_SUCCESS;
+
+    if(fprintf(fp, "%s %d\n", STREAM_MAGIC, result) < 0 || writeStreamFrame(fp, "log", &log->out))
+        status = EXIT_FAILURE;
+
+    /* One line per diagnostic: "<line> <code> <message>" */
+    if(!status && log->keep_diagnostics) {
+        initTextBuffer(&diags);
+        for(i = 0; i < log->diagnostic_count && !status; i++) {
+            char line[LOG_LINE_SIZE];
+
+            sprintf(line, "%d %d ", log->diagnostics[i].line, log->diagnostics[i].code);
+            if(appendTextBufferString(&diags, line) ||
+               appendTextBufferString(&diags, getError(log->diagnostics[i].code)) ||
+               appendTextBuffer(&diags, "\n", 1))
+                status = EXIT_FAILURE;
+        }
+        if(!status) status = writeStreamFrame(fp, "diag", &diags);
+        freeTextBuffer(&diags);
+    }
+
+    for(i = 0; i < OUTPUT_KIND_COUNT && !status; i++) {
+        if(outputs->present[i])
+            status = writeStreamFrame(fp, output_suffixes[i] + 1, &outputs->files[i]);
+    }
+    if(!status && fputs("end\n", fp) == EOF) status = EXIT_FAILURE;
+    if(fflush(fp)) status = EXIT_FAILURE;
+    return status;
+}
+
+/**
+ * @brief Writes the whole content of a buffer to a file descriptor.
+ *
+ * @param fd The file descriptor.
+ * @param buf Pointer to the buffer.
+ * @return EXIT_SUCCESS if every byte was written, EXIT_FAILURE otherwise.
+ */
+int writeToFd(int fd, const text_buffer *buf) {
+    size_t done = 0;
+    ssize_t n;
+
+    /* Retry short writes and interrupted calls */
+    while(done < buf->len) {
+        n = write(fd, buf->data + done, buf->len - done);
+        if(n < 0 && errno == EINTR) continue;
+        if(n <= 0) return EXIT_FAILURE;
+        done += n;
+    }
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Assembles the source read from the standard input, without touching the file system.
+ *
+ * The messages of the source are captured in their own frame when the standard output carries
+ * the framed stream; messages for the standard error are still printed there.
+ *
+ * @param opts Pointer to the command-line options.
+ * @return int Returns 1 if errors were found, otherwise returns 0.
+ */
+int assemblePipe(const assembler_options *opts) {
+    char name[] = STDIN_SOURCE_NAME;
+    int i, result, framed = !hasOutputFds(opts), foundErr = 0;
+    text_buffer src;
+    output_set outputs;
+    file_log log;
+
+    /* Read the whole source first; the preprocessor works on the complete text */
+    initTextBuffer(&src);
+    if(readTextBuffer(&src, stdin)) {
+        fprintf(stderr, "%s\n", getError(STDIN_READ_FAILED));
+        freeTextBuffer(&src);
+        return 1;
+    }
+
+    initOutputSet(&outputs);
+    initFileLog(&log);
+    if(framed && initThreadLogs()) {
+        fprintf(stderr, "%s\n", getError(ALLOC_FAILED));
+        freeTextBuffer(&src);
+        return 1;
+    }
+
+    if(framed) setThreadLog(&log);
+    result = preprocessSource(name, opts, src.data ? src.data : "", src.len, &outputs);
+    if(framed) setThreadLog(NULL);
+    freeTextBuffer(&src);
+
+    if(framed) {
+        if(writeOutputStream(stdout, result, &log, &outputs)) {
+            fprintf(stderr, "%s stdout\n", getError(FILE_WRITE_FAILED));
+            foundErr = 1;
+        }
+
+        /* Only the messages for the standard error are left to print */
+        clearTextBuffer(&log.out);
+        flushFileLog(&log);
+    } else {
+        fflush(stdout); /* An output may share the standard output with the messages */
+        for(i = 0; i < OUTPUT_KIND_COUNT; i++) {
+            if(opts->output_fds[i] >= 0 && outputs.present[i] && writeToFd(opts->output_fds[i], &outputs.files[i])) {
+                fprintf(stderr, "%s %d\n", getError(FILE_WRITE_FAILED), opts->output_fds[i]);
+                foundErr = 1;
+            }
+        }
+    }
+
+    freeFileLog(&log);
+    freeOutputSet(&outputs);
+    return result || foundErr;
+}
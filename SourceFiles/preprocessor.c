@@ -6,7 +6,8 @@
  * @brief Handles the preprocessing of assembly files, specifically macro expansion.
  *
  * This file contains the implementation of the preprocessor function, which processes
- * an assembly source file (.as), expands macros, and writes the result to an output file (.am).
+ * an assembly source file (.as), expands macros into an in-memory buffer consumed by the
+ * first pass, and optionally writes the result to an output file (.am).
  * The function also performs error checking during macro expansion and reports any issues.
  */
 
@@ -16,72 +17,126 @@
 #include "macr.h"
 #include "preprocessor.h"
 #include "token_utils.h"
+#include "globals.h"
 #include "errors_handling.h"
 #include "first_pass.h"
 #include "file_utils.h"
+#include "buffer_utils.h"
+#include "arena.h"
+#include "options.h"
+#include "log_utils.h"
+#include "source_reader.h"
+#include "stats.h"
 
 /**
- * @brief Preprocesses an assembly source file, expanding macros and writing the result to an output file.
+ * @brief Preprocesses an assembly source file, expanding macros into memory.
  *
- * This function reads the input file line by line, expands any macros encountered, and writes
- * the processed lines to an output file. It also performs error checking and reports any issues
- * encountered during preprocessing.
+ * Reads the source from the ".as" file and writes the outputs to files, see `preprocessSource`.
  *
  * @param file_name The name of the source file (without extension) to be preprocessed.
+ * @param opts Pointer to the command-line options.
  * @return int Returns EXIT_SUCCESS if preprocessing is successful, or EXIT_FAILURE if an error occurs.
  */
-int preprocessor(char *file_name) {
-    /* Buffer to hold a line read from the file */
-    char line[MAX_LINE_SIZE + 2], str[MAX_LINE_SIZE + 1], name[MAX_LINE_SIZE + 1], *file_name_am, *ptr;
-    int foundErr = EXIT_SUCCESS, line_counter = 0, exit_code;
-    FILE *fp_in, *fp_out;
+int preprocessor(char *file_name, const assembler_options *opts) {
+    return preprocessSource(file_name, opts, NULL, 0, NULL);
+}
+
+/**
+ * @brief Preprocesses an assembly source, expanding macros into memory.
+ *
+ * This function reads the input file into memory with a single call, visits its lines in place
+ * through a precomputed line index, expands any macros encountered, and appends
+ * the processed lines to an in-memory buffer that is handed to the first pass. The buffer is also
+ * written to the ".am" file unless the options disable it. It also performs error checking and
+ * reports any issues encountered during preprocessing.
+ *
+ * The source may also be given in memory, and the outputs collected in memory, so a source can
+ * be assembled without touching the file system.
+ *
+ * @param file_name The name of the source (without extension), used in messages and output files.
+ * @param opts Pointer to the command-line options.
+ * @param source The source, or NULL to read it from the ".as" file.
+ * @param source_len Length of the source given in memory, in bytes.
+ * @param outputs Pointer to an empty set collecting the output files, or NULL to write them.
+ * @return int Returns EXIT_SUCCESS if preprocessing is successful, or EXIT_FAILURE if an error occurs.
+ */
+int preprocessSource(char *file_name, const assembler_options *opts, const char *source, size_t source_len,
+                     output_set *outputs) {
+    char *file_name_am, *ptr;
+    const char *text;
+    const keywordMapping *kw;
+    text_span str, name;
+    size_t text_len = 0;
+    int foundErr = EXIT_SUCCESS, line_counter = 0, exit_code, pos;
+    unsigned long expansions = 0;
+    file_stats *stats = getThreadStats();
+    FILE *fp_out;
     macr *mcr;
     macr_table macr_tb;
+    text_buffer am;
+    arena mem;
+    source_text src;
+    line_view view;
+
+    enterPhase(PHASE_PREPROCESSOR);
 
-    /* Initialize the macro table */
-    initMacrTable(&macr_tb);
+    /* Initialize the arena of the file, the macro table and the expanded source */
+    initArena(&mem);
+    initMacrTable(&macr_tb, &mem);
+    macr_tb.parent = opts->macro_lib; /* Consulted after the macros of the file */
+    macr_tb.stats = stats;
+    initTextBuffer(&am);
 
     /* Notify that preprocessing has started */
-    printf(">>> Started working on the file %s.as\n", file_name);
+    logPrintf(">>> Started working on the file %s.as\n", file_name);
 
-    /* Open the input (.as) and output (.am) files */
-    fp_in = open_file_with_suffix(file_name, ".as", "r", NULL, NULL, NULL, NULL, NULL);
-    fp_out = open_file_with_suffix(file_name, ".am", "w", NULL, NULL, fp_in, NULL, NULL);
+    /* Read the input (.as) file with a single call and index its lines, or copy the given source */
+    if(source ? copySourceText(&src, source, source_len) : readSourceFile(&src, file_name, ".as")) {
+        if(source) logErrorf("    %s\n", getError(ALLOC_FAILED));
+        freeMacrTable(&macr_tb);
+        freeArena(&mem);
+        return EXIT_FAILURE;
+    }
 
-    /* Process each line of the input file */
-    while((ptr = fgets(line, MAX_LINE_SIZE + 2, fp_in))) {
+    /* Process each line of the input file in place */
+    for(pos = 0; pos < src.line_count; pos++) {
         line_counter++;
+        text = NULL;
 
         /* Check for errors in the current line */
-        if(checkLine(fp_in, line, line_counter)) {
+        if(checkLine(getLineLength(&src, pos), line_counter)) {
             foundErr = EXIT_FAILURE;
             continue;
         }
+        ptr = openLineView(&src, pos, MAX_LINE_SIZE, &view);
 
-        nextToken(str, &ptr, ' ');
-        nextToken(name, &ptr, ' ');
+        nextSpan(&str, &ptr, ' ');
+        nextSpan(&name, &ptr, ' ');
 
         /* Check if the first token is a macro name */
         mcr = find_macr(&macr_tb, str);
 
         if(mcr) {
             /* If there is extraneous text after the macro, report an error */
-            if(*name) {
+            if(name.len) {
                 printError(line_counter, EXTRANEOUS_TEXT_AFTER_MACRO);
                 foundErr = EXIT_FAILURE;
             }
-            /* Write the macro's content to the output file */
-            else fprintf(fp_out, "%s", mcr->info);
+            /* Expand the macro's content */
+            else text = mcr->info, text_len = mcr->len, expansions++;
         }
-        /* If the line is not a macro definition, write it to the output file */
-        else if(strcmp(str, "macr") != 0) fprintf(fp_out, "%s", line);
+        /* If the line is not a macro definition, keep it as is */
+        else if(!(kw = get_keyword_span(str)) || kw->kind != KEYWORD_MACR) text = view.text, text_len = view.len;
         else {
             /* Handle macro definition */
-            nextToken(str, &ptr, ' ');
+            nextSpan(&str, &ptr, ' ');
+
+            /* The body of the macro is read from the following lines, so release this one */
+            closeLineView(&view);
 
             /* Check for errors in macro definition syntax */
-            if(*str || !(*name)) {
-                if(*str)
+            if(str.len || !name.len) {
+                if(str.len)
                     printError(line_counter, EXTRANEOUS_TEXT_AFTER_MACRO);
                 else
                     printError(line_counter, MISSING_NAME_IN_MACRO);
@@ -91,7 +146,11 @@ int preprocessor(char *file_name) {
 
             /* Check if the macro name is legal and save it */
             if(isLegalMacrName(&macr_tb, name)) {
-                exit_code = save_macr(&macr_tb, name, line_counter, fp_in, fp_out);
+                exit_code = save_macr(&macr_tb, name, line_counter, &src, &pos);
+                if(exit_code == EXIT_ABORT) {
+                    foundErr = EXIT_FAILURE;
+                    break;
+                }
                 if(exit_code == EXIT_FAILURE) foundErr = EXIT_FAILURE;
                 line_counter = exit_code;
             } else {
@@ -99,25 +158,78 @@ int preprocessor(char *file_name) {
                 foundErr = EXIT_FAILURE;
             }
         }
+
+        /* Append the expanded text to the buffer with a single copy of known length */
+        exit_code = text && appendTextBuffer(&am, text, text_len);
+        closeLineView(&view);
+        if(exit_code) {
+            logErrorf("    %s\n", getError(ALLOC_FAILED));
+            foundErr = EXIT_FAILURE;
+            break;
+        }
     }
 
-    fclose(fp_in);
-    fclose(fp_out);
+    if(stats) {
+        stats->lines += src.line_count;
+        stats->bytes_read += src.len;
+        stats->macros_defined += macr_tb.count;
+        stats->macros_expanded += expansions;
+    }
+    freeSourceText(&src);
 
     /* Handle errors found during preprocessing */
     if(foundErr) {
-        file_name_am = append_suffix(file_name, ".am", NULL, &macr_tb, NULL, NULL, NULL);
-        remove_file(file_name_am);
-        printf(">>> Finished working on the file %s.as\n", file_name);
-        free(file_name_am);
+        /* Discard a stale ".am" file left by a previous run */
+        if(opts->emit_am && !outputs) {
+            file_name_am = append_suffix(file_name, ".am");
+            if(file_name_am) remove(file_name_am);
+            free(file_name_am);
+        }
+        logPrintf(">>> Finished working on the file %s.as\n", file_name);
+        freeTextBuffer(&am);
         freeMacrTable(&macr_tb);
+        freeArena(&mem);
         return EXIT_FAILURE;
     }
 
-    /* Notify that preprocessing finished without errors */
-    printf("    No errors were found in the file %s.as during macro expansion\n", file_name);
-    printf(">>> Finished working on the file %s.as\n", file_name);
+    /* Write the expanded source to the output (.am) file with a single write */
+    if(opts->emit_am && !outputs) {
+        enterPhase(PHASE_OUTPUT);
+        if(stats) stats->bytes_written += am.len;
+        fp_out = open_file_with_suffix(file_name, ".am", "w");
+        if(!fp_out || writeTextBuffer(&am, fp_out)) {
+            if(fp_out) {
+                logErrorf("    %s %s.am\n", getError(FILE_WRITE_FAILED), file_name);
+                fclose(fp_out);
+            }
+            logPrintf(">>> Finished working on the file %s.as\n", file_name);
+            freeTextBuffer(&am);
+            freeMacrTable(&macr_tb);
+            freeArena(&mem);
+            return EXIT_FAILURE;
+        }
+        fclose(fp_out);
+        enterPhase(PHASE_PREPROCESSOR);
+    }
 
-    /* Proceed with the first pass after preprocessing */
-    return first_pass(file_name, &macr_tb);
+    /* Notify that preprocessing finished without errors */
+    logPrintf("    No errors were found in the file %s.as during macro expansion\n", file_name);
+    logPrintf(">>> Finished working on the file %s.as\n", file_name);
+
+    /* Proceed with the first pass after preprocessing, reading the expanded source from memory */
+    exit_code = first_pass(file_name, &macr_tb, &am, &mem, opts, outputs);
+    enterPhase(PHASE_IDLE);
+
+    /* The expanded source is handed over to the outputs collected in memory, without a copy */
+    if(opts->emit_am && outputs) {
+        freeTextBuffer(&outputs->files[OUTPUT_AM]);
+        outputs->files[OUTPUT_AM] = am;
+        outputs->present[OUTPUT_AM] = 1;
+    } else freeTextBuffer(&am);
+
+    /* Report the memory used by the file, then release it at once */
+    if(opts->arena_stats)
+        logPrintf("    Arena of the file %s: %lu bytes in %d blocks\n", file_name, (unsigned long)mem.bytes, mem.blocks);
+    freeArena(&mem);
+    return exit_code;
 }
@@ -5,100 +5,299 @@
  * @file second_pass.c
  * @brief Handles the second pass of the assembler process.
  *
- * This file contains the implementation of the second pass function, which processes
- * an assembly file that has been preprocessed to expand macros. It resolves labels,
- * encodes instructions and data, and generates the final output files (.ob, .ent, .ext).
+ * This file contains the implementation of the second pass function, which resolves the
+ * label references recorded during the first pass and generates the final output files
+ * (.ob, .ent, .ext). The source file is not read again.
  */
 
 #include <stdio.h>
 #include <stdlib.h>
-#include <string.h>
 #include "label.h"
-#include "preprocessor.h"
-#include "token_utils.h"
-#include "globals.h"
+#include "fixup.h"
 #include "opcode_utils.h"
 #include "file_utils.h"
 #include "errors_handling.h"
+#include "log_utils.h"
+#include "stats.h"
+#include "options.h"
+#include "extern_refs.h"
+
+/**
+ * @brief Collects the entry labels of a file, in the order of the ".ent" file.
+ *
+ * @param label_tb A pointer to the label table.
+ * @param count Pointer to the variable receiving the number of entry labels.
+ * @return The entry labels, to be freed by the caller, or NULL if memory allocation failed.
+ */
+static object_symbol *collectEntries(label_table *label_tb, int *count) {
+    object_symbol *entries = (object_symbol *)malloc(sizeof(object_symbol) * (label_tb->entry_count + 1));
+    label *ptr;
+
+    *count = 0;
+    if(!entries) return NULL;
+    for(ptr = label_tb->entry_head; ptr; ptr = ptr->next_listed) {
+        entries[*count].name = ptr->name;
+        entries[(*count)++].address = labelAddress(label_tb, ptr);
+    }
+    return entries;
+}
+
+/**
+ * @brief Writes the relocation table, one address per line.
+ *
+ * @param w Pointer to the writer of the relocation table.
+ * @param relocs The addresses of the words holding internal addresses, in increasing order.
+ * @param count Number of addresses.
+ */
+static void writeRelocations(output_writer *w, const int *relocs, int count) {
+    int i;
+
+    for(i = 0; i < count; i++) {
+        writeAddress(w, relocs[i], relocs[i] < 1000); /* Formatted like the addresses of the ".ext" file */
+        writeChar(w, '\n');
+    }
+}
+
+/**
+ * @brief Keeps the entry labels and the uses of external labels in a set of outputs.
+ *
+ * The symbols are taken from the label table and the ordered table of uses, in the order of the
+ * ".ent" and ".ext" files, so they are not formatted as text. Each external name is kept once.
+ *
+ * @param outputs Pointer to the set keeping the symbols.
+ * @param label_tb A pointer to the label table.
+ * @param externs Pointer to the ordered table of uses of external labels.
+ * @return EXIT_SUCCESS if the symbols were kept, EXIT_FAILURE if memory allocation failed.
+ */
+static int keepSymbols(output_set *outputs, label_table *label_tb, const extern_table *externs) {
+    size_t *offsets;
+    output_symbol *sym;
+    label *ptr;
+    int i;
+
+    if(reserveOutputSymbols(outputs, label_tb->entry_count + externs->count)) return EXIT_FAILURE;
+    if(!(offsets = (size_t *)malloc(sizeof(size_t) * (label_tb->extern_count + 1)))) return EXIT_FAILURE;
+
+    sym = outputs->symbols;
+    for(ptr = label_tb->entry_head; ptr; ptr = ptr->next_listed, sym++) {
+        if(addOutputName(outputs, ptr->name, &sym->name)) {
+            free(offsets);
+            return EXIT_FAILURE;
+        }
+        sym->address = labelAddress(label_tb, ptr);
+    }
+    for(ptr = label_tb->extern_head; ptr; ptr = ptr->next_listed) {
+        if(addOutputName(outputs, ptr->name, &offsets[ptr->extern_id])) {
+            free(offsets);
+            return EXIT_FAILURE;
+        }
+    }
+
+    for(i = 0; i < externs->count; i++, sym++) {
+        sym->name = offsets[externs->items[i].symbol];
+        sym->address = externs->items[i].address;
+    }
+    outputs->entry_count = label_tb->entry_count;
+    outputs->extern_count = externs->count;
+    free(offsets);
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Closes an output of the second pass that could not be completed, removing its file.
+ *
+ * Only a file opened on disk is removed, so an output that was never opened, or that was
+ * collected in memory, leaves nothing behind.
+ *
+ * @param w Pointer to the writer of the output.
+ * @param file_name The name of the source file (without extension).
+ * @param kind The kind of the output, selecting its suffix.
+ */
+static void discardOutput(output_writer *w, const char *file_name, output_kind kind) {
+    int on_disk = w->fd >= 0;
+
+    closeOutputWriter(w);
+    if(on_disk) discard_file(file_name, output_suffixes[kind]);
+}
 
 /**
  * @brief Performs the second pass on an assembly source file.
  *
- * This function processes an assembly file that has been preprocessed to expand macros.
- * During the second pass, it resolves labels, encodes instructions and data, and generates
- * the final output files (.ob for object code, .ent for entry points, and .ext for external references).
+ * This function sweeps once over the fixups recorded during the first pass, in source order.
+ * It patches the address of every direct addressing operand into its instruction word,
+ * records the uses of external labels, and checks that every entry label is defined.
+ * It then generates the final output files in the selected formats: the text files (.ob for
+ * object code, .ent for entry points, and .ext for external references), the binary .obj file,
+ * or both. The uses of external labels are written in one go, in the selected order, and the
+ * .ext file is only created when there is at least one. With the relocations option, the .rel
+ * file lists the address of every word holding an internal address, so the image can be moved
+ * to another base without assembling it again.
+ * The outputs are collected in memory instead when a set of outputs is given.
  *
  * @param file_name The name of the source file (without extension) to be processed.
  * @param label_tb A pointer to the label table used for label resolution.
- * @param instructions An array of unsigned short where the instructions will be stored.
- * @param data An array of unsigned short where the data will be stored.
+ * @param fixup_tb A pointer to the fixup table recorded during the first pass.
+ * @param instructions An array of unsigned short holding the encoded instructions.
+ * @param data An array of unsigned short holding the encoded data.
+ * @param IC The instruction counter, indicating the number of instruction words.
  * @param DC The data counter, indicating the amount of data in the file.
+ * @param opts Pointer to the options, selecting the output files.
+ * @param outputs Pointer to the set collecting the output files in memory, or NULL to write them.
  * @return int Returns EXIT_SUCCESS if the second pass is successful, or EXIT_FAILURE if an error occurs.
  */
-int second_pass(char *file_name, label_table *label_tb, unsigned short *instructions, unsigned short *data, int DC) {
-    /* Buffer to hold a line read from the file */
-    char line[MAX_LINE_SIZE + 1], str[MAX_LABEL_SIZE + 1], *ptr;
-    unsigned short foundErr = EXIT_SUCCESS, line_counter = 0, IC = 0;
-    unsigned short *iptr = instructions;
+int second_pass(char *file_name, label_table *label_tb, fixup_table *fixup_tb, unsigned short *instructions,
+                unsigned short *data, int IC, int DC, const assembler_options *opts, output_set *outputs) {
+    int i, foundErr = EXIT_SUCCESS, failed_line = 0, entry_count = 0, reloc_count = 0, ext_written = 0;
+    int text = opts->object_format & OBJECT_TEXT, binary = opts->object_format & OBJECT_BINARY;
+    object_symbol *entries = NULL, *symbols = NULL;
+    int *relocs = NULL, no_externs;
     label *lb = NULL;
-    FILE *fp_in, *fp_out, *fp_ent, *fp_ext;
-
-    /* Open the necessary files for the second pass */
-    fp_in = open_file_with_suffix(file_name, ".am", "r", label_tb, NULL, NULL, NULL, NULL);
-    fp_out = open_file_with_suffix(file_name, ".ob", "w", label_tb, NULL, fp_in, NULL, NULL);
-    fp_ent = open_file_with_suffix(file_name, ".ent", "w", label_tb, NULL, fp_in, fp_out, NULL);
-    fp_ext = open_file_with_suffix(file_name, ".ext", "w", label_tb, NULL, fp_in, fp_out, fp_ent);
-
-    /* Process each line of the input file */
-    while((ptr = fgets(line, MAX_LINE_SIZE + 1, fp_in))) {
-        line_counter++;
-
-        /* Skip comment lines */
-        if(*ptr == ';') continue;
-
-        nextToken(str, &ptr, ' ');
-        if(!(*str)) continue;
-
-        /* If a label is found, move to the next token */
-        if(str[strlen(str) - 1] == ':') nextToken(str, &ptr, ' ');
-
-        /* Check for data directives, opcodes, or labels */
-        if(!strcmp(str, ".data") || !strcmp(str, ".string") || !strcmp(str, ".extern")) continue;
-        else if(!strcmp(str, ".entry")) {
-            nextToken(str, &ptr, ' ');
-            lb = find_label(label_tb, str);
-            if(lb && !lb->address) {
-                printError(line_counter, ENTRY_LABEL_UNDEFINED);
+    fixup *fx;
+    extern_table externs;
+    output_writer ob, ent, ext, obj, rel;
+
+    enterPhase(PHASE_OUTPUT);
+
+    /* The uses of external labels are kept until the end, at most one per fixup */
+    if((no_externs = initExternTable(&externs, fixup_tb->count)))
+        logErrorf("    %s\n", getError(ALLOC_FAILED));
+
+    /* The relocation table lists the words of internal labels, at most one per fixup */
+    if(opts->relocations && !(relocs = (int *)malloc(sizeof(int) * (fixup_tb->count + 1))))
+        logErrorf("    %s\n", getError(ALLOC_FAILED));
+
+    /* Open the output files of the second pass, in the selected formats */
+    initOutputWriter(&ob);
+    initOutputWriter(&ent);
+    initOutputWriter(&ext);
+    initOutputWriter(&obj);
+    initOutputWriter(&rel);
+    if(no_externs || (opts->relocations && !relocs) ||
+       (text && (openOutputKind(&ob, file_name, OUTPUT_OB, outputs) ||
+                 openOutputKind(&ent, file_name, OUTPUT_ENT, outputs))) ||
+       (binary && openOutputKind(&obj, file_name, OUTPUT_OBJ, outputs)) ||
+       (opts->relocations && openOutputKind(&rel, file_name, OUTPUT_REL, outputs))) {
+        freeExternTable(&externs);
+        free(relocs);
+        discardOutput(&ob, file_name, OUTPUT_OB);
+        discardOutput(&ent, file_name, OUTPUT_ENT);
+        discardOutput(&obj, file_name, OUTPUT_OBJ);
+        discardOutput(&rel, file_name, OUTPUT_REL);
+        logPrintf(">>> Finished working on the file %s.am\n", file_name);
+        freeLabelTable(label_tb);
+        freeFixupTable(fixup_tb);
+        return EXIT_FAILURE;
+    }
+
+    enterPhase(PHASE_SECOND_PASS);
+
+    /* Resolve each label reference, in source order */
+    for(i = 0; i < fixup_tb->count; i++) {
+        fx = &fixup_tb->items[i];
+        lb = find_label(label_tb, makeSpan(fx->name));
+
+        if(fx->kind == FIXUP_ENTRY) {
+            if(lb && lb->segment == SEGMENT_NONE) {
+                printError(fx->line_counter, ENTRY_LABEL_UNDEFINED);
                 foundErr = EXIT_FAILURE;
             }
-        } else if(get_opcode(str) != unknown_opcode) {
-            iptr++, IC++;
-            if(parseOpcode(ptr, &iptr, IC, line_counter, label_tb, fp_ext)) {
+        } else if(fx->line_counter != failed_line) {
+            /* Report at most one undefined or unencodable label per instruction */
+            if(!lb || labelAddress(label_tb, lb) > MAX_WORD_ADDRESS) {
+                printError(fx->line_counter, lb ? ADDRESS_TOO_LARGE : UNDEFINED_LABEL);
                 foundErr = EXIT_FAILURE;
+                failed_line = fx->line_counter;
                 continue;
             }
-            IC = iptr - instructions;
+            if(relocs && lb->segment != SEGMENT_EXTERN) relocs[reloc_count++] = 100 + fx->idx;
+            encode_label_word(&instructions[fx->idx], fx->idx, label_tb, lb, &externs);
         }
     }
 
-    /* Write the instruction and data counts to the output file */
-    fprintf(fp_out, "  %d %d\n", IC, DC);
-    print_instructions(instructions, IC, fp_out);
-    print_data(data, IC, DC, fp_out);
-    create_entry_file(label_tb, fp_ent);
+    enterPhase(PHASE_OUTPUT);
 
-    /* Close all the opened files */
-    close_multiple_files(fp_in, fp_out, fp_ent, fp_ext);
+    /* Put the uses of external labels in the order both formats write them in */
+    if(orderExternRefs(&externs, label_tb, opts->ext_order)) {
+        logErrorf("    %s\n", getError(ALLOC_FAILED));
+        foundErr = EXIT_FAILURE;
+    }
+
+    if(text) {
+        /* Write the instruction and data counts to the output file */
+        writeBytes(&ob, "  ", 2);
+        writeDecimal(&ob, (unsigned long)IC);
+        writeChar(&ob, ' ');
+        writeDecimal(&ob, (unsigned long)DC);
+        writeChar(&ob, '\n');
+        print_instructions(instructions, IC, &ob);
+        print_data(data, IC, DC, &ob);
+        create_entry_file(label_tb, &ent);
+
+        /* Flush and close all the opened files */
+        if(closeOutputWriter(&ob)) foundErr = EXIT_FAILURE;
+        if(closeOutputWriter(&ent)) foundErr = EXIT_FAILURE;
+
+        /* The external references file is only created when it is kept */
+        if(!foundErr && externs.count) {
+            if(openOutputKind(&ext, file_name, OUTPUT_EXT, outputs)) foundErr = EXIT_FAILURE;
+            else {
+                writeExternRefs(&externs, &ext);
+                if(closeOutputWriter(&ext)) foundErr = EXIT_FAILURE;
+                ext_written = 1;
+            }
+        }
+    }
+
+    /* The binary file holds the image and the labels of the three text files */
+    if(binary) {
+        entries = collectEntries(label_tb, &entry_count);
+        symbols = (object_symbol *)malloc(sizeof(object_symbol) * (externs.count + 1));
+        if(!entries || !symbols) {
+            logErrorf("    %s\n", getError(ALLOC_FAILED));
+            foundErr = EXIT_FAILURE;
+        } else if(!foundErr) {
+            fillExternSymbols(&externs, symbols);
+            writeObjectFile(&obj, instructions, IC, data, DC, entries, entry_count, symbols, externs.count);
+        }
+        if(closeOutputWriter(&obj)) foundErr = EXIT_FAILURE;
+        free(entries);
+        free(symbols);
+    }
+
+    /* The fixups are in source order, so the addresses are increasing */
+    if(relocs) {
+        writeRelocations(&rel, relocs, reloc_count);
+        if(closeOutputWriter(&rel)) foundErr = EXIT_FAILURE;
+        free(relocs);
+    }
 
     /* Handle errors and file processing based on labels */
-    if(foundErr) process_file(file_name, ".ob", label_tb);
-    if(foundErr || !has_entry_label(label_tb)) process_file(file_name, ".ent", label_tb);
-    if(foundErr || !has_extern_label(label_tb)) process_file(file_name, ".ext", label_tb);
+    if(outputs) {
+        if(!foundErr && (setOutputImage(outputs, instructions, IC, data, DC) ||
+                         (outputs->keep_symbols && keepSymbols(outputs, label_tb, &externs)))) {
+            logErrorf("    %s\n", getError(ALLOC_FAILED));
+            foundErr = EXIT_FAILURE;
+        }
+        outputs->present[OUTPUT_OB] = !foundErr && text;
+        outputs->present[OUTPUT_ENT] = !foundErr && text && has_entry_label(label_tb);
+        outputs->present[OUTPUT_EXT] = !foundErr && ext_written;
+        outputs->present[OUTPUT_OBJ] = !foundErr && binary;
+        outputs->present[OUTPUT_REL] = !foundErr && opts->relocations;
+    } else {
+        if(text && foundErr) process_file(file_name, ".ob");
+        if(text && (foundErr || !has_entry_label(label_tb))) process_file(file_name, ".ent");
+        if(text && ext_written && foundErr) process_file(file_name, ".ext");
+        else if(text && !ext_written) discard_file(file_name, ".ext");
+        if(binary && foundErr) process_file(file_name, ".obj");
+        if(opts->relocations && foundErr) process_file(file_name, ".rel");
+    }
 
     /* Notify if no errors were found */
-    if(!foundErr) printf("    No errors were found in the file %s.am\n", file_name);
-    printf(">>> Finished working on the file %s.am\n", file_name);
+    if(!foundErr) logPrintf("    No errors were found in the file %s.am\n", file_name);
+    logPrintf(">>> Finished working on the file %s.am\n", file_name);
+    freeExternTable(&externs);
     freeLabelTable(label_tb);
+    freeFixupTable(fixup_tb);
 
     return foundErr;
 }
@@ -0,0 +1,64 @@
+/**
+ * @author Tal Figenblat
+ * @date October 17, 2026
+ *
+ * @file segment.c
+ * @brief Contains functions for managing the memory segments of a file.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "segment.h"
+#include "stats.h"
+
+/**
+ * @brief Initializes an empty segment.
+ *
+ * @param seg Pointer to the segment.
+ * @param limit Largest number of words the segment may hold.
+ */
+void initSegment(memory_segment *seg, int limit) {
+    seg->words = NULL;
+    seg->size = 0;
+    seg->limit = limit;
+}
+
+/**
+ * @brief Makes room for a number of words, or for the limit of the segment if it is smaller.
+ *
+ * @param seg Pointer to the segment.
+ * @param count Number of words the segment must hold.
+ * @return EXIT_SUCCESS if the segment holds the words, EXIT_FAILURE if memory allocation failed.
+ */
+int reserveSegment(memory_segment *seg, long count) {
+    unsigned short *words;
+    long size;
+
+    if(count > seg->limit) count = seg->limit;
+    if(count <= seg->size) return EXIT_SUCCESS;
+
+    /* Grow the array geometrically, up to the limit */
+    for(size = seg->size ? seg->size : SEGMENT_INIT_SIZE; size < count; size *= 2)
+        ;
+    if(size > seg->limit) size = seg->limit;
+
+    words = (unsigned short *)realloc(seg->words, sizeof(unsigned short) * size);
+    if(!words) return EXIT_FAILURE;
+    noteHeapAlloc(sizeof(unsigned short) * (size - seg->size));
+    memset(words + seg->size, 0, sizeof(unsigned short) * (size - seg->size));
+    seg->words = words;
+    seg->size = (int)size;
+
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Frees the memory of a segment.
+ *
+ * @param seg Pointer to the segment.
+ */
+void freeSegment(memory_segment *seg) {
+    noteHeapFree(sizeof(unsigned short) * seg->size);
+    free(seg->words);
+    initSegment(seg, seg->limit);
+}
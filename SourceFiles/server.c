@@ -0,0 +1,466 @@
+/**
+ * @author Tal Figenblat
+ * @date October 17, 2026
+ *
+ * @file server.c
+ * @brief Contains functions for the persistent server mode of the assembler.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <poll.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "preprocessor.h"
+#include "errors_handling.h"
+#include "log_utils.h"
+#include "token_utils.h"
+#include "pipe_mode.h"
+#include "server.h"
+
+/**
+ * @brief Answers a request that could not be understood.
+ *
+ * @param out The stream the answer is written to.
+ */
+static void answerInvalidRequest(FILE *out) {
+    output_set outputs;
+    file_log log;
+
+    initOutputSet(&outputs);
+    initFileLog(&log);
+    log.keep_diagnostics = 1;
+    appendLogText(&log, LOG_STREAM_OUT, "    ", 4);
+    appendLogText(&log, LOG_STREAM_OUT, getError(INVALID_REQUEST), strlen(getError(INVALID_REQUEST)));
+    appendLogText(&log, LOG_STREAM_OUT, "\n", 1);
+    writeOutputStream(out, EXIT_FAILURE, &log, &outputs);
+    freeFileLog(&log);
+}
+
+/**
+ * @brief Reads the source of a request.
+ *
+ * @param in The stream the source is read from.
+ * @param len Length of the source, in bytes.
+ * @param src Pointer to an empty text buffer receiving the source.
+ * @return EXIT_SUCCESS if the whole source was read, EXIT_FAILURE otherwise.
+ */
+static int readRequestSource(FILE *in, unsigned long len, text_buffer *src) {
+    char chunk[BUFFER_READ_SIZE];
+    size_t n;
+
+    while(len) {
+        n = fread(chunk, 1, len < sizeof(chunk) ? (size_t)len : sizeof(chunk), in);
+        if(!n || appendTextBuffer(src, chunk, n)) return EXIT_FAILURE;
+        len -= n;
+    }
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Parses the length of the source of a request.
+ *
+ * @param str The length, as decimal digits.
+ * @param len Pointer to the variable receiving the length.
+ * @return EXIT_SUCCESS if the length is valid, EXIT_FAILURE otherwise.
+ */
+static int parseRequestLength(text_span str, unsigned long *len) {
+    unsigned long num = 0;
+    size_t i;
+
+    if(!str.len) return EXIT_FAILURE;
+    for(i = 0; i < str.len; i++) {
+        if(str.text[i] < '0' || str.text[i] > '9') return EXIT_FAILURE;
+        num = num * 10 + (unsigned long)(str.text[i] - '0');
+        if(num > MAX_REQUEST_SOURCE) return EXIT_FAILURE;
+    }
+
+    *len = num;
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Checks that the name of a "path" request stays under the working directory of the server.
+ *
+ * @param name The name of the source, without its extension.
+ * @return 1 if the name is relative and has no ".." component, 0 otherwise.
+ */
+static int isServedPath(const char *name) {
+    const char *ptr = name;
+
+    if(*name == '/') return 0;
+    while(ptr) {
+        if(ptr[0] == '.' && ptr[1] == '.' && (ptr[2] == '/' || !ptr[2])) return 0;
+        if((ptr = strchr(ptr, '/'))) ptr++;
+    }
+    return 1;
+}
+
+/**
+ * @brief Answers a single request read from a connection.
+ *
+ * The request is assembled with its own copy of the options of the server, its own log and its
+ * own outputs, all released once it is answered.
+ *
+ * @param server Pointer to the server.
+ * @param in The stream the request is read from.
+ * @param out The stream the answer is written to.
+ * @return EXIT_SUCCESS if another request may follow, EXIT_FAILURE if the connection must be closed.
+ */
+int handleRequest(assembler_server *server, FILE *in, FILE *out) {
+    char line[REQUEST_LINE_SIZE], *ptr = line;
+    text_span magic, command, name, length, flag;
+    assembler_options opts = *server->opts;
+    unsigned long len;
+    text_buffer src, merged;
+    output_set outputs;
+    file_log log;
+    int result, status = EXIT_SUCCESS;
+
+    /* The connection was closed, or the header line is too long to be a request */
+    if(!fgets(line, sizeof(line), in)) return EXIT_FAILURE;
+    if(!strchr(line, '\n')) {
+        answerInvalidRequest(out);
+        return EXIT_FAILURE;
+    }
+
+    nextSpan(&magic, &ptr, ' ');
+    nextSpan(&command, &ptr, ' ');
+    nextSpan(&name, &ptr, ' ');
+    nextSpan(&length, &ptr, ' ');
+    if(!spanEquals(magic, REQUEST_MAGIC) || !name.len || parseRequestLength(length, &len)) {
+        answerInvalidRequest(out);
+        return EXIT_FAILURE;
+    }
+
+    /* Apply the options of the request */
+    while(nextSpan(&flag, &ptr, ' '), flag.len) {
+        if(spanEquals(flag, "emit-am")) opts.emit_am = 1;
+        else if(spanEquals(flag, "no-emit-am")) opts.emit_am = 0;
+        else if(spanEquals(flag, "arena-stats")) opts.arena_stats = 1;
+        else if(spanEquals(flag, "large")) opts.large_memory = 1;
+        else if(spanEquals(flag, "object-text")) opts.object_format = OBJECT_TEXT;
+        else if(spanEquals(flag, "object-binary")) opts.object_format = OBJECT_BINARY;
+        else if(spanEquals(flag, "object-both")) opts.object_format = OBJECT_BOTH;
+        else if(spanEquals(flag, "relocations")) opts.relocations = 1;
+        else if(spanEquals(flag, "ext-source")) opts.ext_order = EXTERN_ORDER_SOURCE;
+        else if(spanEquals(flag, "ext-grouped")) opts.ext_order = EXTERN_ORDER_GROUPED;
+        else if(spanEquals(flag, "ext-sorted")) opts.ext_order = EXTERN_ORDER_SORTED;
+        else {
+            answerInvalidRequest(out);
+            return EXIT_FAILURE;
+        }
+    }
+    ((char *)name.text)[name.len] = '\0';
+
+    if(spanEquals(command, "stop")) {
+        /* Stop accepting connections; the workers finish the requests already waiting */
+        pthread_mutex_lock(&server->lock);
+        server->stopping = 1;
+        pthread_cond_broadcast(&server->changed);
+        pthread_mutex_unlock(&server->lock);
+        len = 0;
+    } else if(!spanEquals(command, "source") && !(spanEquals(command, "path") && !len && isServedPath(name.text))) {
+        answerInvalidRequest(out);
+        return EXIT_FAILURE;
+    }
+
+    initTextBuffer(&src);
+    if(readRequestSource(in, len, &src)) {
+        freeTextBuffer(&src);
+        return EXIT_FAILURE;
+    }
+
+    initOutputSet(&outputs);
+    initFileLog(&log);
+    log.keep_diagnostics = 1;
+    result = EXIT_SUCCESS;
+
+    if(!spanEquals(command, "stop")) {
+        setThreadLog(&log);
+        if(spanEquals(command, "path"))
+            result = preprocessSource((char *)name.text, &opts, NULL, 0, &outputs);
+        else
+            result = preprocessSource((char *)name.text, &opts, src.data ? src.data : "", src.len, &outputs);
+        setThreadLog(NULL);
+
+        /* The client sees every message of the request in a single log, in the order they were printed */
+        initTextBuffer(&merged);
+        if(mergeFileLog(&log, &merged)) log.failed = 1;
+        freeTextBuffer(&log.out);
+        log.out = merged;
+    }
+
+    if(writeOutputStream(out, result, &log, &outputs)) status = EXIT_FAILURE;
+    if(spanEquals(command, "stop")) status = EXIT_FAILURE;
+
+    freeTextBuffer(&src);
+    freeOutputSet(&outputs);
+    freeFileLog(&log);
+    return status;
+}
+
+/**
+ * @brief Opens a connection accepted from a client.
+ *
+ * Reads and writes that stall for longer than SERVER_REQUEST_TIMEOUT fail, so a client that stops
+ * in the middle of a request only holds a worker for a bounded time.
+ *
+ * @param fd The accepted socket, closed if the connection cannot be opened.
+ * @return The connection, or NULL if memory allocation failed.
+ */
+static server_connection *openConnection(int fd) {
+    server_connection *conn = (server_connection *)malloc(sizeof(server_connection));
+    struct timeval timeout;
+    int out_fd;
+
+    if(!conn) {
+        close(fd);
+        return NULL;
+    }
+
+    timeout.tv_sec = SERVER_REQUEST_TIMEOUT;
+    timeout.tv_usec = 0;
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+    conn->fd = fd;
+    conn->in = fdopen(fd, "r");
+    conn->out = (out_fd = dup(fd)) >= 0 ? fdopen(out_fd, "w") : NULL;
+    if(!conn->out && out_fd >= 0) close(out_fd);
+    if(!conn->in || !conn->out) {
+        if(conn->in) fclose(conn->in);
+        else close(fd);
+        if(conn->out) fclose(conn->out);
+        free(conn);
+        return NULL;
+    }
+
+    /* Nothing may be read ahead of the current request, or the poller would not see it */
+    setvbuf(conn->in, NULL, _IONBF, 0);
+    return conn;
+}
+
+/**
+ * @brief Closes a connection and frees its memory.
+ *
+ * @param conn The connection.
+ */
+static void closeConnection(server_connection *conn) {
+    fclose(conn->in);
+    fclose(conn->out);
+    free(conn);
+}
+
+/**
+ * @brief Wakes the polling thread of the server.
+ *
+ * @param server Pointer to the server.
+ */
+static void wakeServer(assembler_server *server) {
+    char byte = 0;
+
+    while(write(server->wake_fds[1], &byte, 1) < 0 && errno == EINTR)
+        ;
+}
+
+/**
+ * @brief Answers the request waiting on a connection, then hands the connection back to the
+ * polling thread, or closes it if it ended.
+ *
+ * @param server Pointer to the server.
+ * @param conn The connection, with a request waiting.
+ */
+void answerConnection(assembler_server *server, server_connection *conn) {
+    int status = handleRequest(server, conn->in, conn->out);
+
+    pthread_mutex_lock(&server->lock);
+    if(status) {
+        closeConnection(conn);
+        server->closed_count++;
+    } else server->returned[server->returned_count++] = conn;
+    pthread_mutex_unlock(&server->lock);
+    wakeServer(server);
+}
+
+/**
+ * @brief Answers requests of connections taken from the queue until the server stops.
+ *
+ * @param arg Pointer to the server.
+ * @return NULL.
+ */
+void *runServerWorker(void *arg) {
+    assembler_server *server = (assembler_server *)arg;
+    server_connection *conn;
+
+    while(1) {
+        /* Take the oldest waiting connection, or leave once none is left after a stop */
+        pthread_mutex_lock(&server->lock);
+        while(!server->count && !server->stopping)
+            pthread_cond_wait(&server->changed, &server->lock);
+        if(!server->count) {
+            pthread_mutex_unlock(&server->lock);
+            break;
+        }
+        conn = server->queue[server->head];
+        server->head = (server->head + 1) % SERVER_MAX_CONNECTIONS;
+        server->count--;
+        pthread_mutex_unlock(&server->lock);
+
+        answerConnection(server, conn);
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Polls the connections of the server, queueing each request for the workers, until a stop
+ * request has been answered and every connection is closed.
+ *
+ * @param server Pointer to the server, whose workers are running.
+ */
+static void pollConnections(assembler_server *server) {
+    server_connection *idle[SERVER_MAX_CONNECTIONS], *conn;
+    struct pollfd fds[SERVER_MAX_CONNECTIONS + 2];
+    int i, fd, idle_count = 0, open_count = 0, stopping = 0;
+    char drain[64];
+
+    while(!stopping || open_count) {
+        /* Take back the connections the workers are done with */
+        pthread_mutex_lock(&server->lock);
+        stopping = server->stopping;
+        open_count -= server->closed_count;
+        server->closed_count = 0;
+        for(i = 0; i < server->returned_count; i++)
+            idle[idle_count++] = server->returned[i];
+        server->returned_count = 0;
+        pthread_mutex_unlock(&server->lock);
+
+        /* After a stop, idle connections are closed instead of polled */
+        if(stopping) {
+            for(i = 0; i < idle_count; i++)
+                closeConnection(idle[i]);
+            open_count -= idle_count;
+            idle_count = 0;
+            if(!open_count) break;
+        }
+
+        fds[0].fd = server->wake_fds[0];
+        fds[1].fd = !stopping && open_count < SERVER_MAX_CONNECTIONS ? server->listen_fd : -1;
+        for(i = 0; i < 2 + idle_count; i++) {
+            if(i >= 2) fds[i].fd = idle[i - 2]->fd;
+            fds[i].events = POLLIN;
+            fds[i].revents = 0;
+        }
+        if(poll(fds, (nfds_t)(2 + idle_count), -1) < 0) {
+            if(errno == EINTR) continue;
+            break;
+        }
+
+        if(fds[0].revents) read(server->wake_fds[0], drain, sizeof(drain));
+
+        /* Queue the connections with a request, or a hang-up, waiting */
+        pthread_mutex_lock(&server->lock);
+        for(i = idle_count - 1; i >= 0; i--) {
+            if(!fds[i + 2].revents) continue;
+            server->queue[(server->head + server->count) % SERVER_MAX_CONNECTIONS] = idle[i];
+            server->count++;
+            idle[i] = idle[--idle_count];
+        }
+        pthread_cond_broadcast(&server->changed);
+        pthread_mutex_unlock(&server->lock);
+
+        if(fds[1].revents && (fd = accept(server->listen_fd, NULL, NULL)) >= 0 && (conn = openConnection(fd))) {
+            idle[idle_count++] = conn;
+            open_count++;
+        }
+    }
+
+    /* Only left early if polling failed */
+    for(i = 0; i < idle_count; i++)
+        closeConnection(idle[i]);
+}
+
+/**
+ * @brief Runs the server on the socket given in the options, until a stop request is received.
+ *
+ * @param opts Pointer to the options.
+ * @return int Returns 1 if the server could not be started, otherwise returns 0.
+ */
+int runServer(const assembler_options *opts) {
+    int i, workers = 0;
+    struct sockaddr_un addr;
+    pthread_t threads[MAX_JOBS];
+    assembler_server server;
+    mode_t mask;
+
+    if(strlen(opts->serve_path) >= sizeof(addr.sun_path)) {
+        fprintf(stderr, "%s --serve %s\n", getError(INVALID_OPTION_VALUE), opts->serve_path);
+        return 1;
+    }
+    if(initThreadLogs()) {
+        fprintf(stderr, "%s\n", getError(ALLOC_FAILED));
+        return 1;
+    }
+
+    /* A client that goes away must not stop the server */
+    signal(SIGPIPE, SIG_IGN);
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, opts->serve_path);
+    unlink(opts->serve_path);
+
+    /* Only the owner of the server may connect to it */
+    mask = umask(077);
+    server.listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if(server.listen_fd < 0 || bind(server.listen_fd, (struct sockaddr *)&addr, sizeof(addr)) ||
+       listen(server.listen_fd, SERVER_MAX_CONNECTIONS) || pipe(server.wake_fds)) {
+        umask(mask);
+        fprintf(stderr, "%s %s\n", getError(FILE_OPEN_FAILED), opts->serve_path);
+        if(server.listen_fd >= 0) close(server.listen_fd);
+        return 1;
+    }
+    umask(mask);
+
+    server.opts = opts;
+    server.head = server.count = server.returned_count = server.closed_count = server.stopping = 0;
+    pthread_mutex_init(&server.lock, NULL);
+    pthread_cond_init(&server.changed, NULL);
+
+    while(workers < opts->jobs && !pthread_create(&threads[workers], NULL, runServerWorker, &server))
+        workers++;
+    if(!workers) fprintf(stderr, "%s\n", getError(ALLOC_FAILED));
+    else {
+        logPrintf(">>> Serving on %s with %d workers\n", opts->serve_path, workers);
+        fflush(stdout);
+        pollConnections(&server);
+    }
+
+    /* Let the workers finish the queued requests, then leave */
+    pthread_mutex_lock(&server.lock);
+    server.stopping = 1;
+    pthread_cond_broadcast(&server.changed);
+    pthread_mutex_unlock(&server.lock);
+    for(i = 0; i < workers; i++)
+        pthread_join(threads[i], NULL);
+    for(i = 0; i < server.returned_count; i++)
+        closeConnection(server.returned[i]);
+
+    close(server.listen_fd);
+    close(server.wake_fds[0]);
+    close(server.wake_fds[1]);
+    unlink(opts->serve_path);
+    pthread_cond_destroy(&server.changed);
+    pthread_mutex_destroy(&server.lock);
+    if(workers) logPrintf(">>> Stopped serving on %s\n", opts->serve_path);
+    return !workers;
+}
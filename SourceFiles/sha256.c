@@ -0,0 +1,151 @@
+/**
+ * @author Tal Figenblat
+ * @date October 17, 2026
+ *
+ * @file sha256.c
+ * @brief Contains functions for computing SHA-256 digests, as specified in FIPS 180-4.
+ */
+
+#include <string.h>
+#include "sha256.h"
+
+/**
+ * @def ROTR
+ * @brief Rotates a 32-bit word right.
+ */
+#define ROTR(x, n) ((((x) >> (n)) | ((x) << (32 - (n)))) & 0xFFFFFFFFUL)
+
+/**
+ * @brief The round constants: the fractional parts of the cube roots of the first 64 primes.
+ */
+static const unsigned long round_constants[64] = {
+        0x428a2f98UL, 0x71374491UL, 0xb5c0fbcfUL, 0xe9b5dba5UL, 0x3956c25bUL, 0x59f111f1UL, 0x923f82a4UL, 0xab1c5ed5UL,
+        0xd807aa98UL, 0x12835b01UL, 0x243185beUL, 0x550c7dc3UL, 0x72be5d74UL, 0x80deb1feUL, 0x9bdc06a7UL, 0xc19bf174UL,
+        0xe49b69c1UL, 0xefbe4786UL, 0x0fc19dc6UL, 0x240ca1ccUL, 0x2de92c6fUL, 0x4a7484aaUL, 0x5cb0a9dcUL, 0x76f988daUL,
+        0x983e5152UL, 0xa831c66dUL, 0xb00327c8UL, 0xbf597fc7UL, 0xc6e00bf3UL, 0xd5a79147UL, 0x06ca6351UL, 0x14292967UL,
+        0x27b70a85UL, 0x2e1b2138UL, 0x4d2c6dfcUL, 0x53380d13UL, 0x650a7354UL, 0x766a0abbUL, 0x81c2c92eUL, 0x92722c85UL,
+        0xa2bfe8a1UL, 0xa81a664bUL, 0xc24b8b70UL, 0xc76c51a3UL, 0xd192e819UL, 0xd6990624UL, 0xf40e3585UL, 0x106aa070UL,
+        0x19a4c116UL, 0x1e376c08UL, 0x2748774cUL, 0x34b0bcb5UL, 0x391c0cb3UL, 0x4ed8aa4aUL, 0x5b9cca4fUL, 0x682e6ff3UL,
+        0x748f82eeUL, 0x78a5636fUL, 0x84c87814UL, 0x8cc70208UL, 0x90befffaUL, 0xa4506cebUL, 0xbef9a3f7UL, 0xc67178f2UL
+};
+
+/**
+ * @brief Starts a SHA-256 computation.
+ *
+ * @param ctx Pointer to the computation.
+ */
+void initSha256(sha256_ctx *ctx) {
+    ctx->state[0] = 0x6a09e667UL;
+    ctx->state[1] = 0xbb67ae85UL;
+    ctx->state[2] = 0x3c6ef372UL;
+    ctx->state[3] = 0xa54ff53aUL;
+    ctx->state[4] = 0x510e527fUL;
+    ctx->state[5] = 0x9b05688cUL;
+    ctx->state[6] = 0x1f83d9abUL;
+    ctx->state[7] = 0x5be0cd19UL;
+    ctx->block_len = 0;
+    ctx->bits_low = 0;
+    ctx->bits_high = 0;
+}
+
+/**
+ * @brief Processes one full block of a SHA-256 computation.
+ *
+ * @param ctx Pointer to the computation.
+ * @param block The block.
+ */
+void processSha256Block(sha256_ctx *ctx, const unsigned char *block) {
+    unsigned long w[64], a, b, c, d, e, f, g, h, t1, t2;
+    int i;
+
+    for(i = 0; i < 16; i++)
+        w[i] = ((unsigned long)block[i * 4] << 24) | ((unsigned long)block[i * 4 + 1] << 16) |
+               ((unsigned long)block[i * 4 + 2] << 8) | (unsigned long)block[i * 4 + 3];
+    for(i = 16; i < 64; i++) {
+        t1 = ROTR(w[i - 2], 17) ^ ROTR(w[i - 2], 19) ^ (w[i - 2] >> 10);
+        t2 = ROTR(w[i - 15], 7) ^ ROTR(w[i - 15], 18) ^ (w[i - 15] >> 3);
+        w[i] = (t1 + w[i - 7] + t2 + w[i - 16]) & 0xFFFFFFFFUL;
+    }
+
+    a = ctx->state[0], b = ctx->state[1], c = ctx->state[2], d = ctx->state[3];
+    e = ctx->state[4], f = ctx->state[5], g = ctx->state[6], h = ctx->state[7];
+
+    for(i = 0; i < 64; i++) {
+        t1 = h + (ROTR(e, 6) ^ ROTR(e, 11) ^ ROTR(e, 25)) + ((e & f) ^ (~e & g)) + round_constants[i] + w[i];
+        t2 = (ROTR(a, 2) ^ ROTR(a, 13) ^ ROTR(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+        h = g, g = f, f = e;
+        e = (d + t1) & 0xFFFFFFFFUL;
+        d = c, c = b, b = a;
+        a = (t1 + t2) & 0xFFFFFFFFUL;
+    }
+
+    ctx->state[0] = (ctx->state[0] + a) & 0xFFFFFFFFUL;
+    ctx->state[1] = (ctx->state[1] + b) & 0xFFFFFFFFUL;
+    ctx->state[2] = (ctx->state[2] + c) & 0xFFFFFFFFUL;
+    ctx->state[3] = (ctx->state[3] + d) & 0xFFFFFFFFUL;
+    ctx->state[4] = (ctx->state[4] + e) & 0xFFFFFFFFUL;
+    ctx->state[5] = (ctx->state[5] + f) & 0xFFFFFFFFUL;
+    ctx->state[6] = (ctx->state[6] + g) & 0xFFFFFFFFUL;
+    ctx->state[7] = (ctx->state[7] + h) & 0xFFFFFFFFUL;
+}
+
+/**
+ * @brief Adds bytes to a SHA-256 computation.
+ *
+ * @param ctx Pointer to the computation.
+ * @param data The bytes to add.
+ * @param len Number of bytes to add.
+ */
+void updateSha256(sha256_ctx *ctx, const void *data, size_t len) {
+    const unsigned char *bytes = (const unsigned char *)data;
+    size_t n;
+
+    /* Count the message length in bits, on 64 bits split in two words */
+    ctx->bits_low = (ctx->bits_low + ((unsigned long)len << 3)) & 0xFFFFFFFFUL;
+    if(ctx->bits_low < (((unsigned long)len << 3) & 0xFFFFFFFFUL)) ctx->bits_high++;
+    ctx->bits_high = (ctx->bits_high + ((unsigned long)len >> 29)) & 0xFFFFFFFFUL;
+
+    while(len) {
+        /* Process full blocks straight from the input */
+        if(!ctx->block_len && len >= SHA256_BLOCK_SIZE) {
+            processSha256Block(ctx, bytes);
+            bytes += SHA256_BLOCK_SIZE, len -= SHA256_BLOCK_SIZE;
+            continue;
+        }
+
+        n = SHA256_BLOCK_SIZE - ctx->block_len;
+        if(n > len) n = len;
+        memcpy(ctx->block + ctx->block_len, bytes, n);
+        ctx->block_len += n, bytes += n, len -= n;
+
+        if(ctx->block_len == SHA256_BLOCK_SIZE) {
+            processSha256Block(ctx, ctx->block);
+            ctx->block_len = 0;
+        }
+    }
+}
+
+/**
+ * @brief Finishes a SHA-256 computation.
+ *
+ * @param ctx Pointer to the computation.
+ * @param digest Receives the digest.
+ */
+void finishSha256(sha256_ctx *ctx, unsigned char digest[SHA256_DIGEST_SIZE]) {
+    unsigned char length[8];
+    unsigned char pad = 0x80, zero = 0;
+    unsigned long high = ctx->bits_high, low = ctx->bits_low;
+    int i;
+
+    /* Append the bit 1, zeros up to 8 bytes before a block boundary, then the length */
+    for(i = 0; i < 4; i++) {
+        length[i] = (unsigned char)(high >> (24 - i * 8));
+        length[i + 4] = (unsigned char)(low >> (24 - i * 8));
+    }
+    updateSha256(ctx, &pad, 1);
+    while(ctx->block_len != SHA256_BLOCK_SIZE - 8) updateSha256(ctx, &zero, 1);
+    updateSha256(ctx, length, 8);
+
+    for(i = 0; i < 32; i++)
+        digest[i] = (unsigned char)(ctx->state[i / 4] >> (24 - (i % 4) * 8));
+}
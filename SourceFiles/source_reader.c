@@ -0,0 +1,202 @@
+/**
+ * @author Tal Figenblat
+ * @date October 17, 2026
+ *
+ * @file source_reader.c
+ * @brief Contains functions for reading source text in one call and visiting its lines in place.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "file_utils.h"
+#include "errors_handling.h"
+#include "log_utils.h"
+#include "stats.h"
+#include "source_reader.h"
+
+/**
+ * @brief Reads a whole file into memory and indexes its lines.
+ *
+ * @param src Pointer to the source text to fill.
+ * @param file_name The name of the file (without extension).
+ * @param suffix The suffix of the file.
+ * @return EXIT_SUCCESS if the file was read, EXIT_FAILURE otherwise.
+ */
+int readSourceFile(source_text *src, const char *file_name, const char *suffix) {
+    char *name = append_suffix(file_name, suffix), *data = NULL, *new_data;
+    size_t len = 0, size;
+    ssize_t n = 0;
+    struct stat st;
+    int fd;
+
+    if(!name) return EXIT_FAILURE;
+    fd = open(name, O_RDONLY);
+    if(fd < 0) {
+        logErrorf("    %s %s\n", getError(FILE_OPEN_FAILED), name);
+        free(name);
+        return EXIT_FAILURE;
+    }
+
+    /* Size the buffer after the file, so a regular file is read with a single call */
+    size = !fstat(fd, &st) && st.st_size > 0 ? (size_t)st.st_size + 1 : SOURCE_READ_INIT_SIZE;
+
+    while(1) {
+        /* Grow the buffer when it is full, keeping room for the null terminator */
+        if(!data || len + 1 == size) {
+            if(data) size *= 2;
+            new_data = (char *)realloc(data, size);
+            if(!new_data) {
+                logErrorf("    %s\n", getError(ALLOC_FAILED));
+                break;
+            }
+            data = new_data;
+        }
+
+        n = read(fd, data + len, size - len - 1);
+        if(n < 0 && errno == EINTR) continue;
+        if(n < 0) logErrorf("    %s %s\n", getError(FILE_OPEN_FAILED), name);
+        if(n <= 0) break;
+        len += n;
+    }
+    close(fd);
+    free(name);
+
+    /* Reading stops at the end of the file, or on an error that was already reported */
+    if(n || !data || indexSourceText(src, data, len)) {
+        if(data && !n) logErrorf("    %s\n", getError(ALLOC_FAILED));
+        free(data);
+        return EXIT_FAILURE;
+    }
+    data[len] = '\0';
+    src->owns_data = 1;
+    src->size = size;
+    noteHeapAlloc(size);
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Indexes the lines of text that is already in memory.
+ *
+ * @param src Pointer to the source text to fill.
+ * @param data The text.
+ * @param len Length of the text, in bytes.
+ * @return EXIT_SUCCESS if the text was indexed, EXIT_FAILURE if memory allocation failed.
+ */
+int indexSourceText(source_text *src, char *data, size_t len) {
+    const char *ptr = data, *end = data + len, *nl;
+    int count = 0, i = 0;
+
+    /* Count the lines first, so the index is allocated once */
+    while(ptr < end && (nl = (const char *)memchr(ptr, '\n', end - ptr))) count++, ptr = nl + 1;
+    if(ptr < end) count++;
+
+    src->starts = (size_t *)malloc(sizeof(size_t) * (count + 1));
+    if(!src->starts) return EXIT_FAILURE;
+    noteHeapAlloc(sizeof(size_t) * (count + 1));
+
+    for(ptr = data; i < count; i++) {
+        src->starts[i] = ptr - data;
+        nl = (const char *)memchr(ptr, '\n', end - ptr);
+        ptr = nl ? nl + 1 : end;
+    }
+    src->starts[count] = len;
+
+    src->data = data;
+    src->len = len;
+    src->line_count = count;
+    src->owns_data = 0;
+    src->size = 0;
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Copies text given in memory and indexes its lines.
+ *
+ * @param src Pointer to the source text to fill.
+ * @param text The text, which does not have to be null-terminated.
+ * @param len Length of the text, in bytes.
+ * @return EXIT_SUCCESS if the text was copied and indexed, EXIT_FAILURE if memory allocation failed.
+ */
+int copySourceText(source_text *src, const char *text, size_t len) {
+    char *data = (char *)malloc(len + 1);
+
+    if(!data) return EXIT_FAILURE;
+    if(len) memcpy(data, text, len);
+    data[len] = '\0';
+
+    if(indexSourceText(src, data, len)) {
+        free(data);
+        return EXIT_FAILURE;
+    }
+    src->owns_data = 1;
+    src->size = len + 1;
+    noteHeapAlloc(len + 1);
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Returns the length of a line, without its newline character.
+ *
+ * @param src Pointer to the source text.
+ * @param i Index of the line.
+ * @return The number of characters in the line.
+ */
+size_t getLineLength(const source_text *src, int i) {
+    size_t len = src->starts[i + 1] - src->starts[i];
+
+    if(len && src->data[src->starts[i + 1] - 1] == '\n') len--;
+    return len;
+}
+
+/**
+ * @brief Opens a view of a line, null-terminating it in place.
+ *
+ * @param src Pointer to the source text.
+ * @param i Index of the line.
+ * @param max_len Maximum number of characters seen through the view.
+ * @param view Pointer to the view to open.
+ * @return Pointer to the characters of the line.
+ */
+char *openLineView(source_text *src, int i, size_t max_len, line_view *view) {
+    view->text = src->data + src->starts[i];
+    view->len = src->starts[i + 1] - src->starts[i];
+    if(view->len > max_len) view->len = max_len;
+
+    view->saved = view->text[view->len];
+    view->text[view->len] = '\0';
+    return view->text;
+}
+
+/**
+ * @brief Closes a view of a line, restoring the character replaced by the null terminator.
+ *
+ * Closing a view that is already closed has no effect.
+ *
+ * @param view Pointer to the view to close.
+ */
+void closeLineView(line_view *view) {
+    if(!view->text) return;
+    view->text[view->len] = view->saved;
+    view->text = NULL;
+}
+
+/**
+ * @brief Frees the memory of a source text.
+ *
+ * @param src Pointer to the source text.
+ */
+void freeSourceText(source_text *src) {
+    if(src->owns_data) noteHeapFree(src->size);
+    if(src->starts) noteHeapFree(sizeof(size_t) * (src->line_count + 1));
+    if(src->owns_data) free(src->data);
+    free(src->starts);
+    src->data = NULL;
+    src->starts = NULL;
+    src->len = 0;
+    src->line_count = 0;
+    src->owns_data = 0;
+}
@@ -0,0 +1,271 @@
+/**
+ * @author Tal Figenblat
+ * @date October 17, 2026
+ *
+ * @file stats.c
+ * @brief Contains functions for gathering and reporting the statistics of each file.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+#include "stats.h"
+
+/* Key of the statistics attached to each thread, valid once stats_key_ready is set */
+static pthread_key_t stats_key;
+static int stats_key_ready = 0;
+
+/* Creates the key once, even when several threads ask for it at the same time */
+static pthread_once_t stats_key_once = PTHREAD_ONCE_INIT;
+
+/* Names of the phases, as they appear in the reports */
+static const char *phase_names[PHASE_COUNT] = {"idle", "preprocessor", "first_pass", "second_pass", "output"};
+
+/**
+ * @brief Returns the current wall time.
+ *
+ * @return Seconds since an arbitrary point.
+ */
+static double wallClock(void) {
+    struct timeval now;
+
+    gettimeofday(&now, NULL);
+    return (double)now.tv_sec + (double)now.tv_usec / 1e6;
+}
+
+/**
+ * @brief Creates the key of the statistics attached to each thread.
+ */
+static void createStatsKey(void) {
+    if(!pthread_key_create(&stats_key, NULL)) stats_key_ready = 1;
+}
+
+/**
+ * @brief Enables attaching statistics to threads.
+ *
+ * Safe to call from several threads at once: the key is created by the first call only.
+ *
+ * @return EXIT_SUCCESS if statistics can be attached, EXIT_FAILURE otherwise.
+ */
+int initThreadStats(void) {
+    pthread_once(&stats_key_once, createStatsKey);
+    return stats_key_ready ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/**
+ * @brief Attaches statistics to the calling thread, stopping the clock of the previous ones.
+ *
+ * @param stats Pointer to the statistics, or NULL to gather none.
+ */
+void setThreadStats(file_stats *stats) {
+    if(!stats_key_ready) return;
+    enterPhase(PHASE_IDLE);
+    pthread_setspecific(stats_key, stats);
+}
+
+/**
+ * @brief Returns the statistics attached to the calling thread.
+ *
+ * @return Pointer to the statistics, or NULL if none are gathered.
+ */
+file_stats *getThreadStats(void) {
+    return stats_key_ready ? (file_stats *)pthread_getspecific(stats_key) : NULL;
+}
+
+/**
+ * @brief Initializes empty statistics for a file.
+ *
+ * @param stats Pointer to the statistics.
+ */
+void initFileStats(file_stats *stats) {
+    memset(stats, 0, sizeof(*stats));
+    stats->phase = PHASE_IDLE;
+    stats->files = 1;
+}
+
+/**
+ * @brief Charges the time since the previous phase started to it, and starts another phase.
+ *
+ * Does nothing if no statistics are attached to the calling thread.
+ *
+ * @param kind The phase that starts.
+ */
+void enterPhase(phase_kind kind) {
+    file_stats *stats = getThreadStats();
+    double now;
+
+    if(!stats) return;
+    now = wallClock();
+    if(stats->phase != PHASE_IDLE) stats->phase_times[stats->phase] += now - stats->phase_start;
+    stats->phase_start = now;
+    stats->phase = kind;
+}
+
+/**
+ * @brief Charges heap memory allocated for the file to the statistics of the calling thread.
+ *
+ * Does nothing if no statistics are attached to the calling thread.
+ *
+ * @param bytes Number of bytes allocated.
+ */
+void noteHeapAlloc(size_t bytes) {
+    file_stats *stats = getThreadStats();
+
+    if(!stats) return;
+    stats->heap_used += (unsigned long)bytes;
+    if(stats->heap_used > stats->heap_peak) stats->heap_peak = stats->heap_used;
+}
+
+/**
+ * @brief Releases heap memory charged to the statistics of the calling thread.
+ *
+ * Does nothing if no statistics are attached to the calling thread.
+ *
+ * @param bytes Number of bytes freed.
+ */
+void noteHeapFree(size_t bytes) {
+    file_stats *stats = getThreadStats();
+
+    /* Memory allocated before the statistics were attached is not charged */
+    if(stats) stats->heap_used = (unsigned long)bytes < stats->heap_used ? stats->heap_used - (unsigned long)bytes : 0;
+}
+
+/**
+ * @brief Adds the statistics of a file to a sum.
+ *
+ * @param total Pointer to the sum.
+ * @param stats Pointer to the statistics of the file.
+ */
+void addFileStats(file_stats *total, const file_stats *stats) {
+    int i;
+
+    for(i = 0; i < PHASE_COUNT; i++)
+        total->phase_times[i] += stats->phase_times[i];
+    total->lines += stats->lines;
+    total->macros_defined += stats->macros_defined;
+    total->macros_expanded += stats->macros_expanded;
+    total->labels += stats->labels;
+    total->label_lookups += stats->label_lookups;
+    total->label_probes += stats->label_probes;
+    total->macro_lookups += stats->macro_lookups;
+    total->macro_probes += stats->macro_probes;
+    total->bytes_read += stats->bytes_read;
+    total->bytes_written += stats->bytes_written;
+    if(stats->heap_peak > total->heap_peak) total->heap_peak = stats->heap_peak;
+    total->files += stats->files;
+}
+
+/**
+ * @brief Writes the statistics of a file, or of all files, in human-readable form.
+ *
+ * @param fp The stream the report is written to.
+ * @param title What the statistics are of.
+ * @param name The name of the file, or NULL for all files.
+ * @param stats Pointer to the statistics.
+ */
+static void writeStatsText(FILE *fp, const char *title, const char *name, const file_stats *stats) {
+    int i;
+
+    if(name) fprintf(fp, ">>> %s %s\n", title, name);
+    else fprintf(fp, ">>> %s %d file%s\n", title, stats->files, stats->files == 1 ? "" : "s");
+
+    fprintf(fp, "    Time (ms):");
+    for(i = PHASE_PREPROCESSOR; i < PHASE_COUNT; i++)
+        fprintf(fp, " %s %.3f%s", phase_names[i], stats->phase_times[i] * 1e3, i + 1 < PHASE_COUNT ? "," : "\n");
+    fprintf(fp, "    Lines: %lu, macros defined: %lu, macros expanded: %lu, labels: %lu\n", stats->lines,
+            stats->macros_defined, stats->macros_expanded, stats->labels);
+#ifdef ASSEMBLER_STATS
+    fprintf(fp, "    Lookups: find_label %lu calls, %lu slots; find_macr %lu calls, %lu slots\n", stats->label_lookups,
+            stats->label_probes, stats->macro_lookups, stats->macro_probes);
+#else
+    fprintf(fp, "    Lookups: not counted in this build\n");
+#endif
+    fprintf(fp, "    Bytes read: %lu, bytes written: %lu, heap peak: %lu\n", stats->bytes_read, stats->bytes_written,
+            stats->heap_peak);
+}
+
+/**
+ * @brief Writes a string as a JSON string.
+ *
+ * @param fp The stream.
+ * @param str The string.
+ */
+static void writeJsonString(FILE *fp, const char *str) {
+    fputc('"', fp);
+    for(; *str; str++) {
+        if(*str == '"' || *str == '\\') fprintf(fp, "\\%c", *str);
+        else if((unsigned char)*str < 0x20) fprintf(fp, "\\u%04x", (unsigned)(unsigned char)*str);
+        else fputc(*str, fp);
+    }
+    fputc('"', fp);
+}
+
+/**
+ * @brief Writes the statistics of a file, or of all files, as the members of a JSON object.
+ *
+ * @param fp The stream the report is written to.
+ * @param stats Pointer to the statistics.
+ */
+static void writeStatsJson(FILE *fp, const file_stats *stats) {
+    int i;
+
+    fprintf(fp, "\"time_ms\": {");
+    for(i = PHASE_PREPROCESSOR; i < PHASE_COUNT; i++)
+        fprintf(fp, "\"%s\": %.3f%s", phase_names[i], stats->phase_times[i] * 1e3, i + 1 < PHASE_COUNT ? ", " : "}");
+    fprintf(fp, ", \"lines\": %lu, \"macros_defined\": %lu, \"macros_expanded\": %lu, \"labels\": %lu", stats->lines,
+            stats->macros_defined, stats->macros_expanded, stats->labels);
+#ifdef ASSEMBLER_STATS
+    fprintf(fp, ", \"label_lookups\": %lu, \"label_probes\": %lu, \"macro_lookups\": %lu, \"macro_probes\": %lu",
+            stats->label_lookups, stats->label_probes, stats->macro_lookups, stats->macro_probes);
+#else
+    fprintf(fp, ", \"label_lookups\": null, \"label_probes\": null, \"macro_lookups\": null, \"macro_probes\": null");
+#endif
+    fprintf(fp, ", \"bytes_read\": %lu, \"bytes_written\": %lu, \"heap_peak\": %lu", stats->bytes_read,
+            stats->bytes_written, stats->heap_peak);
+}
+
+/**
+ * @brief Writes the statistics of each file and their sum.
+ *
+ * @param fp The stream the report is written to.
+ * @param format The format of the report.
+ * @param names The name of each file.
+ * @param stats The statistics of each file.
+ * @param count Number of files.
+ * @return EXIT_SUCCESS if the report was written, EXIT_FAILURE otherwise.
+ */
+int writeStatsReport(FILE *fp, stats_format format, char **names, const file_stats *stats, int count) {
+    file_stats total;
+    struct rusage usage;
+    long max_rss = 0;
+    int i;
+
+    memset(&total, 0, sizeof(total));
+    for(i = 0; i < count; i++)
+        addFileStats(&total, &stats[i]);
+    if(!getrusage(RUSAGE_SELF, &usage)) max_rss = usage.ru_maxrss;
+
+    if(format == STATS_JSON) {
+        fprintf(fp, "{\"files\": [");
+        for(i = 0; i < count; i++) {
+            fprintf(fp, "%s{\"name\": ", i ? ", " : "");
+            writeJsonString(fp, names[i]);
+            fprintf(fp, ", ");
+            writeStatsJson(fp, &stats[i]);
+            fprintf(fp, "}");
+        }
+        fprintf(fp, "], \"total\": {\"files\": %d, ", total.files);
+        writeStatsJson(fp, &total);
+        fprintf(fp, "}, \"max_rss_kb\": %ld}\n", max_rss);
+    } else {
+        for(i = 0; i < count; i++)
+            writeStatsText(fp, "Statistics of the file", names[i], &stats[i]);
+        writeStatsText(fp, "Statistics of", NULL, &total);
+        fprintf(fp, "    Max resident set: %ld KB\n", max_rss);
+    }
+
+    return fflush(fp) || ferror(fp) ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -7,62 +7,86 @@
  *
  * This file contains utility functions for extracting tokens from a string and handling
  * strings enclosed in quotes. These functions are used during the assembly process to
- * parse and process the assembly source files.
+ * parse and process the assembly source files. Tokens are returned as spans of the source
+ * line, so they are never copied.
  */
 
 #include <ctype.h>
+#include <string.h>
 #include "token_utils.h"
 #include "errors_handling.h"
+#include "char_classes.h"
 
 /**
- * @brief Extracts the next token from the input string.
+ * @brief Makes a span covering a whole null-terminated string.
  *
- * This function extracts the next token from the input string `*ptr`, delimited by the specified
- * delimiter character. It copies the token into the `dest` buffer and updates `*ptr` to point
- * to the next token or character in the input string.
+ * @param str The string.
+ * @return The span of the string.
+ */
+text_span makeSpan(const char *str) {
+    text_span span;
+
+    span.text = str;
+    span.len = strlen(str);
+    return span;
+}
+
+/**
+ * @brief Compares a span with a null-terminated string.
  *
- * @param dest Pointer to the buffer where the extracted token will be stored.
+ * @param span The span to compare.
+ * @param str The string to compare with.
+ * @return 1 if the span holds exactly the characters of the string, 0 otherwise.
+ */
+int spanEquals(text_span span, const char *str) {
+    return !strncmp(span.text, str, span.len) && !str[span.len];
+}
+
+/**
+ * @brief Finds the next token of the input string without copying it.
+ *
+ * Skips whitespace and delimiters, then returns the following run of characters that are neither,
+ * as a span of the input.
+ *
+ * @param dest Pointer to the span receiving the token; its length is 0 if there is no token.
  * @param ptr Pointer to the current position in the input string.
  * @param delim The delimiter character used to separate tokens.
  * @return int The number of delimiters encountered before the token.
  */
-int nextToken(char *dest, char **ptr, const char delim) {
+int nextSpan(text_span *dest, char **ptr, const char delim) {
     int count = 0;
 
     /* Skip leading whitespace and delimiters */
-    while(**ptr && (isspace(**ptr) || **ptr == delim)) {
+    while(**ptr && (IS_SPACE(**ptr) || **ptr == delim)) {
         if(**ptr == delim)
             count++;
         (*ptr)++;
     }
 
-    /* Extract the token */
-    while(**ptr && !isspace(**ptr) && **ptr != delim) {
-        *dest = **ptr;
-        dest++;
-        (*ptr)++;
-    }
+    /* Find the end of the token */
+    dest->text = *ptr;
+    while(**ptr && !IS_SPACE(**ptr) && **ptr != delim) (*ptr)++;
 
-    *dest = '\0';
+    dest->len = *ptr - dest->text;
     return count;
 }
 
 /**
  * @brief Extracts a string enclosed in double quotes from the input string.
  *
- * This function extracts a string enclosed in double quotes from the input string `*ptr`.
- * It copies the string into the `dest` buffer and updates `*ptr` to point to the character
- * following the closing quote. If the string is not properly enclosed or contains invalid
- * characters, an error is reported.
+ * This function finds a string enclosed in double quotes in the input string `*ptr`.
+ * It sets `dest` to the characters between the quotes, without copying them, and updates `*ptr`
+ * to point to the character following the closing quote. If the string is not properly enclosed
+ * or contains invalid characters, an error is reported.
  *
- * @param dest Pointer to the buffer where the extracted string will be stored.
+ * @param dest Pointer to the span receiving the characters between the quotes.
  * @param ptr Pointer to the current position in the input string.
  * @param line_counter The line number in the source file, used for error reporting.
  * @return int Returns 0 if the string is extracted successfully, or 1 if an error occurs.
  */
-int nextString(char *dest, char **ptr, int line_counter) {
+int nextString(text_span *dest, char **ptr, int line_counter) {
     /* Skip leading whitespace */
-    while(**ptr && isspace(**ptr)) (*ptr)++;
+    while(**ptr && IS_SPACE(**ptr)) (*ptr)++;
     if(!(**ptr)) {
         printError(line_counter, MISSING_STRING);
         return 1;
@@ -72,17 +96,16 @@ int nextString(char *dest, char **ptr, int line_counter) {
     }
 
     (*ptr)++;
-    /* Extract the string */
+    /* Find the end of the string */
+    dest->text = *ptr;
     while(**ptr && **ptr != '\"') {
         if(!isprint(**ptr)) {
             printError(line_counter, INVALID_CHARACTER);
             return 1;
         }
-        *dest = **ptr;
-        dest++;
         (*ptr)++;
     }
-    *dest = '\0';
+    dest->len = *ptr - dest->text;
 
     if(!(**ptr)) {
         printError(line_counter, STRING_NOT_CLOSED_PROPERLY);
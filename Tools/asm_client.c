@@ -0,0 +1,216 @@
+/**
+ * @author Tal Figenblat
+ * @date October 17, 2026
+ *
+ * @file asm_client.c
+ * @brief Client of the assembler server.
+ *
+ * Sends each given source to a server started with "assembler --serve SOCKET", over a single
+ * connection, prints the messages of each source, and writes the outputs next to the sources,
+ * as the assembler itself would. With "--stop", the server is stopped once the sources are done.
+ *
+ * Usage: asm_client SOCKET [--no-emit-am] [--object-format text|binary|both] [--relocations]
+ *                   [--ext-order source|grouped|sorted] [--stop] [file ...]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "server.h"
+#include "pipe_mode.h"
+
+/**
+ * @def FRAME_LINE_SIZE
+ * @brief Maximum length of the header line of a frame.
+ */
+#define FRAME_LINE_SIZE 128
+
+/**
+ * @brief Connects to the server.
+ *
+ * @param path The socket of the server.
+ * @return The connected socket, or -1 if the server could not be reached.
+ */
+static int connectServer(const char *path) {
+    struct sockaddr_un addr;
+    int fd;
+
+    if(strlen(path) >= sizeof(addr.sun_path)) return -1;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, path);
+
+    fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if(fd >= 0 && connect(fd, (struct sockaddr *)&addr, sizeof(addr))) {
+        close(fd);
+        fd = -1;
+    }
+    return fd;
+}
+
+/**
+ * @brief Reads a whole file into memory.
+ *
+ * @param path The file.
+ * @param len Pointer to the variable receiving the length of the file.
+ * @return The content of the file, to be freed by the caller, or NULL on failure.
+ */
+static char *readFile(const char *path, size_t *len) {
+    FILE *fp = fopen(path, "rb");
+    char *data = NULL, *grown;
+    size_t size = 0, n;
+
+    if(!fp) return NULL;
+    *len = 0;
+    do {
+        if(*len == size) {
+            size = size ? size * 2 : 4096;
+            if(!(grown = (char *)realloc(data, size))) {
+                free(data);
+                fclose(fp);
+                return NULL;
+            }
+            data = grown;
+        }
+        n = fread(data + *len, 1, size - *len, fp);
+        *len += n;
+    } while(n);
+
+    if(ferror(fp)) {
+        free(data);
+        data = NULL;
+    }
+    fclose(fp);
+    return data;
+}
+
+/**
+ * @brief Reads the answer to a request, printing the messages and writing the outputs.
+ *
+ * @param in The connection.
+ * @param name The name of the source, without its extension.
+ * @param result Pointer to the variable receiving the result of the request.
+ * @return EXIT_SUCCESS if the whole answer was read, EXIT_FAILURE otherwise.
+ */
+static int readAnswer(FILE *in, const char *name, int *result) {
+    char line[FRAME_LINE_SIZE], frame[FRAME_LINE_SIZE], path[FILENAME_MAX], chunk[4096];
+    unsigned long len;
+    size_t n;
+    FILE *out;
+
+    if(!fgets(line, sizeof(line), in) || sscanf(line, STREAM_MAGIC " %d", result) != 1)
+        return EXIT_FAILURE;
+
+    while(fgets(line, sizeof(line), in) && strcmp(line, "end\n")) {
+        if(sscanf(line, "%127s %lu", frame, &len) != 2) return EXIT_FAILURE;
+
+        /* The messages go to the standard output, the diagnostics are only for programs */
+        out = NULL;
+        if(!strcmp(frame, "log")) out = stdout;
+        else if(strcmp(frame, "diag")) {
+            if(strlen(name) + strlen(frame) + 2 > sizeof(path)) return EXIT_FAILURE;
+            sprintf(path, "%s.%s", name, frame);
+            if(!(out = fopen(path, "wb"))) fprintf(stderr, "Unable to write the file %s\n", path);
+        }
+
+        while(len) {
+            n = fread(chunk, 1, len < sizeof(chunk) ? (size_t)len : sizeof(chunk), in);
+            if(!n) break;
+            if(out) fwrite(chunk, 1, n, out);
+            len -= n;
+        }
+        if(out && out != stdout) fclose(out);
+        if(len) return EXIT_FAILURE;
+    }
+
+    return strcmp(line, "end\n") ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+/**
+ * @brief Sends the given sources to the server and writes back their outputs.
+ *
+ * @param argc The number of command-line arguments.
+ * @param argv The array of command-line arguments.
+ * @return int Returns 1 if errors were found, otherwise returns 0.
+ */
+int main(int argc, char *argv[]) {
+    int i, fd, result, foundErr = 0, stop = 0;
+    const char *flags = "", *format = "", *relocations = "", *order = "";
+    char path[FILENAME_MAX], *data;
+    size_t len;
+    FILE *in, *out;
+
+    if(argc < 2) {
+        fprintf(stderr, "Usage: %s SOCKET [--no-emit-am] [--object-format text|binary|both] [--relocations] "
+                "[--ext-order source|grouped|sorted] [--stop] [file ...]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    for(i = 2; i < argc; i++) {
+        if(!strcmp(argv[i], "--no-emit-am")) flags = " no-emit-am";
+        else if(!strcmp(argv[i], "--stop")) stop = 1;
+        else if(!strcmp(argv[i], "--relocations")) relocations = " relocations";
+        else if(!strcmp(argv[i], "--object-format") && i + 1 < argc) {
+            i++;
+            if(!strcmp(argv[i], "text")) format = " object-text";
+            else if(!strcmp(argv[i], "binary")) format = " object-binary";
+            else if(!strcmp(argv[i], "both")) format = " object-both";
+        }
+        else if(!strcmp(argv[i], "--ext-order") && i + 1 < argc) {
+            i++;
+            if(!strcmp(argv[i], "source")) order = " ext-source";
+            else if(!strcmp(argv[i], "grouped")) order = " ext-grouped";
+            else if(!strcmp(argv[i], "sorted")) order = " ext-sorted";
+        }
+    }
+
+    if((fd = connectServer(argv[1])) < 0 || !(in = fdopen(fd, "r")) || !(out = fdopen(dup(fd), "w"))) {
+        fprintf(stderr, "Unable to connect to %s\n", argv[1]);
+        return EXIT_FAILURE;
+    }
+
+    for(i = 2; i < argc; i++) {
+        /* Skip the options, and the values of "--object-format" and "--ext-order" */
+        if(!strcmp(argv[i], "--object-format") || !strcmp(argv[i], "--ext-order")) {
+            i++;
+            continue;
+        }
+        if(!strncmp(argv[i], "--", 2)) continue;
+
+        /* The name in the request must fit on its header line */
+        if(strlen(argv[i]) + 4 > sizeof(path) || strlen(argv[i]) > REQUEST_LINE_SIZE / 2 || strchr(argv[i], ' ')) {
+            fprintf(stderr, "Invalid file name %s\n", argv[i]);
+            foundErr = 1;
+            continue;
+        }
+        sprintf(path, "%s.as", argv[i]);
+        if(!(data = readFile(path, &len))) {
+            fprintf(stderr, "Unable to open the file %s\n", path);
+            foundErr = 1;
+            continue;
+        }
+
+        fprintf(out, "%s source %s %lu%s%s%s%s\n", REQUEST_MAGIC, argv[i], (unsigned long)len, flags, format,
+                relocations, order);
+        fwrite(data, 1, len, out);
+        free(data);
+        if(fflush(out) || readAnswer(in, argv[i], &result)) {
+            fprintf(stderr, "The server closed the connection\n");
+            foundErr = 1;
+            break;
+        }
+        if(result) foundErr = 1;
+    }
+
+    if(stop) {
+        fprintf(out, "%s stop - 0\n", REQUEST_MAGIC);
+        if(fflush(out) || readAnswer(in, "-", &result)) foundErr = 1;
+    }
+
+    fclose(out);
+    fclose(in);
+    return foundErr;
+}
@@ -0,0 +1,81 @@
+/**
+ * @author Tal Figenblat
+ * @date October 17, 2026
+ *
+ * @file asm_link.c
+ * @brief Linker of assembled objects into a single memory image.
+ *
+ * Each NAME is read from NAME.obj if it exists, and from NAME.ob, NAME.ent and NAME.ext
+ * otherwise. The objects are relocated one after the other, every use of an external label
+ * is patched with the address of the entry label of the same name, and the image is written
+ * to OUT.ob and OUT.ent (or OUT.obj), "linked" by default. Nothing is written if an entry
+ * label is exported twice or an external label is not exported by any object.
+ *
+ * Usage: asm_link [-o OUT] [-j N] [--large] [--object-format text|binary|both] NAME ...
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "linker.h"
+#include "options.h"
+#include "first_pass.h"
+#include "segment.h"
+#include "errors_handling.h"
+
+/**
+ * @brief Links the objects given on the command line.
+ *
+ * @param argc The number of command-line arguments.
+ * @param argv The array of command-line arguments.
+ * @return int Returns 1 if the objects could not be linked, otherwise returns 0.
+ */
+int main(int argc, char *argv[]) {
+    const char *output = "linked", *value;
+    object_format format = OBJECT_TEXT;
+    long limit = MEMORY_SIZE;
+    int i, count = 0, jobs = 1, foundErr;
+    char **names = (char **)malloc(sizeof(char *) * argc);
+    linker lk;
+
+    if(!names || initThreadLogs()) {
+        fprintf(stderr, "%s\n", getError(ALLOC_FAILED));
+        free(names);
+        return 1;
+    }
+
+    for(i = 1; i < argc; i++) {
+        value = i + 1 < argc ? argv[i + 1] : NULL;
+        if(!strcmp(argv[i], "-o") && value) output = argv[++i];
+        else if(!strcmp(argv[i], "-j") && value && !parseJobs(value, &jobs)) i++;
+        else if(!strcmp(argv[i], "--large")) limit = LARGE_MEMORY_SIZE;
+        else if(!strcmp(argv[i], "--object-format") && value && !strcmp(value, "text")) format = OBJECT_TEXT, i++;
+        else if(!strcmp(argv[i], "--object-format") && value && !strcmp(value, "binary")) format = OBJECT_BINARY, i++;
+        else if(!strcmp(argv[i], "--object-format") && value && !strcmp(value, "both")) format = OBJECT_BOTH, i++;
+        else if(argv[i][0] == '-') {
+            fprintf(stderr, "%s %s\n", getError(INVALID_OPTION_VALUE), argv[i]);
+            count = 0;
+            break;
+        }
+        else names[count++] = argv[i];
+    }
+    if(!count) {
+        fprintf(stderr, "Usage: %s [-o OUT] [-j N] [--large] [--object-format text|binary|both] NAME ...\n", argv[0]);
+        free(names);
+        return 1;
+    }
+
+    if(initLinker(&lk, names, count, jobs, limit)) {
+        fprintf(stderr, "%s\n", getError(ALLOC_FAILED));
+        free(names);
+        return 1;
+    }
+    foundErr = linkObjects(&lk);
+    if(!foundErr) foundErr = writeLinkedImage(&lk, output, format);
+    if(!foundErr) printf("Linked %d objects into %s: %ld instruction words, %ld data words, %ld entry labels\n",
+                         count, output, lk.ic, lk.dc, lk.export_count);
+
+    freeLinker(&lk);
+    free(names);
+    return foundErr ? 1 : 0;
+}
@@ -0,0 +1,241 @@
+/**
+ * @author Tal Figenblat
+ * @date October 17, 2026
+ *
+ * @file asm_rebase.c
+ * @brief Moves an assembled image to another load address, without assembling it again.
+ *
+ * Reads NAME.ob and the relocation table NAME.rel written with the "--relocations" option,
+ * and writes the image loaded at the new base to OUT.ob (NAME.ob by default). The words listed
+ * in the relocation table get the new addresses, in a single pass over the image; every other
+ * word is copied as is. The relocation table, and NAME.ent and NAME.ext if they exist, are
+ * moved along, so the image can be rebased again. Nothing is written if an error is found.
+ *
+ * Usage: asm_rebase --base N [-o OUT] NAME
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "output_writer.h"
+#include "opcode_utils.h"
+#include "build_cache.h"
+#include "file_utils.h"
+#include "options.h"
+#include "log_utils.h"
+
+/**
+ * @def REBASE_FILE_COUNT
+ * @brief Number of files read and written by the tool.
+ */
+#define REBASE_FILE_COUNT 4
+
+/**
+ * @brief Suffixes of the files read and written: the image, the relocation table, the entries and the externals.
+ */
+static const char *rebase_suffixes[REBASE_FILE_COUNT] = {".ob", ".rel", ".ent", ".ext"};
+
+/**
+ * @brief Reads the addresses of the relocation table.
+ *
+ * @param buf Pointer to the content of the table.
+ * @param count Pointer to the variable receiving the number of addresses.
+ * @return The addresses, to be freed by the caller, or NULL if the table is invalid or memory allocation failed.
+ */
+static long *readRelocations(const text_buffer *buf, long *count) {
+    long *relocs, lines = 0;
+    char *ptr, *end;
+
+    *count = 0;
+    for(ptr = buf->data; ptr && (ptr = strchr(ptr, '\n')); ptr++)
+        lines++;
+    if(!(relocs = (long *)malloc(sizeof(long) * (lines + 1)))) return NULL;
+
+    /* The addresses must be increasing, so the image is patched in one pass */
+    for(ptr = buf->data; ptr && *ptr; ptr = end + 1) {
+        relocs[*count] = strtol(ptr, &end, 10);
+        if(end == ptr || *end != '\n' || (*count && relocs[*count] <= relocs[*count - 1])) break;
+        (*count)++;
+    }
+    if(ptr && *ptr) {
+        free(relocs);
+        return NULL;
+    }
+    return relocs;
+}
+
+/**
+ * @brief Writes the image loaded at a new base, patching the listed words in one pass.
+ *
+ * The addresses are formatted as the assembler formats them.
+ *
+ * @param buf Pointer to the content of the ".ob" file.
+ * @param relocs The addresses of the words holding internal addresses, in increasing order.
+ * @param reloc_count Number of addresses.
+ * @param base The new address of the first word.
+ * @param delta Pointer to the variable receiving the amount the image is moved by.
+ * @param w Pointer to the writer of the moved image.
+ * @return EXIT_SUCCESS if the image was moved, EXIT_FAILURE if it is invalid or does not fit at the base.
+ */
+static int moveImage(const text_buffer *buf, const long *relocs, long reloc_count, long base, long *delta,
+                     output_writer *w) {
+    long i, r = 0, IC, DC, address, old_base = base;
+    unsigned long word;
+    char *ptr, *end;
+
+    *delta = 0;
+    if(!buf->data || sscanf(buf->data, "%ld %ld", &IC, &DC) != 2 || IC < 0 || DC < 0) return EXIT_FAILURE;
+    ptr = strchr(buf->data, '\n');
+    if(ptr && IC + DC) old_base = strtol(ptr + 1, NULL, 10);
+    *delta = base - old_base;
+
+    writeBytes(w, "  ", 2);
+    writeDecimal(w, (unsigned long)IC);
+    writeChar(w, ' ');
+    writeDecimal(w, (unsigned long)DC);
+    writeChar(w, '\n');
+
+    for(i = 0; ptr && i < IC + DC; i++) {
+        /* Each line is an address followed by an octal word */
+        if(strtol(ptr + 1, &end, 10) != old_base + i || *end != ' ') return EXIT_FAILURE;
+        word = strtoul(end + 1, &ptr, 8);
+        if(*ptr != '\n') return EXIT_FAILURE;
+
+        /* Only words with the "R" bit alone hold internal addresses */
+        if(r < reloc_count && relocs[r] == old_base + i) {
+            address = (long)(word >> 3 & MAX_WORD_ADDRESS) + *delta;
+            if(i >= IC || (word & 7) != 1 << 1 || address < 0 || address > MAX_WORD_ADDRESS) return EXIT_FAILURE;
+            word = ((unsigned long)address << 3 | 1 << 1) & CLEAR_MSB;
+            r++;
+        }
+
+        writeAddress(w, (int)(base + i), i < IC ? i < 1000 : i - IC < 1000);
+        writeChar(w, ' ');
+        writeOctalWord(w, (unsigned short)word);
+    }
+    return ptr && i == IC + DC && !ptr[1] && r == reloc_count ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/**
+ * @brief Writes a file of "[name ]address" lines with every address moved by the same amount.
+ *
+ * @param buf Pointer to the content of the file.
+ * @param delta The amount the addresses are moved by.
+ * @param w Pointer to the writer of the moved file.
+ * @return EXIT_SUCCESS if every line was moved, EXIT_FAILURE if a line is invalid.
+ */
+static int moveAddressLines(const text_buffer *buf, long delta, output_writer *w) {
+    char *ptr, *end, *field, *after;
+    long address;
+
+    for(ptr = buf->data; ptr && *ptr; ptr = end + 1) {
+        if(!(end = strchr(ptr, '\n'))) return EXIT_FAILURE;
+
+        /* The address is the last field of the line */
+        for(field = end; field > ptr && field[-1] != ' '; field--)
+            ;
+        address = strtol(field, &after, 10) + delta;
+        if(after == field || after != end || address < 0) return EXIT_FAILURE;
+
+        writeBytes(w, ptr, (size_t)(field - ptr));
+        writeAddress(w, (int)address, address < 1000);
+        writeChar(w, '\n');
+    }
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Moves the image of a source and its tables to a new base.
+ *
+ * @param name The name of the image (without extension).
+ * @param output The name of the moved image (without extension).
+ * @param base The new address of the first word.
+ * @return EXIT_SUCCESS if the files were written, EXIT_FAILURE otherwise.
+ */
+static int rebaseImage(const char *name, const char *output, long base) {
+    text_buffer in[REBASE_FILE_COUNT], out[REBASE_FILE_COUNT];
+    int i, result, present[REBASE_FILE_COUNT], status = EXIT_SUCCESS;
+    long *relocs = NULL, reloc_count = 0, delta = 0;
+    output_writer w;
+    char *path;
+
+    for(i = 0; i < REBASE_FILE_COUNT; i++) {
+        present[i] = 0;
+        initTextBuffer(&in[i]);
+        initTextBuffer(&out[i]);
+    }
+
+    /* Every input is read before any output is written, so an image can be rebased in place */
+    for(i = 0; i < REBASE_FILE_COUNT && !status; i++) {
+        if(!(path = append_suffix(name, rebase_suffixes[i]))) status = EXIT_FAILURE;
+        else {
+            result = readWholeFile(path, &in[i]);
+            present[i] = result == EXIT_SUCCESS;
+            if(result == EXIT_FAILURE || (result == READ_FILE_MISSING && i < 2)) {
+                fprintf(stderr, "Unable to read the file %s\n", path);
+                status = EXIT_FAILURE;
+            }
+        }
+        free(path);
+    }
+    if(!status && !(relocs = readRelocations(&in[1], &reloc_count))) {
+        fprintf(stderr, "Invalid relocation table %s.rel\n", name);
+        status = EXIT_FAILURE;
+    }
+
+    /* Move the image first, which gives the amount the tables are moved by */
+    if(!status && !(status = openMemoryWriter(&w, &out[0]))) {
+        if(moveImage(&in[0], relocs, reloc_count, base, &delta, &w)) {
+            fprintf(stderr, "Invalid image %s.ob, or its addresses do not fit at base %ld\n", name, base);
+            status = EXIT_FAILURE;
+        }
+        if(closeOutputWriter(&w)) status = EXIT_FAILURE;
+    }
+    for(i = 1; i < REBASE_FILE_COUNT && !status; i++) {
+        if(!present[i] || (status = openMemoryWriter(&w, &out[i]))) continue;
+        if(moveAddressLines(&in[i], delta, &w)) {
+            fprintf(stderr, "Invalid line in the file %s%s\n", name, rebase_suffixes[i]);
+            status = EXIT_FAILURE;
+        }
+        if(closeOutputWriter(&w)) status = EXIT_FAILURE;
+    }
+
+    for(i = 0; i < REBASE_FILE_COUNT && !status; i++) {
+        if(!present[i] || (status = openOutputWriter(&w, output, rebase_suffixes[i]))) continue;
+        writeBytes(&w, out[i].data ? out[i].data : "", out[i].len);
+        status = closeOutputWriter(&w);
+    }
+
+    for(i = 0; i < REBASE_FILE_COUNT; i++) {
+        freeTextBuffer(&in[i]);
+        freeTextBuffer(&out[i]);
+    }
+    free(relocs);
+    return status;
+}
+
+/**
+ * @brief Moves the image given on the command line.
+ *
+ * @param argc The number of command-line arguments.
+ * @param argv The array of command-line arguments.
+ * @return int Returns 1 if the image could not be moved, otherwise returns 0.
+ */
+int main(int argc, char *argv[]) {
+    const char *name = NULL, *output = NULL;
+    int i, base = 0, valid = 1;
+
+    for(i = 1; i < argc && valid; i++) {
+        if(!strcmp(argv[i], "--base") && i + 1 < argc) valid = !parsePositive(argv[++i], MAX_WORD_ADDRESS, &base);
+        else if(!strcmp(argv[i], "-o") && i + 1 < argc) output = argv[++i];
+        else if(argv[i][0] != '-' && !name) name = argv[i];
+        else valid = 0;
+    }
+    if(!valid || !name || !base) {
+        fprintf(stderr, "Usage: %s --base N [-o OUT] NAME\n", argv[0]);
+        return 1;
+    }
+    if(initThreadLogs()) return 1;
+
+    return rebaseImage(name, output ? output : name, base) ? 1 : 0;
+}
@@ -0,0 +1,139 @@
+/**
+ * @author Tal Figenblat
+ * @date October 17, 2026
+ *
+ * @file obj_convert.c
+ * @brief Converter between the binary object file and the text ".ob", ".ent" and ".ext" files.
+ *
+ * With "--to-text" (the default), maps each NAME.obj and writes NAME.ob, with NAME.ent and
+ * NAME.ext when it has entry or external labels, exactly as the assembler writes them. With
+ * "--to-binary", reads NAME.ob, NAME.ent and NAME.ext, the last two if they exist, and writes
+ * NAME.obj. Converting the text files of a source to binary and back gives the same files.
+ *
+ * Usage: obj_convert [--to-text | --to-binary] NAME ...
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "object_file.h"
+#include "file_utils.h"
+#include "log_utils.h"
+
+/**
+ * @brief Writes a text file listing symbols, one "name address" line each.
+ *
+ * @param name The name of the object (without extension).
+ * @param suffix The suffix of the file.
+ * @param view Pointer to the view of the object file.
+ * @param entries Whether the entry labels are listed, rather than the uses of external labels.
+ * @return EXIT_SUCCESS if the file was written, EXIT_FAILURE otherwise.
+ */
+static int writeSymbolFile(const char *name, const char *suffix, const object_view *view, int entries) {
+    long i, count = entries ? view->entry_count : view->extern_count;
+    object_symbol sym;
+    output_writer w;
+
+    if(openOutputWriter(&w, name, suffix)) return EXIT_FAILURE;
+    for(i = 0; i < count; i++) {
+        sym = entries ? getObjectEntry(view, i) : getObjectExtern(view, i);
+        writeBytes(&w, sym.name, strlen(sym.name));
+        writeChar(&w, ' ');
+        writeAddress(&w, (int)sym.address, sym.address < 1000);
+        writeChar(&w, '\n');
+    }
+    return closeOutputWriter(&w);
+}
+
+/**
+ * @brief Writes the text files of a binary object file.
+ *
+ * @param name The name of the object (without extension).
+ * @return EXIT_SUCCESS if the files were written, EXIT_FAILURE otherwise.
+ */
+static int convertToText(const char *name) {
+    char *path = append_suffix(name, ".obj");
+    unsigned short *words;
+    object_view view;
+    output_writer w;
+    int status;
+    long i;
+
+    if(!path) return EXIT_FAILURE;
+    if(mapObjectFile(&view, path)) {
+        fprintf(stderr, "Unable to read the object file %s\n", path);
+        free(path);
+        return EXIT_FAILURE;
+    }
+    free(path);
+
+    /* The words are copied out once, so they are printed exactly as the assembler prints them */
+    if(!(words = (unsigned short *)malloc(sizeof(unsigned short) * (view.ic + view.dc + 1)))) {
+        closeObjectView(&view);
+        return EXIT_FAILURE;
+    }
+    for(i = 0; i < view.ic + view.dc; i++)
+        words[i] = getObjectWord(&view, i);
+
+    status = openOutputWriter(&w, name, ".ob");
+    if(!status) {
+        writeBytes(&w, "  ", 2);
+        writeDecimal(&w, (unsigned long)view.ic);
+        writeChar(&w, ' ');
+        writeDecimal(&w, (unsigned long)view.dc);
+        writeChar(&w, '\n');
+        print_instructions(words, (int)view.ic, &w);
+        print_data(words + view.ic, (int)view.ic, (int)view.dc, &w);
+        status = closeOutputWriter(&w);
+    }
+    if(!status && view.entry_count) status = writeSymbolFile(name, ".ent", &view, 1);
+    if(!status && view.extern_count) status = writeSymbolFile(name, ".ext", &view, 0);
+
+    free(words);
+    closeObjectView(&view);
+    return status;
+}
+
+/**
+ * @brief Writes the binary object file of the text files of a source.
+ *
+ * @param name The name of the object (without extension).
+ * @return EXIT_SUCCESS if the file was written, EXIT_FAILURE otherwise.
+ */
+static int convertToBinary(const char *name) {
+    int status = EXIT_FAILURE;
+    output_writer w;
+    text_buffer obj;
+
+    initTextBuffer(&obj);
+    if(!readTextObject(name, &obj) && !openOutputWriter(&w, name, ".obj")) {
+        writeBytes(&w, obj.data, obj.len);
+        status = closeOutputWriter(&w);
+    }
+    freeTextBuffer(&obj);
+    return status;
+}
+
+/**
+ * @brief Converts each object given on the command line.
+ *
+ * @param argc The number of command-line arguments.
+ * @param argv The array of command-line arguments.
+ * @return int Returns 1 if an object could not be converted, otherwise returns 0.
+ */
+int main(int argc, char *argv[]) {
+    int i, to_binary = 0, foundErr = 0;
+
+    if(argc < 2) {
+        fprintf(stderr, "Usage: %s [--to-text | --to-binary] NAME ...\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    if(initThreadLogs()) return EXIT_FAILURE;
+
+    for(i = 1; i < argc; i++) {
+        if(!strcmp(argv[i], "--to-text")) to_binary = 0;
+        else if(!strcmp(argv[i], "--to-binary")) to_binary = 1;
+        else if(to_binary ? convertToBinary(argv[i]) : convertToText(argv[i])) foundErr = 1;
+    }
+    return foundErr;
+}